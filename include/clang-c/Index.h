@@ -22,6 +22,7 @@
 #include "clang-c/CXErrorCode.h"
 #include "clang-c/CXString.h"
 #include "clang-c/BuildSystem.h"
+#include "clang-c/CXCompilationDatabase.h"
 
 /**
  * \brief The version constants for the libclang API.
@@ -32,7 +33,7 @@
  * compatible, thus CINDEX_VERSION_MAJOR is expected to remain stable.
  */
 #define CINDEX_VERSION_MAJOR 0
-#define CINDEX_VERSION_MINOR 35
+#define CINDEX_VERSION_MINOR 37
 
 #define CINDEX_VERSION_ENCODE(major, minor) ( \
       ((major) * 10000)                       \
@@ -274,6 +275,20 @@ CINDEX_LINKAGE void clang_CXIndex_setGlobalOptions(CXIndex, unsigned options);
  */
 CINDEX_LINKAGE unsigned clang_CXIndex_getGlobalOptions(CXIndex);
 
+/**
+ * \brief Sets a directory in which precompiled preambles are shared.
+ *
+ * Translation units parsed with \c CXTranslationUnit_PrecompiledPreamble
+ * store their precompiled preamble in this directory, and reuse a preamble
+ * found there that was built by any process for the same preamble, compiler
+ * options and header contents instead of building their own.
+ *
+ * \param Path The cache directory, which is created if needed. A null or
+ * empty path disables sharing, which is the default.
+ */
+CINDEX_LINKAGE void clang_CXIndex_setPreambleCachePath(CXIndex,
+                                                       const char *Path);
+
 /**
  * \defgroup CINDEX_FILES File manipulation routines
  *
@@ -5960,6 +5975,55 @@ CINDEX_LINKAGE int clang_indexTranslationUnit(CXIndexAction,
                                               unsigned index_options,
                                               CXTranslationUnit);
 
+/**
+ * \brief Index every translation unit in a compilation database, on several
+ * threads at once.
+ *
+ * Each command is indexed as if by #clang_indexSourceFileFullArgv, with paths
+ * resolved relative to the command's directory.
+ *
+ * The callbacks for one translation unit are invoked on one thread, in the
+ * usual order, but several translation units are indexed concurrently, so
+ * the callbacks must be thread-safe.  Once \c abortQuery returns non-zero, no
+ * further translation units are started.
+ *
+ * Declarations and references in a header are only reported by the first
+ * translation unit to reach them; the others still report the inclusion.
+ * Like CXIndexOpt_SkipParsedBodiesInSession, this is decided per
+ * preprocessor conditional region of the header, so a translation unit that
+ * takes a different \#if branch reports that branch.  A region whose
+ * contents depend on macros expanded in it, rather than on the conditionals
+ * around it, is still only reported once.  Code outside any conditional in a
+ * header without an include guard is reported by every translation unit.
+ * Passing CXIndexOpt_SkipParsedBodiesInSession in \p index_options also
+ * avoids parsing the bodies of such headers more than once.
+ *
+ * If a translation unit fails or crashes, the regions it claimed are released
+ * and reported by the next translation unit to reach them.  This has two
+ * consequences:
+ *
+ * - a translation unit indexed at the same time that already reached such a
+ *   region has skipped it for good, so if no later translation unit reaches
+ *   the region, its declarations are not reported at all;
+ *
+ * - a region the failed translation unit had already reported in full is
+ *   reported a second time by a later one.
+ *
+ * \param db the compilation database whose commands are indexed.
+ *
+ * \param num_threads the number of translation units to index at once, or 0
+ * to use one per hardware thread.
+ *
+ * The other parameters are the same as #clang_indexSourceFile.
+ *
+ * \returns 0 if every translation unit that was started was indexed,
+ * otherwise non-zero.
+ */
+CINDEX_LINKAGE int clang_indexCompilationDatabase(
+    CXIndexAction, CXClientData client_data, IndexerCallbacks *index_callbacks,
+    unsigned index_callbacks_size, unsigned index_options,
+    CXCompilationDatabase db, unsigned num_threads);
+
 /**
  * \brief Retrieve the CXIdxFile, file, line, column, and offset represented by
  * the given CXIdxLoc.
@@ -62,6 +62,14 @@ public:
   /// the consumer. The default implementation forwards to HandleTopLevelDecl.
   virtual void HandleInterestingDecl(DeclGroupRef D);
 
+  /// \brief Whether the consumer needs to see the declarations in a PCH file
+  /// that might affect code generation.
+  ///
+  /// If not, the AST reader doesn't deserialize those declarations until
+  /// something refers to them, and doesn't pass them to
+  /// HandleInterestingDecl.
+  virtual bool needsInterestingDecls() { return true; }
+
   /// HandleTranslationUnit - This method is called when the ASTs for entire
   /// translation unit have been parsed.
   virtual void HandleTranslationUnit(ASTContext &Ctx) {}
@@ -133,6 +133,28 @@ public:
     ///
     /// It prints a report after match.
     llvm::Optional<Profiling> CheckProfiling;
+
+    struct Sharding {
+      Sharding(unsigned Count, unsigned Index) : Count(Count), Index(Index) {}
+
+      /// \brief The number of shards the work is divided into.
+      unsigned Count;
+
+      /// \brief The shard to report matches for, counting from 0.
+      unsigned Index;
+    };
+
+    /// \brief Only reports the matches in one shard of the translation unit.
+    ///
+    /// The top-level declarations, including the ones in namespaces and
+    /// linkage specifications, are dealt out to the shards in turn.  The
+    /// namespaces, linkage specifications and the translation unit itself
+    /// belong to the first shard.  Running one MatchFinder for each shard
+    /// reports every match exactly once.
+    ///
+    /// An ASTContext can't be shared between threads, so shards that run at
+    /// the same time need an AST each.
+    llvm::Optional<Sharding> TopLevelDeclShard;
   };
 
   MatchFinder(MatchFinderOptions Options = MatchFinderOptions());
@@ -59,7 +59,6 @@ class FileEntry {
   unsigned UID;               // A unique (small) ID for the file.
   llvm::sys::fs::UniqueID UniqueID;
   bool IsNamedPipe;
-  bool InPCH;
   bool IsValid;               // Is this \c FileEntry initialized and valid?
 
   /// \brief The open file, if it is owned by the \p FileEntry.
@@ -70,7 +69,7 @@ class FileEntry {
 
 public:
   FileEntry()
-      : UniqueID(0, 0), IsNamedPipe(false), InPCH(false), IsValid(false)
+      : UniqueID(0, 0), IsNamedPipe(false), IsValid(false)
   {}
 
   // FIXME: this is here to allow putting FileEntry in std::map.  Once we have
@@ -78,7 +77,7 @@ public:
   /// Intentionally does not copy fields that are not set in an uninitialized
   /// \c FileEntry.
   FileEntry(const FileEntry &FE) : UniqueID(FE.UniqueID),
-      IsNamedPipe(FE.IsNamedPipe), InPCH(FE.InPCH), IsValid(FE.IsValid) {
+      IsNamedPipe(FE.IsNamedPipe), IsValid(FE.IsValid) {
     assert(!isValid() && "Cannot copy an initialized FileEntry");
   }
 
@@ -88,7 +87,6 @@ public:
   off_t getSize() const { return Size; }
   unsigned getUID() const { return UID; }
   const llvm::sys::fs::UniqueID &getUniqueID() const { return UniqueID; }
-  bool isInPCH() const { return InPCH; }
   time_t getModificationTime() const { return ModTime; }
 
   /// \brief Return the directory the file lives in.
@@ -106,6 +104,7 @@ public:
 };
 
 struct FileData;
+class SharedStatCache;
 
 /// \brief Implements support for file system lookup, file system caching,
 /// and directory search management.
@@ -165,6 +164,9 @@ class FileManager : public RefCountedBase<FileManager> {
   // Caching.
   std::unique_ptr<FileSystemStatCache> StatCache;
 
+  /// \brief The stat cache shared with other FileManagers, if any.
+  IntrusiveRefCntPtr<SharedStatCache> SharedStats;
+
   bool getStatValue(const char *Path, FileData &Data, bool isFile,
                     std::unique_ptr<vfs::File> *F);
 
@@ -195,8 +197,20 @@ public:
   void removeStatCache(FileSystemStatCache *statCache);
 
   /// \brief Removes all FileSystemStatCache objects from the manager.
+  ///
+  /// A shared stat cache, if any, stays installed.
   void clearStatCaches();
 
+  /// \brief Share the results of 'stat' calls with the other FileManagers
+  /// using \p Cache.
+  ///
+  /// The shared cache is consulted after all of the stat caches installed so
+  /// far.
+  void setSharedStatCache(IntrusiveRefCntPtr<SharedStatCache> Cache);
+
+  /// \brief Retrieve the stat cache shared with other FileManagers, if any.
+  SharedStatCache *getSharedStatCache() const { return SharedStats.get(); }
+
   /// \brief Lookup, cache, and verify the specified directory (real or
   /// virtual).
   ///
@@ -236,11 +250,17 @@ public:
 
   /// \brief Open the specified file as a MemoryBuffer, returning a new
   /// MemoryBuffer if successful, otherwise returning null.
+  ///
+  /// Readers that don't need a null terminator after the contents should
+  /// pass \p RequiresNullTerminator = false.  Files that are large enough are
+  /// then always memory mapped, rather than copied when their size happens to
+  /// be a multiple of the page size.
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
   getBufferForFile(const FileEntry *Entry, bool isVolatile = false,
-                   bool ShouldCloseOpenFile = true);
+                   bool ShouldCloseOpenFile = true,
+                   bool RequiresNullTerminator = true);
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
-  getBufferForFile(StringRef Filename);
+  getBufferForFile(StringRef Filename, bool RequiresNullTerminator = true);
 
   /// \brief Get the 'stat' information for the given \p Path.
   ///
@@ -16,9 +16,13 @@
 #define LLVM_CLANG_BASIC_FILESYSTEMSTATCACHE_H
 
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/FileSystem.h"
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
 
 namespace clang {
 
@@ -35,11 +39,10 @@ struct FileData {
   llvm::sys::fs::UniqueID UniqueID;
   bool IsDirectory;
   bool IsNamedPipe;
-  bool InPCH;
   bool IsVFSMapped; // FIXME: remove this when files support multiple names
   FileData()
       : Size(0), ModTime(0), IsDirectory(false), IsNamedPipe(false),
-        InPCH(false), IsVFSMapped(false) {}
+        IsVFSMapped(false) {}
 };
 
 /// \brief Abstract interface for introducing a FileManager cache for 'stat'
@@ -126,6 +129,91 @@ public:
                        vfs::FileSystem &FS) override;
 };
 
+/// \brief A table of 'stat' results which can be shared by the FileManagers
+/// of several compiler instances, possibly running on different threads.
+///
+/// All FileManagers sharing a table must have the same view of the file
+/// system. Only absolute paths are recorded, since relative paths may resolve
+/// differently in each client. The table is split into independently locked
+/// shards so that concurrent lookups rarely contend.
+class SharedStatCache : public llvm::ThreadSafeRefCountedBase<SharedStatCache> {
+public:
+  struct Options {
+    /// \brief Whether to remember paths which do not exist. Most of the
+    /// 'stat' calls made by header search are misses, but caching them is
+    /// only correct if no file is created while the cache is in use.
+    bool CacheMissingPaths;
+
+    /// \brief If non-zero, results older than this many seconds are looked
+    /// up again, so that changes to a file's size or modification time are
+    /// noticed within that interval.
+    unsigned RevalidationInterval;
+
+    Options() : CacheMissingPaths(false), RevalidationInterval(0) {}
+  };
+
+  SharedStatCache() {}
+  explicit SharedStatCache(const Options &Opts) : Opts(Opts) {}
+
+  const Options &getOptions() const { return Opts; }
+
+  /// \brief Look up the stat data recorded for \p Path.
+  ///
+  /// \param [out] Exists Whether \p Path was recorded as existing. This is
+  /// only ever false when missing paths are cached.
+  ///
+  /// \returns \c true and fills in \p Data and \p Exists if there is a
+  /// current result for \p Path.
+  bool lookup(StringRef Path, FileData &Data, bool &Exists) const;
+
+  /// \brief Record the stat data of an existing file or directory.
+  void insert(StringRef Path, const FileData &Data);
+
+  /// \brief Record that \p Path does not exist, if missing paths are cached.
+  void insertMissing(StringRef Path);
+
+  /// \brief Drop all recorded results.
+  void clear();
+
+  unsigned getNumHits() const { return NumHits; }
+  unsigned getNumMisses() const { return NumMisses; }
+
+private:
+  struct Entry {
+    FileData Data;
+    bool Exists;
+    std::chrono::steady_clock::time_point Recorded;
+  };
+
+  struct Shard {
+    mutable std::mutex Mutex;
+    llvm::StringMap<Entry, llvm::BumpPtrAllocator> Entries;
+  };
+
+  enum { NumShards = 16 };
+
+  Shard &getShard(StringRef Path) const;
+  void record(StringRef Path, const FileData &Data, bool Exists);
+
+  Options Opts;
+  mutable Shard Shards[NumShards];
+  mutable std::atomic<unsigned> NumHits{0}, NumMisses{0};
+};
+
+/// \brief A stat cache which memoizes 'stat' calls in a \c SharedStatCache, so
+/// that they are performed at most once across all of its clients.
+class SharedStatCacheClient : public FileSystemStatCache {
+  IntrusiveRefCntPtr<SharedStatCache> Shared;
+
+public:
+  explicit SharedStatCacheClient(IntrusiveRefCntPtr<SharedStatCache> Shared)
+      : Shared(std::move(Shared)) {}
+
+  LookupResult getStat(const char *Path, FileData &Data, bool isFile,
+                       std::unique_ptr<vfs::File> *F,
+                       vfs::FileSystem &FS) override;
+};
+
 } // end namespace clang
 
 #endif
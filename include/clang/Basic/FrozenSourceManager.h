@@ -0,0 +1,107 @@
+//===--- FrozenSourceManager.h - Read-only SourceManager view ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the FrozenSourceManager interface.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_FROZENSOURCEMANAGER_H
+#define LLVM_CLANG_BASIC_FROZENSOURCEMANAGER_H
+
+#include "clang/Basic/SourceManager.h"
+#include <vector>
+
+namespace clang {
+
+/// \brief A read-only view of a SourceManager that can be queried from
+/// several threads at once.
+///
+/// SourceManager caches the results of its queries in mutable state, and
+/// loads entries, buffers and line tables on demand, so even its const
+/// methods are not safe to call concurrently.  A FrozenSourceManager does all
+/// of that loading up front, and then answers location queries without
+/// writing to anything.
+///
+/// The view only covers the entries that existed when it was created.  The
+/// SourceManager must outlive the view, and must not be modified while the
+/// view is in use.  Creating the view loads every source buffer and builds
+/// every line table, so it is only worthwhile when many locations are going
+/// to be decoded.
+class FrozenSourceManager {
+  const SourceManager &SM;
+
+  /// \brief Copies of the local and loaded SLocEntries, with the same
+  /// indexing as the SourceManager's tables.
+  std::vector<SrcMgr::SLocEntry> LocalEntries;
+  std::vector<SrcMgr::SLocEntry> LoadedEntries;
+
+  unsigned NextLocalOffset;
+
+  const SrcMgr::SLocEntry &getSLocEntryByID(int ID) const {
+    if (ID < 0)
+      return LoadedEntries[-ID - 2];
+    return LocalEntries[ID];
+  }
+
+  const SrcMgr::ContentCache *getContentCache(FileID FID) const;
+
+public:
+  explicit FrozenSourceManager(const SourceManager &SM);
+
+  FrozenSourceManager(const FrozenSourceManager &) = delete;
+  FrozenSourceManager &operator=(const FrozenSourceManager &) = delete;
+
+  const SourceManager &getSourceManager() const { return SM; }
+
+  /// \brief Return the SLocEntry for \p FID, which must be valid.
+  const SrcMgr::SLocEntry &getSLocEntry(FileID FID) const {
+    assert(FID.isValid() && "Invalid FileID");
+    return getSLocEntryByID(FID.ID);
+  }
+
+  /// \brief Return the FileID for \p Loc, or an invalid FileID if \p Loc
+  /// isn't covered by the view.
+  FileID getFileID(SourceLocation Loc) const;
+
+  /// \brief Decompose \p Loc into a FileID and an offset in that entry.
+  std::pair<FileID, unsigned> getDecomposedLoc(SourceLocation Loc) const;
+
+  /// \brief Decompose the expansion location of \p Loc.
+  std::pair<FileID, unsigned>
+  getDecomposedExpansionLoc(SourceLocation Loc) const;
+
+  /// \brief Decompose the spelling location of \p Loc.
+  std::pair<FileID, unsigned>
+  getDecomposedSpellingLoc(SourceLocation Loc) const;
+
+  /// \brief Return the contents of the file or buffer \p FID, or an empty
+  /// string if \p FID isn't one.
+  StringRef getBufferData(FileID FID) const;
+
+  /// \brief Return the FileEntry for \p FID, if there is one.
+  const FileEntry *getFileEntryForID(FileID FID) const;
+
+  /// \brief Return the 1-based line number of \p FilePos in \p FID, or 0 if
+  /// \p FID isn't a file.
+  unsigned getLineNumber(FileID FID, unsigned FilePos) const;
+
+  /// \brief Return the 1-based column number of \p FilePos in \p FID, or 0
+  /// if \p FID isn't a file.
+  unsigned getColumnNumber(FileID FID, unsigned FilePos) const;
+
+  unsigned getSpellingLineNumber(SourceLocation Loc) const;
+  unsigned getSpellingColumnNumber(SourceLocation Loc) const;
+  unsigned getExpansionLineNumber(SourceLocation Loc) const;
+  unsigned getExpansionColumnNumber(SourceLocation Loc) const;
+};
+
+} // end namespace clang
+
+#endif
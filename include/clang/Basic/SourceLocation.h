@@ -58,6 +58,7 @@ public:
 
 private:
   friend class SourceManager;
+  friend class FrozenSourceManager;
   friend class ASTWriter;
   friend class ASTReader;
   
@@ -88,6 +89,7 @@ private:
 class SourceLocation {
   unsigned ID;
   friend class SourceManager;
+  friend class FrozenSourceManager;
   friend class ASTReader;
   friend class ASTWriter;
   enum : unsigned {
@@ -640,6 +640,22 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// is very common to look up many tokens from the same file.
   mutable FileID LastFileIDLookup;
 
+  /// \brief A small cache of the local file FileIDs looked up most recently,
+  /// behind LastFileIDLookup, with the offset range each one covers.
+  ///
+  /// Clients such as diagnostics, indexers and the AST matchers often bounce
+  /// between a handful of files, which defeats a one-entry cache.  Entries
+  /// are replaced round-robin.  Keeping the ranges here means that a miss,
+  /// e.g. for a macro location, only costs a few comparisons.
+  struct RecentFileIDLookup {
+    unsigned Begin, End;
+    FileID FID;
+  };
+  enum { NumRecentFileIDLookups = 8 };
+  mutable RecentFileIDLookup RecentFileIDLookups[NumRecentFileIDLookups];
+  mutable unsigned NextRecentFileIDLookup;
+  mutable unsigned LastRecentFileIDHit;
+
   /// \brief Holds information for \#line directives.
   ///
   /// This is referenced by indices from SLocEntryTable.
@@ -659,7 +675,7 @@ class SourceManager : public RefCountedBase<SourceManager> {
   FileID PreambleFileID;
 
   // Statistics for -print-stats.
-  mutable unsigned NumLinearScans, NumBinaryProbes;
+  mutable unsigned NumLinearScans, NumBinaryProbes, NumRecentFileIDHits;
 
   /// \brief Associates a FileID with its "included/expanded in" decomposed
   /// location.
@@ -1660,6 +1676,7 @@ private:
   createMemBufferContentCache(std::unique_ptr<llvm::MemoryBuffer> Buf);
 
   FileID getFileIDSlow(unsigned SLocOffset) const;
+  FileID getRecentFileIDLookup(unsigned SLocOffset) const;
   FileID getFileIDLocal(unsigned SLocOffset) const;
   FileID getFileIDLoaded(unsigned SLocOffset) const;
 
@@ -0,0 +1,91 @@
+//===--- TimeTraceProfiler.h - Compile time profiler ------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines a profiler which records how long the compiler spends in
+/// nested regions (headers, template instantiations, functions, ...) and
+/// writes them out in the Chrome trace-event format.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_TIMETRACEPROFILER_H
+#define LLVM_CLANG_BASIC_TIMETRACEPROFILER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include <string>
+
+namespace llvm {
+class raw_ostream;
+}
+
+namespace clang {
+
+class TimeTraceProfiler;
+
+/// \brief The profiler of the current compilation, or null if time tracing is
+/// not enabled.
+extern TimeTraceProfiler *TimeTraceProfilerInstance;
+
+/// \brief Start recording time trace events.
+///
+/// \param Granularity Events shorter than this many microseconds are dropped
+/// to keep the trace small.
+void timeTraceProfilerInitialize(unsigned Granularity);
+
+/// \brief Stop recording and discard all recorded events.
+void timeTraceProfilerCleanup();
+
+/// \brief Whether time trace events are being recorded.
+inline bool timeTraceProfilerEnabled() {
+  return TimeTraceProfilerInstance != nullptr;
+}
+
+/// \brief Write the recorded events to \p OS as a Chrome trace-event JSON
+/// document, which can be loaded in chrome://tracing.
+void timeTraceProfilerWrite(raw_ostream &OS);
+
+/// \brief Begin a region named \p Name, e.g. "Source" or
+/// "InstantiateFunction", with \p Detail identifying what is being processed.
+void timeTraceProfilerBegin(StringRef Name, StringRef Detail);
+
+/// \brief Like the above, but only computes the detail string if tracing is
+/// enabled.
+void timeTraceProfilerBegin(StringRef Name,
+                            llvm::function_ref<std::string()> Detail);
+
+/// \brief End the most recently begun region.
+void timeTraceProfilerEnd();
+
+/// \brief RAII object recording a region for as long as it is alive.
+///
+/// When time tracing is disabled this costs a single pointer comparison.
+class TimeTraceScope {
+  TimeTraceScope(const TimeTraceScope &) = delete;
+  void operator=(const TimeTraceScope &) = delete;
+
+public:
+  TimeTraceScope(StringRef Name, StringRef Detail = StringRef()) {
+    if (TimeTraceProfilerInstance)
+      timeTraceProfilerBegin(Name, Detail);
+  }
+  TimeTraceScope(StringRef Name, llvm::function_ref<std::string()> Detail) {
+    if (TimeTraceProfilerInstance)
+      timeTraceProfilerBegin(Name, Detail);
+  }
+  ~TimeTraceScope() {
+    if (TimeTraceProfilerInstance)
+      timeTraceProfilerEnd();
+  }
+};
+
+} // end namespace clang
+
+#endif
@@ -239,6 +239,17 @@ public:
       const JobList &Jobs,
       SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const;
 
+  /// ExecuteJobsInParallel - Execute the jobs, running up to \p MaxJobs
+  /// independent jobs at the same time. A job is started only once the jobs
+  /// producing its inputs have completed. The output of each job is replayed
+  /// and its failures are reported in job order.
+  ///
+  /// \param FailingCommands - For non-zero results, this will be a vector of
+  /// failing commands and their associated result code.
+  void ExecuteJobsInParallel(
+      const JobList &Jobs, unsigned MaxJobs,
+      SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const;
+
   /// initCompilationForDiagnostics - Remove stale state and suppress output
   /// so compilation can be reexecuted to generate additional diagnostic
   /// information (e.g., preprocessed source(s)).
@@ -199,6 +199,9 @@ private:
   /// Certain options suppress the 'no input files' warning.
   unsigned SuppressMissingInputWarning : 1;
 
+  /// The maximum number of independent jobs to execute at the same time.
+  unsigned ParallelJobs;
+
   std::list<std::string> TempFiles;
   std::list<std::string> ResultFiles;
 
@@ -272,6 +275,9 @@ public:
   bool embedBitcodeEnabled() const { return BitcodeEmbed == EmbedBitcode; }
   bool embedBitcodeMarkerOnly() const { return BitcodeEmbed == EmbedMarker; }
 
+  /// Get the maximum number of jobs which may be executed concurrently.
+  unsigned getParallelJobs() const { return ParallelJobs; }
+
   /// @}
   /// @name Primary Functionality
   /// @{
@@ -287,6 +287,10 @@ private:
   /// \brief A list of the serialization ID numbers for each of the top-level
   /// declarations parsed within the precompiled preamble.
   std::vector<serialization::DeclID> TopLevelDeclsInPreamble;
+
+  /// \brief The directory in which precompiled preambles are shared with
+  /// other processes, or empty if preambles are private to this ASTUnit.
+  std::string PreambleCachePath;
   
   /// \brief Whether we should be caching code-completion results.
   bool ShouldCacheCodeCompletionResults : 1;
@@ -443,6 +447,26 @@ private:
       std::shared_ptr<PCHContainerOperations> PCHContainerOps,
       const CompilerInvocation &PreambleInvocationIn, bool AllowRebuild = true,
       unsigned MaxLines = 0);
+
+  /// \brief Compute the key under which the preamble \p NewPreamble, built
+  /// with \p PreambleInvocation, is stored in the preamble cache.
+  std::string getPreambleCacheKey(const CompilerInvocation &PreambleInvocation,
+                                  const ComputedPreamble &NewPreamble);
+
+  /// \brief Adopt a precompiled preamble that was stored in the preamble
+  /// cache under \p Key, if there is one for exactly this preamble.
+  ///
+  /// The files the preamble depends on are not checked; the caller must
+  /// validate them as it would for a preamble it built itself.
+  ///
+  /// \returns true if the preamble was loaded.
+  bool loadPreambleFromCache(StringRef Key,
+                             const CompilerInvocation &PreambleInvocation,
+                             const ComputedPreamble &NewPreamble);
+
+  /// \brief Store the precompiled preamble that was just built in the
+  /// preamble cache under \p Key.
+  void storePreambleInCache(StringRef Key);
   void RealizeTopLevelDeclsFromPreamble();
 
   /// \brief Transfers ownership of the objects (like SourceManager) from
@@ -831,6 +855,10 @@ public:
   /// (e.g. because the PCH could not be loaded), this accepts the ASTUnit
   /// mainly to allow the caller to see the diagnostics.
   ///
+  /// \param PreambleCachePath - If non-empty, a directory in which precompiled
+  /// preambles are stored so that other processes parsing the same preamble
+  /// with the same options can reuse them instead of building their own.
+  ///
   // FIXME: Move OnlyLocalDecls, UseBumpAllocator to setters on the ASTUnit, we
   // shouldn't need to specify them at construction time.
   static ASTUnit *LoadFromCommandLine(
@@ -847,7 +875,8 @@ public:
       bool AllowPCHWithCompilerErrors = false, bool SkipFunctionBodies = false,
       bool UserFilesAreVolatile = false, bool ForSerialization = false,
       llvm::Optional<StringRef> ModuleFormat = llvm::None,
-      std::unique_ptr<ASTUnit> *ErrAST = nullptr);
+      std::unique_ptr<ASTUnit> *ErrAST = nullptr,
+      StringRef PreambleCachePath = StringRef());
 
   /// \brief Reparse the source files using the same command-line options that
   /// were originally used to produce this translation unit.
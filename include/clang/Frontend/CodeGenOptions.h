@@ -143,6 +143,10 @@ public:
   /// in the backend for setting the name in the skeleton cu.
   std::string SplitDwarfFile;
 
+  /// The files that receive the second and later partitions of the object
+  /// file when code generation runs in parallel.  Empty if it doesn't.
+  std::vector<std::string> ParallelCodeGenOutputs;
+
   /// The name of the relocation model to use.
   std::string RelocationModel;
 
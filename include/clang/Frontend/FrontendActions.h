@@ -11,6 +11,7 @@
 #define LLVM_CLANG_FRONTEND_FRONTENDACTIONS_H
 
 #include "clang/Frontend/FrontendAction.h"
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -18,6 +19,7 @@ namespace clang {
 
 class Module;
 class FileEntry;
+class MinimizedSourceCache;
   
 //===----------------------------------------------------------------------===//
 // Custom Consumer Actions
@@ -247,6 +249,31 @@ protected:
 
   bool hasPCHSupport() const override { return true; }
 };
+
+/// \brief Preprocess the input with every source file reduced to the
+/// directives that can affect its dependencies, which is enough to produce
+/// dependency files much faster than preprocessing the real sources.
+///
+/// Only header dependencies are scanned this way.  With modules enabled, the
+/// real sources are preprocessed instead, so that modules are never built
+/// from minimized headers.
+class ScanDependencyDirectivesAction : public PreprocessOnlyAction {
+  std::shared_ptr<MinimizedSourceCache> Cache;
+
+protected:
+  bool BeginInvocation(CompilerInstance &CI) override;
+
+public:
+  /// \param Cache The minimized sources to share with other actions, if any.
+  explicit ScanDependencyDirectivesAction(
+      std::shared_ptr<MinimizedSourceCache> Cache = nullptr);
+};
+
+class PrintDependencyDirectivesSourceMinimizerAction
+    : public PreprocessorFrontendAction {
+protected:
+  void ExecuteAction() override;
+};
   
 }  // end namespace clang
 
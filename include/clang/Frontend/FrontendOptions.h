@@ -52,10 +52,14 @@ namespace frontend {
     PluginAction,           ///< Run a plugin action, \see ActionName.
     PrintDeclContext,       ///< Print DeclContext and their Decls.
     PrintPreamble,          ///< Print the "preamble" of the input file
+    PrintDependencyDirectivesSourceMinimizerOutput, ///< Print the minimized
+                                                    ///< source.
     PrintPreprocessedInput, ///< -E mode.
     RewriteMacros,          ///< Expand macros but not \#includes.
     RewriteObjC,            ///< ObjC->C Rewriter.
     RewriteTest,            ///< Rewriter playground
+    ScanDependencyDirectives, ///< Preprocess sources reduced to their
+                              ///< directives, for dependency output.
     RunAnalysis,            ///< Run one or more source code analyses.
     MigrateSource,          ///< Run migrator.
     RunPreprocessorOnly     ///< Just lex, no output.
@@ -273,6 +277,20 @@ public:
   // included by this file.
   std::string FindPchSource;
 
+  /// \brief If non-empty, the file to write a Chrome trace-event profile of
+  /// the compilation to (-ftime-trace).
+  std::string TimeTracePath;
+
+  /// \brief The minimum duration, in microseconds, of the regions recorded in
+  /// the time trace.
+  unsigned TimeTraceGranularity;
+
+  /// \brief The number of threads to compress the source files embedded in
+  /// an AST file with, or 0 for one per hardware thread. This only matters
+  /// for AST files that embed their sources, e.g. with ModulesEmbedAllFiles;
+  /// everything else is serialized on one thread.
+  unsigned ASTCompressionThreads;
+
 public:
   FrontendOptions() :
     DisableFree(false), RelocatablePCH(false), ShowHelp(false),
@@ -283,7 +301,8 @@ public:
     GenerateGlobalModuleIndex(true), ASTDumpDecls(false), ASTDumpLookups(false),
     BuildingImplicitModule(false), ModulesEmbedAllFiles(false),
     IncludeTimestamps(true), ARCMTAction(ARCMT_None),
-    ObjCMTAction(ObjCMT_None), ProgramAction(frontend::ParseSyntaxOnly)
+    ObjCMTAction(ObjCMT_None), ProgramAction(frontend::ParseSyntaxOnly),
+    TimeTraceGranularity(500), ASTCompressionThreads(1)
   {}
 
   /// getInputKindForExtension - Return the appropriate input kind for a file
@@ -0,0 +1,87 @@
+//===--- MinimizedSourceFileSystem.h - Directive-only sources ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_MINIMIZEDSOURCEFILESYSTEM_H
+#define LLVM_CLANG_FRONTEND_MINIMIZEDSOURCEFILESYSTEM_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace clang {
+
+/// \brief A cache of source files reduced to their dependency directives.
+///
+/// The cache is thread-safe, so that it can be shared by every compilation
+/// that runs in a process.  Entries are keyed by file identity and are
+/// recomputed when the file's size or modification time changes.
+class MinimizedSourceCache {
+  struct Entry {
+    uint64_t Size;
+    llvm::sys::TimeValue ModTime;
+    std::shared_ptr<const std::string> Contents;
+  };
+
+  std::mutex Lock;
+  std::map<llvm::sys::fs::UniqueID, Entry> Entries;
+
+public:
+  /// \brief Return the minimized contents of the file with status \p Status,
+  /// calling \p Read to get its contents if they aren't cached yet.
+  ///
+  /// \returns null if \p Read fails.
+  std::shared_ptr<const std::string>
+  getMinimizedContents(const vfs::Status &Status,
+                       llvm::function_ref<llvm::ErrorOr<
+                           std::unique_ptr<llvm::MemoryBuffer>>()> Read);
+};
+
+/// \brief A file system that presents every source file as its minimized
+/// form, which only holds the directives that can affect its dependencies.
+///
+/// Preprocessing through this file system visits the same files as
+/// preprocessing the real sources, but much faster, which is all that
+/// dependency scanning needs.  Module maps, header maps and precompiled files
+/// are passed through unchanged.
+class MinimizedSourceFileSystem : public vfs::FileSystem {
+  IntrusiveRefCntPtr<vfs::FileSystem> UnderlyingFS;
+  std::shared_ptr<MinimizedSourceCache> Cache;
+
+  /// Get the minimized contents and status of the file \p Path with the real
+  /// status \p Status, given a way to read it.
+  llvm::ErrorOr<vfs::Status> getMinimizedStatus(
+      const vfs::Status &Status,
+      llvm::function_ref<
+          llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>()> Read,
+      std::shared_ptr<const std::string> &Contents);
+
+public:
+  MinimizedSourceFileSystem(IntrusiveRefCntPtr<vfs::FileSystem> UnderlyingFS,
+                            std::shared_ptr<MinimizedSourceCache> Cache);
+
+  /// \brief Whether the file at \p Path should be minimized.
+  static bool shouldMinimize(StringRef Path);
+
+  llvm::ErrorOr<vfs::Status> status(const Twine &Path) override;
+  llvm::ErrorOr<std::unique_ptr<vfs::File>>
+  openFileForRead(const Twine &Path) override;
+  vfs::directory_iterator dir_begin(const Twine &Dir,
+                                    std::error_code &EC) override;
+  llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override;
+  std::error_code setCurrentWorkingDirectory(const Twine &Path) override;
+};
+
+} // end namespace clang
+
+#endif
@@ -38,6 +38,7 @@ public:
   bool HandleTopLevelDecl(DeclGroupRef D) override;
   void HandleInlineFunctionDefinition(FunctionDecl *D) override;
   void HandleInterestingDecl(DeclGroupRef D) override;
+  bool needsInterestingDecls() override;
   void HandleTranslationUnit(ASTContext &Ctx) override;
   void HandleTagDeclDefinition(TagDecl *D) override;
   void HandleTagDeclRequiredDefinition(const TagDecl *D) override;
@@ -170,6 +170,10 @@ void AttachHeaderIncludeGen(Preprocessor &PP,
                             StringRef OutputPath = "",
                             bool ShowDepth = true, bool MSStyle = false);
 
+/// AttachTimeTraceHeaders - Record a -ftime-trace region for every header
+/// entered by the given preprocessor.
+void AttachTimeTraceHeaders(Preprocessor &PP);
+
 /// Cache tokens for use with PCH. Note that this requires a seekable stream.
 void CacheTokens(Preprocessor &PP, raw_pwrite_stream *OS);
 
@@ -0,0 +1,40 @@
+//===--- DependencyDirectivesSourceMinimizer.h - Minimize sources -*- C++ -*-=//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines a function that reduces a source file to the preprocessor
+/// directives that can affect which files it depends on.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_DEPENDENCYDIRECTIVESSOURCEMINIMIZER_H
+#define LLVM_CLANG_LEX_DEPENDENCYDIRECTIVESSOURCEMINIMIZER_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace clang {
+
+/// \brief Reduce \p Input to the directives that can affect its
+/// dependencies, and append the result to \p Output.
+///
+/// The result keeps the conditional directives, \#define and \#undef,
+/// \#include, \#include_next and \#import, the pragmas that affect header
+/// search and macro definitions, and \@import declarations.  Everything else,
+/// including comments and all code outside of directives, is dropped, and
+/// each directive is written on a line of its own.  Preprocessing the result
+/// includes the same files as preprocessing \p Input, as long as no
+/// condition depends on __LINE__ or on code that was dropped.
+void minimizeSourceToDependencyDirectives(StringRef Input,
+                                          SmallVectorImpl<char> &Output);
+
+} // end namespace clang
+
+#endif
@@ -17,6 +17,7 @@
 #include "clang/Lex/DirectoryLookup.h"
 #include "clang/Lex/ModuleMap.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSet.h"
@@ -32,6 +33,7 @@ class FileEntry;
 class FileManager;
 class HeaderSearchOptions;
 class IdentifierInfo;
+class IncludeGuardDatabase;
 class Preprocessor;
 
 /// \brief The preprocessor keeps track of this information for each
@@ -235,10 +237,19 @@ class HeaderSearch {
 
   /// \brief Entity used to look up stored header file information.
   ExternalHeaderFileInfoSource *ExternalSource;
+
+  /// \brief The include guards recorded by earlier compilations, if we were
+  /// asked to use an include guard database.
+  std::unique_ptr<IncludeGuardDatabase> GuardDatabase;
+
+  /// \brief The headers that were skipped because of a guard found in the
+  /// include guard database, without being entered first.
+  llvm::DenseSet<const FileEntry *> SkippedByGuardDatabase;
   
   // Various statistics we track for performance analysis.
   unsigned NumIncluded;
   unsigned NumMultiIncludeFileOptzn;
+  unsigned NumGuardDatabaseOptzn;
   unsigned NumFrameworkLookups, NumSubFrameworkLookups;
 
   // HeaderSearch doesn't support default or copy construction.
@@ -444,8 +455,17 @@ public:
   /// This is used by the multiple-include optimization to eliminate
   /// no-op \#includes.
   void SetFileControllingMacro(const FileEntry *File,
-                               const IdentifierInfo *ControllingMacro) {
-    getFileInfo(File).ControllingMacro = ControllingMacro;
+                               const IdentifierInfo *ControllingMacro);
+
+  /// \brief Save the controlling macros found by this compilation to the
+  /// include guard database, if there is one.
+  void writeIncludeGuardDatabase();
+
+  /// \brief Return true if \p File was skipped because of a guard found in
+  /// the include guard database.  Such a header has not been entered, but
+  /// would have been without the database, so it is still a dependency.
+  bool wasSkippedByIncludeGuardDatabase(const FileEntry *File) const {
+    return SkippedByGuardDatabase.count(File);
   }
 
   /// \brief Return true if this is the first time encountering this header.
@@ -96,6 +96,10 @@ public:
   /// \brief The directories used to load prebuilt module files.
   std::vector<std::string> PrebuiltModulePaths;
 
+  /// \brief The file used to remember the include guards of headers across
+  /// compilations, if any.
+  std::string IncludeGuardDatabasePath;
+
   /// The module/pch container format.
   std::string ModuleFormat;
 
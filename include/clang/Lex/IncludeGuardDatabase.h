@@ -0,0 +1,88 @@
+//===--- IncludeGuardDatabase.h - Persistent include guards -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the IncludeGuardDatabase interface.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_INCLUDEGUARDDATABASE_H
+#define LLVM_CLANG_LEX_INCLUDEGUARDDATABASE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <ctime>
+#include <string>
+
+namespace clang {
+
+class FileEntry;
+class FileManager;
+
+/// \brief A record of the include guard macro of each header, kept on disk
+/// so that it is shared by every compilation that names the same database.
+///
+/// The multiple-include optimization only learns a header's controlling
+/// macro by lexing the header once.  With the database, a compilation that
+/// reaches a header for the first time while its guard macro is already
+/// defined can skip the header without reading it.
+///
+/// Entries are keyed by the header's absolute path and are only used while
+/// the header's size and modification time match the recorded ones.
+/// Relative paths are resolved against the FileManager's working directory.
+class IncludeGuardDatabase {
+  struct Entry {
+    uint64_t Size;
+    time_t ModTime;
+    std::string Macro;
+  };
+
+  FileManager &FileMgr;
+
+  /// The path of the database file.
+  std::string Path;
+
+  /// The entries read from the database file.
+  llvm::StringMap<Entry> Entries;
+
+  /// The entries learned by this compilation that the database file doesn't
+  /// have yet.
+  llvm::StringMap<Entry> NewEntries;
+
+  static void read(StringRef Path, llvm::StringMap<Entry> &Entries);
+
+  void getKey(const FileEntry *File, SmallVectorImpl<char> &Key) const;
+
+  /// \brief Merge and write the database, with its lock held.
+  bool writeLocked();
+
+public:
+  /// \brief Load the database stored at \p Path.  A missing or unreadable
+  /// database is treated as empty.
+  IncludeGuardDatabase(FileManager &FileMgr, StringRef Path);
+
+  /// \brief Return the include guard macro recorded for \p File, or an empty
+  /// string if there is none or the file has changed since.
+  StringRef lookup(const FileEntry *File) const;
+
+  /// \brief Note that \p File is guarded by the macro \p Macro.
+  void addGuard(const FileEntry *File, StringRef Macro);
+
+  /// \brief Merge the guards noted by this compilation into the database
+  /// file.  Compilations that update the same database take turns through a
+  /// lock file, so none of them loses another's entries; the file itself is
+  /// replaced atomically, so readers don't need the lock.
+  ///
+  /// \returns true if an error occurred.
+  bool write();
+};
+
+} // end namespace clang
+
+#endif
@@ -611,6 +611,10 @@ private:
 
   void SkipBytes(unsigned Bytes, bool StartOfLine);
 
+  /// Skip the lines of an excluded conditional block that cannot contain a
+  /// preprocessor directive, without forming tokens for them.
+  void SkipExcludedLines();
+
   void PropagateLineStartLeadingSpaceInfo(Token &Result);
 
   const char *LexUDSuffix(Token &Result, const char *CurPtr,
@@ -16,9 +16,11 @@
 
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/SourceLocation.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/OnDiskHashTable.h"
+#include <tuple>
 
 namespace llvm {
   class MemoryBuffer;
@@ -26,17 +28,18 @@ namespace llvm {
 
 namespace clang {
 
-class FileEntry;
 class Preprocessor;
 class PTHLexer;
 class DiagnosticsEngine;
-class FileSystemStatCache;
+class LangOptions;
+
+namespace SrcMgr {
+  class ContentCache;
+}
 
 class PTHManager : public IdentifierInfoLookup {
   friend class PTHLexer;
 
-  friend class PTHStatCache;
-
   class PTHStringLookupTrait;
   class PTHFileLookupTrait;
   typedef llvm::OnDiskChainedHashTable<PTHStringLookupTrait> PTHStringIdLookup;
@@ -52,8 +55,8 @@ class PTHManager : public IdentifierInfoLookup {
   ///  IdentifierInfo*.
   std::unique_ptr<IdentifierInfo *[], llvm::FreeDeleter> PerIDCache;
 
-  /// FileLookup - Abstract data structure used for mapping between files
-  ///  and token data in the PTH file.
+  /// FileLookup - Abstract data structure used for mapping between the
+  ///  hashes of file contents and token data in the PTH file.
   std::unique_ptr<PTHFileLookup> FileLookup;
 
   /// IdDataTable - Array representing the mapping from persistent IDs to the
@@ -80,6 +83,15 @@ class PTHManager : public IdentifierInfoLookup {
   ///  if the file (if any) that was to used to generate the PTH cache.
   const char* OriginalSourceFile;
 
+  /// FileDataCache - The token and pp-conditional table offsets found for
+  ///  each file's contents, so that a file entered more than once is only
+  ///  hashed once.  A token offset of 0 means the file has no cached tokens.
+  llvm::DenseMap<const SrcMgr::ContentCache *, std::pair<uint32_t, uint32_t>>
+      FileDataCache;
+
+  /// NumFilesFromCache - The number of files entered using cached tokens.
+  unsigned NumFilesFromCache;
+
   /// This constructor is intended to only be called by the static 'Create'
   /// method.
   PTHManager(std::unique_ptr<const llvm::MemoryBuffer> buf,
@@ -108,7 +120,24 @@ class PTHManager : public IdentifierInfoLookup {
 
 public:
   // The current PTH version.
-  enum { Version = 10 };
+  enum { Version = 12 };
+
+  /// FileKey - The key that a file's cached tokens are looked up by: the
+  ///  MD5 digest of the file's contents and their size.
+  struct FileKey {
+    uint64_t DigestLo;
+    uint64_t DigestHi;
+    uint64_t Size;
+
+    bool operator==(const FileKey &RHS) const {
+      return DigestLo == RHS.DigestLo && DigestHi == RHS.DigestHi &&
+             Size == RHS.Size;
+    }
+    bool operator<(const FileKey &RHS) const {
+      return std::tie(DigestLo, DigestHi, Size) <
+             std::tie(RHS.DigestLo, RHS.DigestHi, RHS.Size);
+    }
+  };
 
   ~PTHManager() override;
 
@@ -125,21 +154,31 @@ public:
   IdentifierInfo *get(StringRef Name) override;
 
   /// Create - This method creates PTHManager objects.  The 'file' argument
-  ///  is the name of the PTH file.  This method returns NULL upon failure.
-  static PTHManager *Create(StringRef file, DiagnosticsEngine &Diags);
+  ///  is the name of the PTH file.  This method returns NULL upon failure,
+  ///  including when the PTH file was generated with language options that
+  ///  lex differently from 'LangOpts'.
+  static PTHManager *Create(StringRef file, const LangOptions &LangOpts,
+                            DiagnosticsEngine &Diags);
 
   void setPreprocessor(Preprocessor *pp) { PP = pp; }
 
   /// CreateLexer - Return a PTHLexer that "lexes" the cached tokens for the
-  ///  specified file.  This method returns NULL if no cached tokens exist.
-  ///  It is the responsibility of the caller to 'delete' the returned object.
+  ///  specified file.  This method returns NULL if no cached tokens exist
+  ///  for the file's current contents.  It is the responsibility of the
+  ///  caller to 'delete' the returned object.
   PTHLexer *CreateLexer(FileID FID);
 
-  /// createStatCache - Returns a FileSystemStatCache object for use with
-  ///  FileManager objects.  These objects use the PTH data to speed up
-  ///  calls to stat by memoizing their results from when the PTH file
-  ///  was generated.
-  std::unique_ptr<FileSystemStatCache> createStatCache();
+  /// getFileKey - Return the key that cached tokens for a file with the
+  ///  given contents are stored under.
+  static FileKey getFileKey(StringRef Contents);
+
+  /// getLangOptsHash - Return a hash of the language options that change how
+  ///  the lexer splits a file into tokens.  It is stored in the PTH file, and
+  ///  the cache is only used by compilations with the same hash.
+  static uint64_t getLangOptsHash(const LangOptions &LangOpts);
+
+  /// PrintStats - Print how many files were lexed from cached tokens.
+  void PrintStats() const;
 };
 
 }  // end namespace clang
@@ -884,6 +884,18 @@ private:
   /// in the chain.
   unsigned TotalNumStatements;
 
+  /// \brief The number of function and method bodies de-serialized from the
+  /// chain.
+  unsigned NumBodiesRead;
+
+  /// \brief The number of function and method bodies that have been left to
+  /// be de-serialized on demand.
+  unsigned TotalLazyBodies;
+
+  /// \brief The number of eagerly-deserialized declarations in PCH files
+  /// that were not de-serialized, because the consumer didn't need them.
+  unsigned NumEagerlyDeserializedDeclsSkipped;
+
   /// \brief The number of macros de-serialized from the chain.
   unsigned NumMacrosRead;
 
@@ -1211,6 +1223,7 @@ private:
   RecordLocation TypeCursorForIndex(unsigned Index);
   void LoadedDecl(unsigned Index, Decl *D);
   Decl *ReadDeclRecord(serialization::DeclID ID);
+  bool isCodeGenOnlyDeclRecord(serialization::DeclID ID);
   void markIncompleteDeclChain(Decl *Canon);
 
   /// \brief Returns the most recent declaration of a declaration (which must be
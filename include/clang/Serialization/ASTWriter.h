@@ -127,6 +127,10 @@ private:
   /// file is up to date, but not otherwise.
   bool IncludeTimestamps;
 
+  /// \brief The number of threads that compress the source buffers embedded
+  /// in the AST file, or 0 for one per hardware thread.
+  unsigned CompressionThreads;
+
   /// \brief Indicates when the AST writing is actively performing
   /// serialization, rather than just queueing updates.
   bool WritingAST;
@@ -495,7 +499,7 @@ public:
   /// the given bitstream.
   ASTWriter(llvm::BitstreamWriter &Stream,
             ArrayRef<llvm::IntrusiveRefCntPtr<ModuleFileExtension>> Extensions,
-            bool IncludeTimestamps = true);
+            bool IncludeTimestamps = true, unsigned CompressionThreads = 1);
   ~ASTWriter() override;
 
   const LangOptions &getLangOpts() const;
@@ -928,7 +932,8 @@ public:
     std::shared_ptr<PCHBuffer> Buffer,
     ArrayRef<llvm::IntrusiveRefCntPtr<ModuleFileExtension>> Extensions,
     bool AllowASTWithErrors = false,
-    bool IncludeTimestamps = true);
+    bool IncludeTimestamps = true,
+    unsigned CompressionThreads = 1);
   ~PCHGenerator() override;
   void InitializeSema(Sema &S) override { SemaPtr = &S; }
   void HandleTranslationUnit(ASTContext &Ctx) override;
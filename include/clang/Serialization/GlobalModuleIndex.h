@@ -193,6 +193,11 @@ public:
 
   /// \brief Write a global index into the given
   ///
+  /// Module files already described by an existing index are not reloaded
+  /// unless they changed, and the index is only rewritten if it is out of
+  /// date. The new index replaces the old one atomically, so no lock is held
+  /// and concurrent readers never see a partially-written index.
+  ///
   /// \param FileMgr The file manager to use to load module files.
   /// \param PCHContainerRdr - The PCHContainerOperations to use for loading and
   /// creating modules.
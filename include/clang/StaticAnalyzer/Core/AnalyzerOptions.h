@@ -121,6 +121,26 @@ enum IPAKind {
   IPAK_DynamicDispatchBifurcate = 5
 };
 
+/// \brief Describes the order in which the analyzer explores the paths of a
+/// function.
+enum ExplorationStrategyKind {
+  ESK_NotSet = 0,
+
+  /// Explore one path as far as possible before backtracking.
+  ESK_DFS = 1,
+
+  /// Explore all paths in lockstep.
+  ESK_BFS = 2,
+
+  /// Explore blocks in breadth-first order, and the contents of each block
+  /// to completion.
+  ESK_BFSBlockDFSContents = 3,
+
+  /// Explore depth-first, but first resume the paths that enter a CFG block
+  /// that hasn't been reached yet in the same stack frame.
+  ESK_UnexploredFirst = 4
+};
+
 class AnalyzerOptions : public RefCountedBase<AnalyzerOptions> {
 public:
   typedef llvm::StringMap<std::string> ConfigTable;
@@ -201,6 +221,9 @@ private:
 
   /// Controls which C++ member functions will be considered for inlining.
   CXXInlineableMemberKind CXXMemberInliningMode;
+
+  /// Controls the order in which paths are explored.
+  ExplorationStrategyKind ExplorationStrategy;
   
   /// \sa includeTemporaryDtorsInCFG
   Optional<bool> IncludeTemporaryDtorsInCFG;
@@ -251,6 +274,9 @@ private:
   /// \sa getGraphTrimInterval
   Optional<unsigned> GraphTrimInterval;
 
+  /// \sa shouldReclaimDeadPaths
+  Optional<bool> ReclaimDeadPaths;
+
   /// \sa getMaxTimesInlineLarge
   Optional<unsigned> MaxTimesInlineLarge;
 
@@ -260,6 +286,12 @@ private:
   /// \sa getMaxNodesPerTopLevelFunction
   Optional<unsigned> MaxNodesPerTopLevelFunction;
 
+  /// \sa getAnalysisShardCount
+  Optional<unsigned> AnalysisShardCount;
+
+  /// \sa getAnalysisShardIndex
+  Optional<unsigned> AnalysisShardIndex;
+
   /// \sa shouldInlineLambdas
   Optional<bool> InlineLambdas;
 
@@ -371,6 +403,13 @@ public:
   /// \brief Returns the inter-procedural analysis mode.
   IPAKind getIPAMode();
 
+  /// \brief Returns the order in which the paths of a function are explored.
+  ///
+  /// This is controlled by the 'exploration-strategy' config option, which
+  /// accepts the values "dfs", "bfs", "bfs-block-dfs-contents" and
+  /// "unexplored-first".
+  ExplorationStrategyKind getExplorationStrategy();
+
   /// Returns the option controlling which C++ member functions will be
   /// considered for inlining.
   ///
@@ -507,6 +546,19 @@ public:
   /// node reclamation, set the option to "0".
   unsigned getGraphTrimInterval();
 
+  /// Returns true if the analyzer should periodically remove the parts of
+  /// the ExplodedGraph from which no bug report and no unfinished path can
+  /// be reached.
+  ///
+  /// This saves a lot of memory on functions with many paths, at the cost
+  /// of re-exploring a path that would otherwise have merged with one that
+  /// was removed.  Checkers that look at the whole graph at the end of the
+  /// analysis, such as the unreachable code checker, only see what is left.
+  ///
+  /// This is controlled by the 'reclaim-dead-paths' config option, which
+  /// accepts the values "true" and "false".
+  bool shouldReclaimDeadPaths();
+
   /// Returns the maximum times a large function could be inlined.
   ///
   /// This is controlled by the 'max-times-inline-large' config option.
@@ -526,6 +578,22 @@ public:
   /// This is controlled by the 'max-nodes' config option.
   unsigned getMaxNodesPerTopLevelFunction();
 
+  /// Returns the number of shards the functions of the translation unit are
+  /// divided into, so that several analyzer processes can share the work.
+  /// 1 is default, and means the work is not divided.  Two shards can report
+  /// the same issue, so their output needs to be merged by issue hash, as
+  /// scan-build's --analyzer-shards option does.
+  ///
+  /// This is controlled by the 'shard-count' config option.
+  unsigned getAnalysisShardCount();
+
+  /// Returns which of the shards this process runs the path-sensitive checks
+  /// for, counting from 0.  The first shard also runs the syntax-based and
+  /// whole translation unit checks.
+  ///
+  /// This is controlled by the 'shard-index' config option.
+  unsigned getAnalysisShardIndex();
+
   /// Returns true if lambdas should be inlined. Otherwise a sink node will be
   /// generated each time a LambdaExpr is visited.
   bool shouldInlineLambdas();
@@ -558,7 +626,8 @@ public:
     InliningMode(NoRedundancy),
     UserMode(UMK_NotSet),
     IPAMode(IPAK_NotSet),
-    CXXMemberInliningMode() {}
+    CXXMemberInliningMode(),
+    ExplorationStrategy(ESK_NotSet) {}
 
 };
   
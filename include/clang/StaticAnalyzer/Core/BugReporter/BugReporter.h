@@ -463,9 +463,13 @@ private:
 // FIXME: Get rid of GRBugReporter.  It's the wrong abstraction.
 class GRBugReporter : public BugReporter {
   ExprEngine& Eng;
+
+  /// The paths found for the equivalence class that was flushed last.
+  class ReportPathCache;
+  std::unique_ptr<ReportPathCache> PathCache;
+
 public:
-  GRBugReporter(BugReporterData& d, ExprEngine& eng)
-    : BugReporter(d, GRBugReporterKind), Eng(eng) {}
+  GRBugReporter(BugReporterData& d, ExprEngine& eng);
 
   ~GRBugReporter() override;
 
@@ -487,6 +491,10 @@ public:
   /// bug reporter will try to pick the shortest path, but this is not
   /// guaranteed.
   ///
+  /// Each consumer asks for a path for the same reports in turn.  The graph
+  /// is trimmed and the paths are extracted for the first of them only, and
+  /// reused for the others.
+  ///
   /// \return True if the report was valid and a path was generated,
   ///         false if the reports should be considered invalid.
   bool generatePathDiagnostic(PathDiagnostic &PD, PathDiagnosticConsumer &PC,
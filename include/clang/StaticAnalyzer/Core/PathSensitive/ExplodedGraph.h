@@ -101,6 +101,11 @@ class ExplodedNode : public llvm::FoldingSetNode {
     /// only a single node.
     void replaceNode(ExplodedNode *node);
 
+    /// Removes a node from the list, keeping the others in order.
+    ///
+    /// The group must contain the node.
+    void removeNode(ExplodedNode *node);
+
     /// Returns whether this group was created with its flag set.
     bool getFlag() const {
       return (P & 1);
@@ -394,6 +399,17 @@ public:
   /// was called.
   void reclaimRecentlyAllocatedNodes();
 
+  /// Remove every node, other than the roots, from which none of the given
+  /// nodes can be reached.
+  ///
+  /// Unlike reclaimRecentlyAllocatedNodes(), this can drop whole paths, so
+  /// it must only be used when no other node is referenced from outside the
+  /// graph.  A path that later reaches the same location and state as a
+  /// removed node will not be merged with it, and is explored again.
+  ///
+  /// \returns The number of nodes removed.
+  unsigned removeNodesNotReaching(ArrayRef<const ExplodedNode *> Live);
+
   /// \brief Returns true if nodes for the given expression kind are always
   ///        kept around.
   static bool isInterestingLValueExpr(const Expr *Ex);
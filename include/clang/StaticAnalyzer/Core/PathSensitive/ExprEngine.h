@@ -280,6 +280,11 @@ public:
   /// Called by CoreEngine when the analysis worklist has terminated.
   void processEndWorklist(bool hasWorkRemaining) override;
 
+  /// Called by CoreEngine to collect the error nodes of the bug reports
+  /// emitted so far.
+  void
+  collectReportedNodes(SmallVectorImpl<const ExplodedNode *> &Nodes) override;
+
   /// evalAssume - Callback function invoked by the ConstraintManager when
   ///  making assumptions about state values.
   ProgramStateRef processAssume(ProgramStateRef state, SVal cond,
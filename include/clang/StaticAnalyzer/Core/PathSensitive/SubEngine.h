@@ -161,6 +161,11 @@ public:
   /// Called by CoreEngine when the analysis worklist is either empty or the
   //  maximum number of analysis steps have been reached.
   virtual void processEndWorklist(bool hasWorkRemaining) = 0;
+
+  /// Called by CoreEngine to collect the nodes that bug reports refer to,
+  /// which must be kept when dead paths are removed from the graph.
+  virtual void
+  collectReportedNodes(SmallVectorImpl<const ExplodedNode *> &Nodes) = 0;
 };
 
 } // end GR namespace
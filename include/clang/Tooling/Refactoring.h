@@ -22,6 +22,7 @@
 #include "clang/Tooling/Core/Replacement.h"
 #include "clang/Tooling/Tooling.h"
 #include <map>
+#include <mutex>
 #include <string>
 
 namespace clang {
@@ -47,6 +48,12 @@ public:
   /// should be added during the run of the tool.
   std::map<std::string, Replacements> &getReplacements();
 
+  /// \brief Adds \p R to the replacements of the file it applies to.
+  ///
+  /// Unlike modifying the map returned by getReplacements(), this is safe to
+  /// call concurrently from actions run through runParallel().
+  llvm::Error addReplacement(const Replacement &R);
+
   /// \brief Call run(), apply all generated replacements, and immediately save
   /// the results to disk.
   ///
@@ -67,6 +74,7 @@ private:
 
 private:
   std::map<std::string, Replacements> FileToReplaces;
+  std::mutex ReplacementsMutex;
 };
 
 /// \brief Groups \p Replaces by the file path and applies each group of
@@ -323,6 +323,23 @@ class ClangTool {
   /// \param Action Tool action.
   int run(ToolAction *Action);
 
+  /// \brief Runs an action over all files specified in the command line,
+  /// processing up to \p ThreadCount translation units at the same time.
+  ///
+  /// The compile commands are looked up and adjusted up front on the calling
+  /// thread. Each worker thread then uses its own \c FileManager, and all
+  /// workers share a cache of 'stat' results. \p Action must be safe to call
+  /// concurrently. Any diagnostic consumer set through setDiagnosticConsumer()
+  /// receives the diagnostics of each translation unit together, between its
+  /// BeginSourceFile() and EndSourceFile() calls, and is only ever called by
+  /// one thread at a time. Each command is run in its own directory, through
+  /// -working-directory rather than a process-wide chdir.
+  ///
+  /// \param Action Tool action.
+  /// \param ThreadCount The number of worker threads, or 0 to use one thread
+  /// per hardware thread.
+  int runParallel(ToolAction *Action, unsigned ThreadCount = 0);
+
   /// \brief Create an AST for each file specified in the command line and
   /// append them to ASTs.
   int buildASTs(std::vector<std::unique_ptr<ASTUnit>> &ASTs);
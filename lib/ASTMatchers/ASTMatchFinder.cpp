@@ -24,6 +24,8 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Timer.h"
 #include <deque>
+#include <list>
+#include <map>
 #include <memory>
 #include <set>
 
@@ -34,7 +36,8 @@ namespace {
 
 typedef MatchFinder::MatchCallback MatchCallback;
 
-// The maximum number of memoization entries to store.
+// The maximum number of memoization entries to store.  Once there are more,
+// the least recently used ones are dropped.
 // 10k has been experimentally found to give a good trade-off
 // of performance vs. memory consumption by running matcher
 // that match on every statement over a very large codebase.
@@ -73,6 +76,60 @@ struct MemoizedMatchResult {
   BoundNodesTreeBuilder Nodes;
 };
 
+// Maps (matcher, node) -> the match result, and remembers the order in which
+// the entries were last used.
+//
+// Matching recurses through the cache, so references into it are only valid
+// until the next call to match.
+class MemoizationCache {
+  // The keys of the entries, most recently used first.
+  typedef std::list<const MatchKey *> UseListTy;
+
+  struct Entry {
+    MemoizedMatchResult Result;
+    // The position of this entry in UseOrder.
+    UseListTy::iterator Use;
+  };
+  typedef std::map<MatchKey, Entry> MapTy;
+
+  MapTy Entries;
+  UseListTy UseOrder;
+
+public:
+  // Returns the result for Key, or null if there is none.
+  const MemoizedMatchResult *lookup(const MatchKey &Key) {
+    MapTy::iterator I = Entries.find(Key);
+    if (I == Entries.end())
+      return nullptr;
+    UseOrder.splice(UseOrder.begin(), UseOrder, I->second.Use);
+    return &I->second.Result;
+  }
+
+  const MemoizedMatchResult &insert(const MatchKey &Key,
+                                    MemoizedMatchResult Result) {
+    std::pair<MapTy::iterator, bool> Inserted =
+        Entries.insert(std::make_pair(Key, Entry()));
+    Entry &E = Inserted.first->second;
+    if (Inserted.second) {
+      UseOrder.push_front(&Inserted.first->first);
+      E.Use = UseOrder.begin();
+    } else {
+      UseOrder.splice(UseOrder.begin(), UseOrder, E.Use);
+    }
+    E.Result = std::move(Result);
+    return E.Result;
+  }
+
+  // Drops the least recently used entries until at most MaxEntries are left.
+  void shrink(size_t MaxEntries) {
+    while (Entries.size() > MaxEntries) {
+      MapTy::iterator I = Entries.find(*UseOrder.back());
+      UseOrder.pop_back();
+      Entries.erase(I);
+    }
+  }
+};
+
 // A RecursiveASTVisitor that traverses all children or all descendants of
 // a node.
 class MatchChildASTVisitor
@@ -295,7 +352,9 @@ class MatchASTVisitor : public RecursiveASTVisitor<MatchASTVisitor>,
 public:
   MatchASTVisitor(const MatchFinder::MatchersByType *Matchers,
                   const MatchFinder::MatchFinderOptions &Options)
-      : Matchers(Matchers), Options(Options), ActiveASTContext(nullptr) {}
+      : Matchers(Matchers), Options(Options), ActiveASTContext(nullptr),
+        InShard(true), AtTopLevel(Options.TopLevelDeclShard.hasValue()),
+        NextTopLevelDecl(0) {}
 
   ~MatchASTVisitor() override {
     if (Options.CheckProfiling) {
@@ -388,10 +447,9 @@ public:
     // Note that we key on the bindings *before* the match.
     Key.BoundNodes = *Builder;
 
-    MemoizationMap::iterator I = ResultCache.find(Key);
-    if (I != ResultCache.end()) {
-      *Builder = I->second.Nodes;
-      return I->second.ResultOfMatch;
+    if (const MemoizedMatchResult *Cached = ResultCache.lookup(Key)) {
+      *Builder = Cached->Nodes;
+      return Cached->ResultOfMatch;
     }
 
     MemoizedMatchResult Result;
@@ -399,8 +457,8 @@ public:
     Result.ResultOfMatch = matchesRecursively(Node, Matcher, &Result.Nodes,
                                               MaxDepth, Traversal, Bind);
 
-    MemoizedMatchResult &CachedResult = ResultCache[Key];
-    CachedResult = std::move(Result);
+    const MemoizedMatchResult &CachedResult =
+        ResultCache.insert(Key, std::move(Result));
 
     *Builder = CachedResult.Nodes;
     return CachedResult.ResultOfMatch;
@@ -426,8 +484,7 @@ public:
                       BoundNodesTreeBuilder *Builder,
                       TraversalKind Traversal,
                       BindKind Bind) override {
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
+    ResultCache.shrink(MaxMemoizationEntries);
     return memoizedMatchesRecursively(Node, Matcher, Builder, 1, Traversal,
                                       Bind);
   }
@@ -436,8 +493,7 @@ public:
                            const DynTypedMatcher &Matcher,
                            BoundNodesTreeBuilder *Builder,
                            BindKind Bind) override {
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
+    ResultCache.shrink(MaxMemoizationEntries);
     return memoizedMatchesRecursively(Node, Matcher, Builder, INT_MAX,
                                       TK_AsIs, Bind);
   }
@@ -446,10 +502,9 @@ public:
                          const DynTypedMatcher &Matcher,
                          BoundNodesTreeBuilder *Builder,
                          AncestorMatchMode MatchMode) override {
-    // Reset the cache outside of the recursive call to make sure we
+    // Shrink the cache outside of the recursive call to make sure we
     // don't invalidate any iterators.
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
+    ResultCache.shrink(MaxMemoizationEntries);
     return memoizedMatchesAncestorOfRecursively(Node, Matcher, Builder,
                                                 MatchMode);
   }
@@ -476,7 +531,8 @@ public:
   }
 
   template <typename T> void match(const T &Node) {
-    matchDispatch(&Node);
+    if (InShard)
+      matchDispatch(&Node);
   }
 
   // Implements ASTMatchFinder::getASTContext.
@@ -625,12 +681,11 @@ private:
     Key.Node = Node;
     Key.BoundNodes = *Builder;
 
-    // Note that we cannot use insert and reuse the iterator, as recursive
-    // calls to match might invalidate the result cache iterators.
-    MemoizationMap::iterator I = ResultCache.find(Key);
-    if (I != ResultCache.end()) {
-      *Builder = I->second.Nodes;
-      return I->second.ResultOfMatch;
+    // Note that we cannot insert first and fill in the result afterwards, as
+    // recursive calls to match might drop the entry.
+    if (const MemoizedMatchResult *Cached = ResultCache.lookup(Key)) {
+      *Builder = Cached->Nodes;
+      return Cached->ResultOfMatch;
     }
 
     MemoizedMatchResult Result;
@@ -638,8 +693,8 @@ private:
     Result.ResultOfMatch =
         matchesAncestorOfRecursively(Node, Matcher, &Result.Nodes, MatchMode);
 
-    MemoizedMatchResult &CachedResult = ResultCache[Key];
-    CachedResult = std::move(Result);
+    const MemoizedMatchResult &CachedResult =
+        ResultCache.insert(Key, std::move(Result));
 
     *Builder = CachedResult.Nodes;
     return CachedResult.ResultOfMatch;
@@ -751,8 +806,18 @@ private:
   llvm::DenseMap<const Type*, std::set<const TypedefNameDecl*> > TypeAliases;
 
   // Maps (matcher, node) -> the match result for memoization.
-  typedef std::map<MatchKey, MemoizedMatchResult> MemoizationMap;
-  MemoizationMap ResultCache;
+  MemoizationCache ResultCache;
+
+  // Whether the nodes being traversed belong to the shard we match in.  The
+  // other shards are still traversed, to collect their TypeAliases.
+  bool InShard;
+
+  // Whether the traversal hasn't yet entered a top-level declaration, when
+  // the top-level declarations are dealt out to shards.
+  bool AtTopLevel;
+
+  // The number of top-level declarations dealt out so far.
+  unsigned NextTopLevelDecl;
 };
 
 static CXXRecordDecl *
@@ -816,8 +881,27 @@ bool MatchASTVisitor::TraverseDecl(Decl *DeclNode) {
   if (!DeclNode) {
     return true;
   }
+  if (!AtTopLevel) {
+    match(*DeclNode);
+    return RecursiveASTVisitor<MatchASTVisitor>::TraverseDecl(DeclNode);
+  }
+
+  const MatchFinder::MatchFinderOptions::Sharding &Shard =
+      *Options.TopLevelDeclShard;
+  if (isa<TranslationUnitDecl>(DeclNode) || isa<NamespaceDecl>(DeclNode) ||
+      isa<LinkageSpecDecl>(DeclNode)) {
+    // Deal out the declarations inside, rather than the whole container.
+    InShard = Shard.Index == 0;
+    match(*DeclNode);
+    return RecursiveASTVisitor<MatchASTVisitor>::TraverseDecl(DeclNode);
+  }
+
+  InShard = NextTopLevelDecl++ % Shard.Count == Shard.Index;
+  AtTopLevel = false;
   match(*DeclNode);
-  return RecursiveASTVisitor<MatchASTVisitor>::TraverseDecl(DeclNode);
+  bool Result = RecursiveASTVisitor<MatchASTVisitor>::TraverseDecl(DeclNode);
+  AtTopLevel = true;
+  return Result;
 }
 
 bool MatchASTVisitor::TraverseStmt(Stmt *StmtNode) {
@@ -894,7 +978,12 @@ MatchFinder::MatchCallback::~MatchCallback() {}
 MatchFinder::ParsingDoneTestCallback::~ParsingDoneTestCallback() {}
 
 MatchFinder::MatchFinder(MatchFinderOptions Options)
-    : Options(std::move(Options)), ParsingDone(nullptr) {}
+    : Options(std::move(Options)), ParsingDone(nullptr) {
+  assert((!this->Options.TopLevelDeclShard ||
+          this->Options.TopLevelDeclShard->Index <
+              this->Options.TopLevelDeclShard->Count) &&
+         "Shard index out of range");
+}
 
 MatchFinder::~MatchFinder() {}
 
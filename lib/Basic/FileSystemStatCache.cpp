@@ -13,6 +13,7 @@
 
 #include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Path.h"
 
 using namespace clang;
@@ -27,7 +28,6 @@ static void copyStatusToFileData(const vfs::Status &Status,
   Data.UniqueID = Status.getUniqueID();
   Data.IsDirectory = Status.isDirectory();
   Data.IsNamedPipe = Status.getType() == llvm::sys::fs::file_type::fifo_file;
-  Data.InPCH = false;
   Data.IsVFSMapped = Status.IsVFSMapped;
 }
 
@@ -124,3 +124,73 @@ MemorizeStatCalls::getStat(const char *Path, FileData &Data, bool isFile,
 
   return Result;
 }
+
+SharedStatCache::Shard &SharedStatCache::getShard(StringRef Path) const {
+  return Shards[llvm::HashString(Path) % NumShards];
+}
+
+bool SharedStatCache::lookup(StringRef Path, FileData &Data,
+                             bool &Exists) const {
+  Shard &S = getShard(Path);
+  {
+    std::lock_guard<std::mutex> Lock(S.Mutex);
+    auto I = S.Entries.find(Path);
+    if (I != S.Entries.end() &&
+        (!Opts.RevalidationInterval ||
+         std::chrono::steady_clock::now() - I->second.Recorded <
+             std::chrono::seconds(Opts.RevalidationInterval))) {
+      Data = I->second.Data;
+      Exists = I->second.Exists;
+      ++NumHits;
+      return true;
+    }
+  }
+  ++NumMisses;
+  return false;
+}
+
+void SharedStatCache::record(StringRef Path, const FileData &Data,
+                             bool Exists) {
+  Shard &S = getShard(Path);
+  std::lock_guard<std::mutex> Lock(S.Mutex);
+  Entry &E = S.Entries[Path];
+  E.Data = Data;
+  E.Exists = Exists;
+  E.Recorded = std::chrono::steady_clock::now();
+}
+
+void SharedStatCache::insert(StringRef Path, const FileData &Data) {
+  record(Path, Data, /*Exists=*/true);
+}
+
+void SharedStatCache::insertMissing(StringRef Path) {
+  if (Opts.CacheMissingPaths)
+    record(Path, FileData(), /*Exists=*/false);
+}
+
+void SharedStatCache::clear() {
+  for (Shard &S : Shards) {
+    std::lock_guard<std::mutex> Lock(S.Mutex);
+    S.Entries.clear();
+  }
+}
+
+SharedStatCacheClient::LookupResult
+SharedStatCacheClient::getStat(const char *Path, FileData &Data, bool isFile,
+                               std::unique_ptr<vfs::File> *F,
+                               vfs::FileSystem &FS) {
+  bool IsAbsolute = llvm::sys::path::is_absolute(Path);
+  bool Exists;
+  if (IsAbsolute && Shared->lookup(Path, Data, Exists))
+    return Exists ? CacheExists : CacheMissing;
+
+  LookupResult Result = statChained(Path, Data, isFile, F, FS);
+  if (!IsAbsolute)
+    return Result;
+
+  if (Result == CacheExists)
+    Shared->insert(Path, Data);
+  else
+    Shared->insertMissing(Path);
+  return Result;
+}
@@ -0,0 +1,168 @@
+//===--- FrozenSourceManager.cpp - Read-only SourceManager view -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the FrozenSourceManager class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/FrozenSourceManager.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <algorithm>
+
+using namespace clang;
+using namespace SrcMgr;
+
+FrozenSourceManager::FrozenSourceManager(const SourceManager &SM)
+    : SM(SM), NextLocalOffset(SM.getNextLocalOffset()) {
+  LocalEntries.reserve(SM.local_sloc_entry_size());
+  for (unsigned I = 0, N = SM.local_sloc_entry_size(); I != N; ++I)
+    LocalEntries.push_back(SM.getLocalSLocEntry(I));
+
+  // Loaded entries are normally read from the AST file on demand.
+  LoadedEntries.reserve(SM.loaded_sloc_entry_size());
+  for (unsigned I = 0, N = SM.loaded_sloc_entry_size(); I != N; ++I)
+    LoadedEntries.push_back(SM.getLoadedSLocEntry(I));
+
+  // Page in every buffer and build its line table now, so queries never have
+  // to.  Many FileIDs share a ContentCache; only the first does any work.
+  auto Prepare = [&](const SLocEntry &E, FileID FID) {
+    if (!E.isFile())
+      return;
+    bool Invalid = false;
+    SM.getLineNumber(FID, 0, &Invalid);
+  };
+  for (unsigned I = 1, N = LocalEntries.size(); I != N; ++I)
+    Prepare(LocalEntries[I], FileID::get(I));
+  for (unsigned I = 0, N = LoadedEntries.size(); I != N; ++I)
+    Prepare(LoadedEntries[I], FileID::get(-int(I) - 2));
+}
+
+FileID FrozenSourceManager::getFileID(SourceLocation Loc) const {
+  unsigned SLocOffset = Loc.getOffset();
+  if (!SLocOffset)
+    return FileID();
+
+  // The local table is sorted by increasing offset, and the loaded table by
+  // decreasing offset.  Either way we want the entry with the largest offset
+  // that is not past SLocOffset.
+  if (SLocOffset < NextLocalOffset) {
+    auto I = std::upper_bound(
+        LocalEntries.begin(), LocalEntries.end(), SLocOffset,
+        [](unsigned Offset, const SLocEntry &E) {
+          return Offset < E.getOffset();
+        });
+    return FileID::get(int(I - LocalEntries.begin()) - 1);
+  }
+
+  auto I = std::lower_bound(LoadedEntries.begin(), LoadedEntries.end(),
+                            SLocOffset,
+                            [](const SLocEntry &E, unsigned Offset) {
+                              return E.getOffset() > Offset;
+                            });
+  if (I == LoadedEntries.end())
+    return FileID();
+  return FileID::get(-int(I - LoadedEntries.begin()) - 2);
+}
+
+std::pair<FileID, unsigned>
+FrozenSourceManager::getDecomposedLoc(SourceLocation Loc) const {
+  FileID FID = getFileID(Loc);
+  if (FID.isInvalid())
+    return std::make_pair(FID, 0);
+  return std::make_pair(FID, Loc.getOffset() - getSLocEntry(FID).getOffset());
+}
+
+std::pair<FileID, unsigned>
+FrozenSourceManager::getDecomposedExpansionLoc(SourceLocation Loc) const {
+  std::pair<FileID, unsigned> LocInfo = getDecomposedLoc(Loc);
+  while (LocInfo.first.isValid()) {
+    const SLocEntry &E = getSLocEntry(LocInfo.first);
+    if (E.isFile())
+      break;
+    LocInfo = getDecomposedLoc(E.getExpansion().getExpansionLocStart());
+  }
+  return LocInfo;
+}
+
+std::pair<FileID, unsigned>
+FrozenSourceManager::getDecomposedSpellingLoc(SourceLocation Loc) const {
+  std::pair<FileID, unsigned> LocInfo = getDecomposedLoc(Loc);
+  while (LocInfo.first.isValid()) {
+    const SLocEntry &E = getSLocEntry(LocInfo.first);
+    if (E.isFile())
+      break;
+    LocInfo = getDecomposedLoc(
+        E.getExpansion().getSpellingLoc().getLocWithOffset(LocInfo.second));
+  }
+  return LocInfo;
+}
+
+const ContentCache *FrozenSourceManager::getContentCache(FileID FID) const {
+  if (FID.isInvalid())
+    return nullptr;
+  const SLocEntry &E = getSLocEntry(FID);
+  if (!E.isFile())
+    return nullptr;
+  return E.getFile().getContentCache();
+}
+
+StringRef FrozenSourceManager::getBufferData(FileID FID) const {
+  const ContentCache *Content = getContentCache(FID);
+  if (!Content || !Content->getRawBuffer())
+    return StringRef();
+  return Content->getRawBuffer()->getBuffer();
+}
+
+const FileEntry *FrozenSourceManager::getFileEntryForID(FileID FID) const {
+  const ContentCache *Content = getContentCache(FID);
+  return Content ? Content->OrigEntry : nullptr;
+}
+
+unsigned FrozenSourceManager::getLineNumber(FileID FID,
+                                            unsigned FilePos) const {
+  const ContentCache *Content = getContentCache(FID);
+  if (!Content || !Content->SourceLineCache)
+    return 0;
+
+  // The line table holds the offset at which each line starts.
+  const unsigned *Begin = Content->SourceLineCache;
+  const unsigned *End = Begin + Content->NumLines;
+  return std::upper_bound(Begin, End, FilePos) - Begin;
+}
+
+unsigned FrozenSourceManager::getColumnNumber(FileID FID,
+                                              unsigned FilePos) const {
+  unsigned Line = getLineNumber(FID, FilePos);
+  if (!Line)
+    return 0;
+  return FilePos - getContentCache(FID)->SourceLineCache[Line - 1] + 1;
+}
+
+unsigned FrozenSourceManager::getSpellingLineNumber(SourceLocation Loc) const {
+  std::pair<FileID, unsigned> LocInfo = getDecomposedSpellingLoc(Loc);
+  return getLineNumber(LocInfo.first, LocInfo.second);
+}
+
+unsigned
+FrozenSourceManager::getSpellingColumnNumber(SourceLocation Loc) const {
+  std::pair<FileID, unsigned> LocInfo = getDecomposedSpellingLoc(Loc);
+  return getColumnNumber(LocInfo.first, LocInfo.second);
+}
+
+unsigned
+FrozenSourceManager::getExpansionLineNumber(SourceLocation Loc) const {
+  std::pair<FileID, unsigned> LocInfo = getDecomposedExpansionLoc(Loc);
+  return getLineNumber(LocInfo.first, LocInfo.second);
+}
+
+unsigned
+FrozenSourceManager::getExpansionColumnNumber(SourceLocation Loc) const {
+  std::pair<FileID, unsigned> LocInfo = getDecomposedExpansionLoc(Loc);
+  return getColumnNumber(LocInfo.first, LocInfo.second);
+}
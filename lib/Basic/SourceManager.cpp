@@ -20,6 +20,7 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/Capacity.h"
 #include "llvm/Support/Compiler.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
@@ -362,7 +363,7 @@ SourceManager::SourceManager(DiagnosticsEngine &Diag, FileManager &FileMgr,
   : Diag(Diag), FileMgr(FileMgr), OverridenFilesKeepOriginalName(true),
     UserFilesAreVolatile(UserFilesAreVolatile), FilesAreTransient(false),
     ExternalSLocEntries(nullptr), LineTable(nullptr), NumLinearScans(0),
-    NumBinaryProbes(0) {
+    NumBinaryProbes(0), NumRecentFileIDHits(0) {
   clearIDTables();
   Diag.setSourceManager(this);
 }
@@ -398,6 +399,10 @@ void SourceManager::clearIDTables() {
   LastLineNoFileIDQuery = FileID();
   LastLineNoContentCache = nullptr;
   LastFileIDLookup = FileID();
+  std::fill_n(RecentFileIDLookups, NumRecentFileIDLookups,
+              RecentFileIDLookup{0, 0, FileID()});
+  NextRecentFileIDLookup = 0;
+  LastRecentFileIDHit = 0;
 
   if (LineTable)
     LineTable->clear();
@@ -711,11 +716,56 @@ FileID SourceManager::getFileIDSlow(unsigned SLocOffset) const {
   if (!SLocOffset)
     return FileID::get(0);
 
+  FileID Res = getRecentFileIDLookup(SLocOffset);
+  if (Res.isValid()) {
+    LastFileIDLookup = Res;
+    ++NumRecentFileIDHits;
+    return Res;
+  }
+
   // Now it is time to search for the correct file. See where the SLocOffset
   // sits in the global view and consult local or loaded buffers for it.
   if (SLocOffset < NextLocalOffset)
-    return getFileIDLocal(SLocOffset);
-  return getFileIDLoaded(SLocOffset);
+    Res = getFileIDLocal(SLocOffset);
+  else
+    Res = getFileIDLoaded(SLocOffset);
+
+  // The searches only remember files, not macro expansions.  Only local
+  // files are cached; their extent never changes.
+  if (Res.isValid() && Res == LastFileIDLookup && Res.ID > 0) {
+    unsigned ID = Res.ID;
+    RecentFileIDLookup &Entry = RecentFileIDLookups[NextRecentFileIDLookup];
+    Entry.Begin = LocalSLocEntryTable[ID].getOffset();
+    Entry.End = ID + 1 < LocalSLocEntryTable.size()
+                    ? LocalSLocEntryTable[ID + 1].getOffset()
+                    : NextLocalOffset;
+    Entry.FID = Res;
+    LastRecentFileIDHit = NextRecentFileIDLookup;
+    NextRecentFileIDLookup =
+        (NextRecentFileIDLookup + 1) % NumRecentFileIDLookups;
+  }
+  return Res;
+}
+
+/// \brief Return the recently looked up file FileID that contains
+/// \p SLocOffset, or an invalid FileID if there is none.
+FileID SourceManager::getRecentFileIDLookup(unsigned SLocOffset) const {
+  if (SLocOffset >= NextLocalOffset)
+    return FileID();
+
+  // The entry that hit last is the most likely to hit again.
+  const RecentFileIDLookup &Last = RecentFileIDLookups[LastRecentFileIDHit];
+  if (Last.Begin <= SLocOffset && SLocOffset < Last.End)
+    return Last.FID;
+
+  for (unsigned I = 0; I != NumRecentFileIDLookups; ++I) {
+    const RecentFileIDLookup &Entry = RecentFileIDLookups[I];
+    if (Entry.Begin <= SLocOffset && SLocOffset < Entry.End) {
+      LastRecentFileIDHit = I;
+      return Entry.FID;
+    }
+  }
+  return FileID();
 }
 
 /// \brief Return the FileID for a SourceLocation with a low offset.
@@ -1212,66 +1262,45 @@ static void ComputeLineNumbers(DiagnosticsEngine &Diag, ContentCache *FI,
   LineOffsets.push_back(0);
 
   const unsigned char *Buf = (const unsigned char *)Buffer->getBufferStart();
-  const unsigned char *End = (const unsigned char *)Buffer->getBufferEnd();
-  unsigned Offs = 0;
-  while (1) {
-    // Skip over the contents of the line.
-    const unsigned char *NextBuf = (const unsigned char *)Buf;
+  unsigned Size = Buffer->getBufferSize();
+
+  // Record the start of the line after the newline at \p Pos.  \r\n and \n\r
+  // are a single newline.  The buffer is null terminated, so looking one
+  // character past the end is fine.
+  auto AddLineAfter = [&](unsigned Pos) {
+    unsigned LineStart = Pos + 1;
+    if ((Buf[LineStart] == '\n' || Buf[LineStart] == '\r') &&
+        Buf[LineStart] != Buf[Pos])
+      ++LineStart;
+    LineOffsets.push_back(LineStart);
+  };
 
+  unsigned Pos = 0;
 #ifdef __SSE2__
-    // Try to skip to the next newline using SSE instructions. This is very
-    // performance sensitive for programs with lots of diagnostics and in -E
-    // mode.
-    __m128i CRs = _mm_set1_epi8('\r');
-    __m128i LFs = _mm_set1_epi8('\n');
-
-    // First fix up the alignment to 16 bytes.
-    while (((uintptr_t)NextBuf & 0xF) != 0) {
-      if (*NextBuf == '\n' || *NextBuf == '\r' || *NextBuf == '\0')
-        goto FoundSpecialChar;
-      ++NextBuf;
-    }
-
-    // Scan 16 byte chunks for '\r' and '\n'. Ignore '\0'.
-    while (NextBuf+16 <= End) {
-      const __m128i Chunk = *(const __m128i*)NextBuf;
-      __m128i Cmp = _mm_or_si128(_mm_cmpeq_epi8(Chunk, CRs),
-                                 _mm_cmpeq_epi8(Chunk, LFs));
-      unsigned Mask = _mm_movemask_epi8(Cmp);
-
-      // If we found a newline, adjust the pointer and jump to the handling code.
-      if (Mask != 0) {
-        NextBuf += llvm::countTrailingZeros(Mask);
-        goto FoundSpecialChar;
-      }
-      NextBuf += 16;
+  // Find the newlines 16 bytes at a time.  This is very performance sensitive
+  // for programs with lots of diagnostics and in -E mode, and a chunk often
+  // holds several lines, so handle every newline in it before moving on.
+  const __m128i CRs = _mm_set1_epi8('\r');
+  const __m128i LFs = _mm_set1_epi8('\n');
+  for (; Pos + 16 <= Size; Pos += 16) {
+    const __m128i Chunk = _mm_loadu_si128((const __m128i *)(Buf + Pos));
+    unsigned Mask = _mm_movemask_epi8(_mm_or_si128(
+        _mm_cmpeq_epi8(Chunk, CRs), _mm_cmpeq_epi8(Chunk, LFs)));
+    while (Mask) {
+      unsigned NewlinePos = Pos + llvm::countTrailingZeros(Mask);
+      Mask &= Mask - 1;
+      // Skip the second half of a two character newline.
+      if (NewlinePos >= LineOffsets.back())
+        AddLineAfter(NewlinePos);
     }
+  }
+  Pos = std::max(Pos, LineOffsets.back());
 #endif
 
-    while (*NextBuf != '\n' && *NextBuf != '\r' && *NextBuf != '\0')
-      ++NextBuf;
-
-#ifdef __SSE2__
-FoundSpecialChar:
-#endif
-    Offs += NextBuf-Buf;
-    Buf = NextBuf;
-
-    if (Buf[0] == '\n' || Buf[0] == '\r') {
-      // If this is \n\r or \r\n, skip both characters.
-      if ((Buf[1] == '\n' || Buf[1] == '\r') && Buf[0] != Buf[1]) {
-        ++Offs;
-        ++Buf;
-      }
-      ++Offs;
-      ++Buf;
-      LineOffsets.push_back(Offs);
-    } else {
-      // Otherwise, this is a null.  If end of file, exit.
-      if (Buf == End) break;
-      // Otherwise, skip the null.
-      ++Offs;
-      ++Buf;
+  for (; Pos < Size; ++Pos) {
+    if (Buf[Pos] == '\n' || Buf[Pos] == '\r') {
+      AddLineAfter(Pos);
+      Pos = LineOffsets.back() - 1;
     }
   }
 
@@ -2152,7 +2181,8 @@ void SourceManager::PrintStats() const {
                << NumLineNumsComputed << " files with line #'s computed, "
                << NumMacroArgsComputed << " files with macro args computed.\n";
   llvm::errs() << "FileID scans: " << NumLinearScans << " linear, "
-               << NumBinaryProbes << " binary.\n";
+               << NumBinaryProbes << " binary, " << NumRecentFileIDHits
+               << " recent lookup hits.\n";
 }
 
 LLVM_DUMP_METHOD void SourceManager::dump() const {
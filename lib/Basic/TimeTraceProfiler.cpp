@@ -0,0 +1,185 @@
+//===--- TimeTraceProfiler.cpp - Hierarchical compile time profiler -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the time trace profiler used by -ftime-trace.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/TimeTraceProfiler.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+using namespace clang;
+
+namespace clang {
+TimeTraceProfiler *TimeTraceProfilerInstance = nullptr;
+
+namespace {
+typedef std::chrono::steady_clock ClockType;
+typedef std::chrono::microseconds DurationType;
+
+typedef std::pair<unsigned, DurationType> TotalType;
+
+struct TraceEntry {
+  ClockType::time_point Start;
+  DurationType Duration;
+  std::string Name;
+  std::string Detail;
+};
+} // end anonymous namespace
+
+class TimeTraceProfiler {
+public:
+  explicit TimeTraceProfiler(unsigned Granularity)
+      : StartTime(ClockType::now()), Granularity(Granularity) {}
+
+  void begin(std::string Name, std::string Detail) {
+    Stack.push_back(TraceEntry{ClockType::now(), DurationType(0),
+                               std::move(Name), std::move(Detail)});
+  }
+
+  void end() {
+    assert(!Stack.empty() && "time trace region ended but none was begun");
+    TraceEntry &E = Stack.back();
+    E.Duration = std::chrono::duration_cast<DurationType>(ClockType::now() -
+                                                          E.Start);
+
+    // Only count the outermost region of each kind towards the totals, so
+    // that recursive regions (e.g. nested instantiations) are not counted
+    // twice.
+    if (std::none_of(Stack.begin(), Stack.end() - 1,
+                     [&](const TraceEntry &Outer) {
+                       return Outer.Name == E.Name;
+                     })) {
+      auto &Total = Totals[E.Name];
+      ++Total.first;
+      Total.second += E.Duration;
+    }
+
+    if (E.Duration >= DurationType(Granularity))
+      Entries.push_back(std::move(E));
+    Stack.pop_back();
+  }
+
+  void write(raw_ostream &OS);
+
+private:
+  std::vector<TraceEntry> Stack;
+  std::vector<TraceEntry> Entries;
+  llvm::StringMap<TotalType> Totals;
+  const ClockType::time_point StartTime;
+  const unsigned Granularity;
+};
+} // end namespace clang
+
+/// Write \p Str as a JSON string literal.
+static void writeJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned char C : Str) {
+    switch (C) {
+    case '"':  OS << "\\\""; break;
+    case '\\': OS << "\\\\"; break;
+    case '\n': OS << "\\n"; break;
+    case '\t': OS << "\\t"; break;
+    default:
+      if (C < 0x20)
+        OS << llvm::format("\\u%04x", C);
+      else
+        OS << C;
+    }
+  }
+  OS << '"';
+}
+
+void TimeTraceProfiler::write(raw_ostream &OS) {
+  // Regions which are still open (e.g. because of a fatal error) are
+  // reported as ending now.
+  while (!Stack.empty())
+    end();
+
+  OS << "{\"traceEvents\":[\n";
+
+  auto WriteEvent = [&](unsigned Tid, int64_t Start, int64_t Duration,
+                        StringRef Name, StringRef Detail) {
+    OS << "{\"pid\":1,\"tid\":" << Tid << ",\"ph\":\"X\",\"ts\":" << Start
+       << ",\"dur\":" << Duration << ",\"name\":";
+    writeJSONString(OS, Name);
+    OS << ",\"args\":{\"detail\":";
+    writeJSONString(OS, Detail);
+    OS << "}},\n";
+  };
+
+  for (const TraceEntry &E : Entries) {
+    int64_t Start =
+        std::chrono::duration_cast<DurationType>(E.Start - StartTime).count();
+    WriteEvent(0, Start, E.Duration.count(), E.Name, E.Detail);
+  }
+
+  // Emit the totals of each kind of region on their own track, longest
+  // first, laid out back to back.
+  std::vector<const llvm::StringMapEntry<TotalType> *> SortedTotals;
+  for (const auto &Total : Totals)
+    SortedTotals.push_back(&Total);
+  std::sort(SortedTotals.begin(), SortedTotals.end(),
+            [](const llvm::StringMapEntry<TotalType> *A,
+               const llvm::StringMapEntry<TotalType> *B) {
+              if (A->second.second != B->second.second)
+                return A->second.second > B->second.second;
+              return A->first() < B->first();
+            });
+  int64_t TotalStart = 0;
+  for (const auto *Total : SortedTotals) {
+    int64_t Duration = Total->second.second.count();
+    std::string Count;
+    llvm::raw_string_ostream(Count) << Total->second.first << " occurrences";
+    WriteEvent(1, TotalStart, Duration, ("Total " + Total->first()).str(),
+               Count);
+    TotalStart += Duration;
+  }
+
+  OS << "{\"cat\":\"\",\"pid\":1,\"tid\":0,\"ts\":0,\"ph\":\"M\","
+        "\"name\":\"process_name\",\"args\":{\"name\":\"clang\"}}\n";
+  OS << "]}\n";
+}
+
+void clang::timeTraceProfilerInitialize(unsigned Granularity) {
+  assert(!TimeTraceProfilerInstance && "profiler already initialized");
+  TimeTraceProfilerInstance = new TimeTraceProfiler(Granularity);
+}
+
+void clang::timeTraceProfilerCleanup() {
+  delete TimeTraceProfilerInstance;
+  TimeTraceProfilerInstance = nullptr;
+}
+
+void clang::timeTraceProfilerWrite(raw_ostream &OS) {
+  assert(TimeTraceProfilerInstance && "profiler not initialized");
+  TimeTraceProfilerInstance->write(OS);
+}
+
+void clang::timeTraceProfilerBegin(StringRef Name, StringRef Detail) {
+  if (TimeTraceProfilerInstance)
+    TimeTraceProfilerInstance->begin(Name.str(), Detail.str());
+}
+
+void clang::timeTraceProfilerBegin(StringRef Name,
+                                   llvm::function_ref<std::string()> Detail) {
+  if (TimeTraceProfilerInstance)
+    TimeTraceProfilerInstance->begin(Name.str(), Detail());
+}
+
+void clang::timeTraceProfilerEnd() {
+  if (TimeTraceProfilerInstance)
+    TimeTraceProfilerInstance->end();
+}
@@ -11,9 +11,11 @@
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/TargetOptions.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Frontend/CodeGenOptions.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/Utils.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Triple.h"
@@ -24,6 +26,7 @@
 #include "llvm/CodeGen/RegAllocRegistry.h"
 #include "llvm/CodeGen/SchedulerRegistry.h"
 #include "llvm/IR/DataLayout.h"
+#include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/ModuleSummaryIndex.h"
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IR/LegacyPassManager.h"
@@ -33,9 +36,12 @@
 #include "llvm/MC/SubtargetFeature.h"
 #include "llvm/Object/ModuleSummaryIndexObjectFile.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
@@ -48,8 +54,12 @@
 #include "llvm/Transforms/ObjCARC.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Scalar/GVN.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "llvm/Transforms/Utils/SymbolRewriter.h"
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 using namespace clang;
 using namespace llvm;
 
@@ -95,6 +105,17 @@ private:
   bool AddEmitPasses(legacy::PassManager &CodeGenPasses, BackendAction Action,
                      raw_pwrite_stream &OS);
 
+  /// Split the module and run the code generator on the partitions in
+  /// parallel, writing the first partition to \p OS and the others to the
+  /// files named by -parallel-codegen-output.
+  void EmitObjectPartitions(raw_pwrite_stream &OS);
+
+  /// Run the code generator on one partition, given as \p Bitcode, in \p Ctx.
+  ///
+  /// \return True on success.
+  bool generatePartition(LLVMContext &Ctx, StringRef Bitcode,
+                         raw_pwrite_stream &OS);
+
 public:
   EmitAssemblyHelper(DiagnosticsEngine &_Diags, const CodeGenOptions &CGOpts,
                      const clang::TargetOptions &TOpts,
@@ -603,11 +624,15 @@ void EmitAssemblyHelper::CreateTargetMachine(bool MustCreateTM) {
                                           Options, RM, CM, OptLevel));
 }
 
-bool EmitAssemblyHelper::AddEmitPasses(legacy::PassManager &CodeGenPasses,
-                                       BackendAction Action,
-                                       raw_pwrite_stream &OS) {
+/// Add the passes that run the code generator with \p TM.
+///
+/// \return True on failure, like TargetMachine::addPassesToEmitFile.
+static bool addCodeGenPasses(legacy::PassManager &CodeGenPasses,
+                             TargetMachine &TM,
+                             const CodeGenOptions &CodeGenOpts,
+                             BackendAction Action, raw_pwrite_stream &OS) {
   // Add LibraryInfo.
-  llvm::Triple TargetTriple(TheModule->getTargetTriple());
+  llvm::Triple TargetTriple(TM.getTargetTriple());
   std::unique_ptr<TargetLibraryInfoImpl> TLII(
       createTLII(TargetTriple, CodeGenOpts));
   CodeGenPasses.add(new TargetLibraryInfoWrapperPass(*TLII));
@@ -628,8 +653,14 @@ bool EmitAssemblyHelper::AddEmitPasses(legacy::PassManager &CodeGenPasses,
   if (CodeGenOpts.OptimizationLevel > 0)
     CodeGenPasses.add(createObjCARCContractPass());
 
-  if (TM->addPassesToEmitFile(CodeGenPasses, OS, CGFT,
-                              /*DisableVerify=*/!CodeGenOpts.VerifyModule)) {
+  return TM.addPassesToEmitFile(CodeGenPasses, OS, CGFT,
+                                /*DisableVerify=*/!CodeGenOpts.VerifyModule);
+}
+
+bool EmitAssemblyHelper::AddEmitPasses(legacy::PassManager &CodeGenPasses,
+                                       BackendAction Action,
+                                       raw_pwrite_stream &OS) {
+  if (addCodeGenPasses(CodeGenPasses, *TM, CodeGenOpts, Action, OS)) {
     Diags.Report(diag::err_fe_unable_to_interface_with_target);
     return false;
   }
@@ -637,6 +668,161 @@ bool EmitAssemblyHelper::AddEmitPasses(legacy::PassManager &CodeGenPasses,
   return true;
 }
 
+namespace {
+/// Hands the diagnostics from the partitions' LLVMContexts to the handlers
+/// of the main one, in partition order.
+///
+/// A partition only forwards a diagnostic once all the partitions before it
+/// have finished, so at most one thread talks to the handlers at a time and
+/// the output does not depend on thread scheduling.  Every partition has its
+/// own thread, so the partitions that wait always make progress.
+class PartitionDiagnostics {
+  LLVMContext &MainCtx;
+  std::mutex Mutex;
+  std::condition_variable Finished;
+  std::vector<bool> Done;
+  unsigned FirstUnfinished = 0;
+
+public:
+  struct Partition {
+    PartitionDiagnostics *Parent;
+    unsigned Index;
+  };
+
+  PartitionDiagnostics(LLVMContext &MainCtx, unsigned NumPartitions)
+      : MainCtx(MainCtx), Done(NumPartitions) {}
+
+  /// Send the diagnostics of \p Ctx to the main context's handlers.
+  void install(LLVMContext &Ctx, Partition &P) {
+    Ctx.setDiagnosticHandler(forwardDiagnostic, &P);
+    Ctx.setDiagnosticHotnessRequested(
+        MainCtx.getDiagnosticHotnessRequested());
+    Ctx.setInlineAsmDiagnosticHandler(forwardInlineAsmDiagnostic, &P);
+  }
+
+  /// Note that partition \p Index is done, letting the later ones report.
+  void finish(unsigned Index) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Done[Index] = true;
+    while (FirstUnfinished != Done.size() && Done[FirstUnfinished])
+      ++FirstUnfinished;
+    Finished.notify_all();
+  }
+
+private:
+  void waitForTurn(unsigned Index) {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    Finished.wait(Lock, [&] { return FirstUnfinished == Index; });
+  }
+
+  static void forwardDiagnostic(const DiagnosticInfo &DI, void *Context) {
+    Partition &P = *static_cast<Partition *>(Context);
+    P.Parent->waitForTurn(P.Index);
+    P.Parent->MainCtx.diagnose(DI);
+  }
+
+  static void forwardInlineAsmDiagnostic(const SMDiagnostic &SM,
+                                         void *Context, unsigned LocCookie) {
+    Partition &P = *static_cast<Partition *>(Context);
+    P.Parent->waitForTurn(P.Index);
+    LLVMContext &MainCtx = P.Parent->MainCtx;
+    if (LLVMContext::InlineAsmDiagHandlerTy Handler =
+            MainCtx.getInlineAsmDiagnosticHandler())
+      Handler(SM, MainCtx.getInlineAsmDiagnosticContext(), LocCookie);
+    else
+      MainCtx.diagnose(DiagnosticInfoInlineAsm(LocCookie, SM.getMessage(),
+                                               DS_Error));
+  }
+};
+}
+
+void EmitAssemblyHelper::EmitObjectPartitions(raw_pwrite_stream &OS) {
+  SmallVector<raw_pwrite_stream *, 8> OSs;
+  OSs.push_back(&OS);
+  std::vector<std::unique_ptr<raw_fd_ostream>> PartitionOSs;
+  for (const std::string &Path : CodeGenOpts.ParallelCodeGenOutputs) {
+    std::error_code EC;
+    PartitionOSs.push_back(
+        llvm::make_unique<raw_fd_ostream>(Path, EC, sys::fs::F_None));
+    if (EC) {
+      Diags.Report(diag::err_fe_unable_to_open_output) << Path << EC.message();
+      return;
+    }
+    OSs.push_back(PartitionOSs.back().get());
+  }
+
+  // The threads work in separate LLVMContexts, so hand each partition over
+  // as bitcode.  The split is done here and only depends on the module, so
+  // every partition's output is the same however the threads are scheduled.
+  // Locals are kept with their users so that no new symbols are exported.
+  //
+  // Module-level inline asm can refer to any symbol, locals included, so a
+  // module that has some is not split: it all goes to the first partition
+  // and the others are left empty.
+  std::vector<SmallString<0>> Partitions(OSs.size());
+  if (TheModule->getModuleInlineAsm().empty()) {
+    unsigned NumPartitions = 0;
+    SplitModule(CloneModule(TheModule), OSs.size(),
+                [&](std::unique_ptr<Module> MPart) {
+                  raw_svector_ostream BCOS(Partitions[NumPartitions++]);
+                  WriteBitcodeToFile(MPart.get(), BCOS);
+                },
+                /*PreserveLocals=*/true);
+  } else {
+    raw_svector_ostream BCOS(Partitions[0]);
+    WriteBitcodeToFile(TheModule, BCOS);
+    Module Empty(TheModule->getModuleIdentifier(), TheModule->getContext());
+    Empty.setTargetTriple(TheModule->getTargetTriple());
+    Empty.setDataLayout(TheModule->getDataLayout());
+    for (unsigned I = 1, E = Partitions.size(); I != E; ++I) {
+      raw_svector_ostream EmptyOS(Partitions[I]);
+      WriteBitcodeToFile(&Empty, EmptyOS);
+    }
+  }
+
+  PartitionDiagnostics Diagnostics(TheModule->getContext(), OSs.size());
+  std::vector<PartitionDiagnostics::Partition> DiagPartitions;
+  for (unsigned I = 0, E = OSs.size(); I != E; ++I)
+    DiagPartitions.push_back({&Diagnostics, I});
+  std::vector<char> Failed(OSs.size());
+  {
+    ThreadPool Pool(OSs.size());
+    for (unsigned I = 0, E = OSs.size(); I != E; ++I)
+      Pool.async([&, I] {
+        LLVMContext Ctx;
+        Diagnostics.install(Ctx, DiagPartitions[I]);
+        Failed[I] = !generatePartition(Ctx, Partitions[I], *OSs[I]);
+        Diagnostics.finish(I);
+      });
+  }
+
+  for (char PartitionFailed : Failed)
+    if (PartitionFailed)
+      Diags.Report(diag::err_fe_unable_to_interface_with_target);
+}
+
+bool EmitAssemblyHelper::generatePartition(LLVMContext &Ctx,
+                                           StringRef Bitcode,
+                                           raw_pwrite_stream &OS) {
+  ErrorOr<std::unique_ptr<Module>> MPart =
+      parseBitcodeFile(MemoryBufferRef(Bitcode, "<split-module>"), Ctx);
+  if (!MPart)
+    return false;
+
+  std::unique_ptr<TargetMachine> PartTM(TM->getTarget().createTargetMachine(
+      TM->getTargetTriple().str(), TM->getTargetCPU(),
+      TM->getTargetFeatureString(), TM->Options, TM->getRelocationModel(),
+      TM->getCodeModel(), TM->getOptLevel()));
+  legacy::PassManager CodeGenPasses;
+  CodeGenPasses.add(
+      createTargetTransformInfoWrapperPass(PartTM->getTargetIRAnalysis()));
+  if (addCodeGenPasses(CodeGenPasses, *PartTM, CodeGenOpts, Backend_EmitObj,
+                       OS))
+    return false;
+  CodeGenPasses.run(**MPart);
+  return true;
+}
+
 void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
                                       std::unique_ptr<raw_pwrite_stream> OS) {
   TimeRegion Region(llvm::TimePassesIsEnabled ? &CodeGenerationTime : nullptr);
@@ -663,6 +849,11 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
 
   CreatePasses(PerModulePasses, PerFunctionPasses);
 
+  // With -parallel-codegen-output, the code generator runs on several
+  // threads, each with its own pass manager.
+  bool UseParallelCodeGen = Action == Backend_EmitObj &&
+                            !CodeGenOpts.ParallelCodeGenOutputs.empty();
+
   legacy::PassManager CodeGenPasses;
   CodeGenPasses.add(
       createTargetTransformInfoWrapperPass(getTargetIRAnalysis()));
@@ -683,6 +874,8 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
     break;
 
   default:
+    if (UseParallelCodeGen)
+      break;
     if (!AddEmitPasses(CodeGenPasses, Action, *OS))
       return;
   }
@@ -698,19 +891,26 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
 
     PerFunctionPasses.doInitialization();
     for (Function &F : *TheModule)
-      if (!F.isDeclaration())
+      if (!F.isDeclaration()) {
+        TimeTraceScope TimeScope("OptFunction", F.getName());
         PerFunctionPasses.run(F);
+      }
     PerFunctionPasses.doFinalization();
   }
 
   {
     PrettyStackTraceString CrashInfo("Per-module optimization passes");
+    TimeTraceScope TimeScope("OptModule", TheModule->getName());
     PerModulePasses.run(*TheModule);
   }
 
   {
     PrettyStackTraceString CrashInfo("Code generation");
-    CodeGenPasses.run(*TheModule);
+    TimeTraceScope TimeScope("CodeGenPasses");
+    if (UseParallelCodeGen)
+      EmitObjectPartitions(*OS);
+    else
+      CodeGenPasses.run(*TheModule);
   }
 }
 
@@ -793,6 +993,8 @@ void clang::EmitBackendOutput(DiagnosticsEngine &Diags,
     return;
   }
 
+  TimeTraceScope TimeScope("Backend");
+
   EmitAssemblyHelper AsmHelper(Diags, CGOpts, TOpts, LOpts, M);
 
   AsmHelper.EmitAssembly(Action, std::move(OS));
@@ -14,9 +14,17 @@
 #include "clang/Driver/Options.h"
 #include "clang/Driver/ToolChain.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 using namespace clang::driver;
 using namespace clang;
@@ -122,35 +130,46 @@ bool Compilation::CleanupFileMap(const ArgStringMap &Files,
   return Success;
 }
 
-int Compilation::ExecuteCommand(const Command &C,
-                                const Command *&FailingCommand) const {
-  if ((getDriver().CCPrintOptions ||
-       getArgs().hasArg(options::OPT_v)) && !getDriver().CCGenDiagnostics) {
-    raw_ostream *OS = &llvm::errs();
-
-    // Follow gcc implementation of CC_PRINT_OPTIONS; we could also cache the
-    // output stream.
-    if (getDriver().CCPrintOptions && getDriver().CCPrintOptionsFilename) {
-      std::error_code EC;
-      OS = new llvm::raw_fd_ostream(getDriver().CCPrintOptionsFilename, EC,
-                                    llvm::sys::fs::F_Append |
-                                        llvm::sys::fs::F_Text);
-      if (EC) {
-        getDriver().Diag(clang::diag::err_drv_cc_print_options_failure)
-            << EC.message();
-        FailingCommand = &C;
-        delete OS;
-        return 1;
-      }
+/// Print the command line for \p Cmd if -v or CC_PRINT_OPTIONS asked for it.
+///
+/// \return false if the CC_PRINT_OPTIONS log file could not be opened.
+static bool printCommandIfRequested(const Compilation &C, const Command &Cmd) {
+  const Driver &D = C.getDriver();
+  if ((!D.CCPrintOptions && !C.getArgs().hasArg(options::OPT_v)) ||
+      D.CCGenDiagnostics)
+    return true;
+
+  raw_ostream *OS = &llvm::errs();
+
+  // Follow gcc implementation of CC_PRINT_OPTIONS; we could also cache the
+  // output stream.
+  if (D.CCPrintOptions && D.CCPrintOptionsFilename) {
+    std::error_code EC;
+    OS = new llvm::raw_fd_ostream(D.CCPrintOptionsFilename, EC,
+                                  llvm::sys::fs::F_Append |
+                                      llvm::sys::fs::F_Text);
+    if (EC) {
+      D.Diag(clang::diag::err_drv_cc_print_options_failure) << EC.message();
+      delete OS;
+      return false;
     }
+  }
 
-    if (getDriver().CCPrintOptions)
-      *OS << "[Logging clang options]";
+  if (D.CCPrintOptions)
+    *OS << "[Logging clang options]";
 
-    C.Print(*OS, "\n", /*Quote=*/getDriver().CCPrintOptions);
+  Cmd.Print(*OS, "\n", /*Quote=*/D.CCPrintOptions);
 
-    if (OS != &llvm::errs())
-      delete OS;
+  if (OS != &llvm::errs())
+    delete OS;
+  return true;
+}
+
+int Compilation::ExecuteCommand(const Command &C,
+                                const Command *&FailingCommand) const {
+  if (!printCommandIfRequested(*this, C)) {
+    FailingCommand = &C;
+    return 1;
   }
 
   std::string Error;
@@ -170,6 +189,16 @@ int Compilation::ExecuteCommand(const Command &C,
 void Compilation::ExecuteJobs(
     const JobList &Jobs,
     SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const {
+#if LLVM_ENABLE_THREADS
+  // Redirected compilations (e.g. when generating crash diagnostics) are
+  // always run sequentially.
+  if (getDriver().getParallelJobs() > 1 && Jobs.size() > 1 && !Redirects) {
+    ExecuteJobsInParallel(Jobs, getDriver().getParallelJobs(),
+                          FailingCommands);
+    return;
+  }
+#endif
+
   for (const auto &Job : Jobs) {
     const Command *FailingCommand = nullptr;
     if (int Res = ExecuteCommand(Job, FailingCommand)) {
@@ -181,6 +210,184 @@ void Compilation::ExecuteJobs(
   }
 }
 
+namespace {
+/// The execution state of one job of a JobList run in parallel.
+struct ParallelJob {
+  enum StatusKind { Pending, Running, Finished, Skipped };
+
+  const Command *Cmd = nullptr;
+
+  /// The indices of the earlier jobs which produce inputs of this one.
+  SmallVector<unsigned, 4> Dependencies;
+
+  /// Files capturing the stdout and stderr of the job, so that its output can
+  /// be replayed in job order once it has finished.
+  SmallString<128> StdoutPath, StderrPath;
+  StringRef StdoutRef, StderrRef;
+  const StringRef *Redirects[3] = {nullptr, nullptr, nullptr};
+
+  StatusKind Status = Pending;
+  int Result = 0;
+  bool ExecutionFailed = false;
+  std::string Error;
+};
+} // end anonymous namespace
+
+/// Collect every action \p A is (transitively) built from.
+static void collectInputActions(const Action *A,
+                                llvm::SmallPtrSetImpl<const Action *> &Seen) {
+  if (!Seen.insert(A).second)
+    return;
+  for (const Action *Input : A->getInputs())
+    collectInputActions(Input, Seen);
+}
+
+/// Copy the contents of a captured output file to \p OS and remove the file.
+static void replayCapturedOutput(StringRef Path, raw_ostream &OS) {
+  if (Path.empty())
+    return;
+  if (llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+          llvm::MemoryBuffer::getFile(Path))
+    OS << (*Buffer)->getBuffer();
+  OS.flush();
+  llvm::sys::fs::remove(Path);
+}
+
+void Compilation::ExecuteJobsInParallel(
+    const JobList &Jobs, unsigned MaxJobs,
+    SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const {
+  // Jobs are created in dependency order, so a job can only depend on jobs
+  // which precede it in the list. A job depends on an earlier one if the
+  // earlier job's action is one of the actions it is built from; commands
+  // which share a source action (e.g. the objcopy step of -gsplit-dwarf)
+  // are kept in order as well.
+  std::vector<ParallelJob> State(Jobs.size());
+  std::vector<llvm::SmallPtrSet<const Action *, 8>> InputActions(Jobs.size());
+  unsigned Index = 0;
+  for (const Command &Job : Jobs) {
+    ParallelJob &PJ = State[Index];
+    PJ.Cmd = &Job;
+    collectInputActions(&Job.getSource(), InputActions[Index]);
+    for (unsigned Prev = 0; Prev != Index; ++Prev)
+      if (InputActions[Index].count(&State[Prev].Cmd->getSource()))
+        PJ.Dependencies.push_back(Prev);
+
+    // Capture the output of the job. If we fail to create the temporary files
+    // the job simply writes to our stdout and stderr.
+    int FD;
+    if (!llvm::sys::fs::createTemporaryFile("driver-job", "out", FD,
+                                            PJ.StdoutPath) &&
+        !llvm::sys::Process::SafelyCloseFileDescriptor(FD) &&
+        !llvm::sys::fs::createTemporaryFile("driver-job", "err", FD,
+                                            PJ.StderrPath) &&
+        !llvm::sys::Process::SafelyCloseFileDescriptor(FD)) {
+      PJ.StdoutRef = PJ.StdoutPath;
+      PJ.StderrRef = PJ.StderrPath;
+      PJ.Redirects[1] = &PJ.StdoutRef;
+      PJ.Redirects[2] = &PJ.StderrRef;
+    } else {
+      if (!PJ.StdoutPath.empty())
+        llvm::sys::fs::remove(PJ.StdoutPath);
+      PJ.StdoutPath.clear();
+      PJ.StderrPath.clear();
+    }
+    ++Index;
+  }
+
+  std::mutex Mutex;
+  std::condition_variable JobFinished;
+  std::vector<std::thread> Threads;
+  unsigned NumRunning = 0;
+  unsigned NextToRetire = 0;
+  bool HadFailure = false;
+
+  std::unique_lock<std::mutex> Lock(Mutex);
+  while (NextToRetire != State.size()) {
+    // Start every job whose dependencies have completed, in job order, as long
+    // as we have slots left. After a failure no new jobs are started, which
+    // matches the sequential behavior of bailing out on the first error.
+    for (unsigned I = NextToRetire, E = State.size();
+         I != E && NumRunning < MaxJobs && !HadFailure; ++I) {
+      ParallelJob &PJ = State[I];
+      if (PJ.Status != ParallelJob::Pending ||
+          llvm::any_of(PJ.Dependencies, [&](unsigned Dep) {
+            return State[Dep].Status != ParallelJob::Finished;
+          }))
+        continue;
+
+      if (!printCommandIfRequested(*this, *PJ.Cmd)) {
+        PJ.Status = ParallelJob::Finished;
+        PJ.Result = 1;
+        HadFailure = true;
+        break;
+      }
+
+      PJ.Status = ParallelJob::Running;
+      ++NumRunning;
+      Threads.emplace_back([&PJ, &Mutex, &JobFinished, &NumRunning,
+                            &HadFailure] {
+        std::string Error;
+        bool ExecutionFailed = false;
+        int Res = PJ.Cmd->Execute(PJ.Redirects[1] ? PJ.Redirects : nullptr,
+                                  &Error, &ExecutionFailed);
+
+        std::lock_guard<std::mutex> Guard(Mutex);
+        PJ.Result = Res;
+        PJ.ExecutionFailed = ExecutionFailed;
+        PJ.Error = std::move(Error);
+        PJ.Status = ParallelJob::Finished;
+        // Stop starting jobs right away, rather than when this job is
+        // retired; otherwise a job that depends on this one could start
+        // first.
+        if (Res || ExecutionFailed)
+          HadFailure = true;
+        --NumRunning;
+        JobFinished.notify_one();
+      });
+    }
+
+    // Retire finished jobs in order, replaying their output and reporting
+    // their failures, so that diagnostics appear in a deterministic order.
+    while (NextToRetire != State.size() &&
+           (State[NextToRetire].Status == ParallelJob::Finished ||
+            State[NextToRetire].Status == ParallelJob::Skipped)) {
+      ParallelJob &PJ = State[NextToRetire++];
+      replayCapturedOutput(PJ.StdoutPath, llvm::outs());
+      replayCapturedOutput(PJ.StderrPath, llvm::errs());
+      if (PJ.Status == ParallelJob::Skipped)
+        continue;
+
+      if (!PJ.Error.empty()) {
+        assert(PJ.Result && "Error string set with 0 result code!");
+        getDriver().Diag(clang::diag::err_drv_command_failure) << PJ.Error;
+      }
+      if (PJ.Result) {
+        FailingCommands.push_back(
+            std::make_pair(PJ.ExecutionFailed ? 1 : PJ.Result, PJ.Cmd));
+        HadFailure = true;
+      }
+    }
+
+    if (NextToRetire == State.size())
+      break;
+
+    // Once everything in flight has finished after a failure, the remaining
+    // jobs will never run.
+    if (HadFailure && NumRunning == 0) {
+      for (unsigned I = NextToRetire, E = State.size(); I != E; ++I)
+        if (State[I].Status == ParallelJob::Pending)
+          State[I].Status = ParallelJob::Skipped;
+      continue;
+    }
+
+    JobFinished.wait(Lock);
+  }
+  Lock.unlock();
+
+  for (std::thread &T : Threads)
+    T.join();
+}
+
 void Compilation::initCompilationForDiagnostics() {
   ForDiagnostics = true;
 
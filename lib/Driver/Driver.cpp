@@ -59,7 +59,7 @@ Driver::Driver(StringRef ClangExecutable, StringRef DefaultTargetTriple,
       CCCPrintBindings(false), CCPrintHeaders(false), CCLogDiagnostics(false),
       CCGenDiagnostics(false), DefaultTargetTriple(DefaultTargetTriple),
       CCCGenericGCCName(""), CheckInputsExist(true), CCCUsePCH(true),
-      SuppressMissingInputWarning(false) {
+      SuppressMissingInputWarning(false), ParallelJobs(1) {
 
   // Provide a sane fallback if no VFS is specified.
   if (!this->VFS)
@@ -545,6 +545,15 @@ Compilation *Driver::BuildCompilation(ArrayRef<const char *> ArgList) {
                     .Default(SaveTempsCwd);
   }
 
+  if (const Arg *A = Args.getLastArg(options::OPT_parallel_jobs_EQ)) {
+    StringRef Value = A->getValue();
+    if (Value.getAsInteger(10, ParallelJobs) || ParallelJobs == 0) {
+      Diags.Report(diag::err_drv_invalid_int_value) << A->getAsString(Args)
+                                                    << Value;
+      ParallelJobs = 1;
+    }
+  }
+
   setLTOMode(Args);
 
   // Ignore -fembed-bitcode options with LTO
@@ -3967,9 +3967,13 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   } else if (isa<MigrateJobAction>(JA)) {
     CmdArgs.push_back("-migrate");
   } else if (isa<PreprocessJobAction>(JA)) {
-    if (Output.getType() == types::TY_Dependencies)
-      CmdArgs.push_back("-Eonly");
-    else {
+    if (Output.getType() == types::TY_Dependencies) {
+      // Only the directives of each file can affect its dependencies.
+      if (Args.hasArg(options::OPT_fscan_dependency_directives))
+        CmdArgs.push_back("-scan-dependency-directives");
+      else
+        CmdArgs.push_back("-Eonly");
+    } else {
       CmdArgs.push_back("-E");
       if (Args.hasArg(options::OPT_rewrite_objc) &&
           !Args.hasArg(options::OPT_g_Group))
@@ -5191,6 +5195,24 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_print_source_range_info);
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_parseable_fixits);
   Args.AddLastArg(CmdArgs, options::OPT_ftime_report);
+  if (Arg *A = Args.getLastArg(options::OPT_ftime_trace,
+                               options::OPT_ftime_trace_EQ)) {
+    // Unless a file was given, put the trace next to the object file, or in
+    // the current directory when the object file is a temporary.
+    SmallString<128> TracePath;
+    if (A->getOption().matches(options::OPT_ftime_trace_EQ)) {
+      TracePath = A->getValue();
+    } else if (Output.isFilename() &&
+               (Args.hasArg(options::OPT_c) || Args.hasArg(options::OPT_S))) {
+      TracePath = Output.getFilename();
+      llvm::sys::path::replace_extension(TracePath, "json");
+    } else {
+      TracePath = llvm::sys::path::stem(Input.getBaseInput());
+      TracePath += ".json";
+    }
+    CmdArgs.push_back(Args.MakeArgString("-ftime-trace=" + TracePath));
+    Args.AddLastArg(CmdArgs, options::OPT_ftime_trace_granularity_EQ);
+  }
   Args.AddLastArg(CmdArgs, options::OPT_ftrapv);
 
   if (Arg *A = Args.getLastArg(options::OPT_ftrapv_handler_EQ)) {
@@ -5537,6 +5559,8 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                     options::OPT_fmodules_validate_once_per_build_session);
   }
 
+  Args.AddLastArg(CmdArgs, options::OPT_finclude_guard_database_EQ);
+
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_validate_system_headers);
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_disable_diagnostic_validation);
 
@@ -6112,8 +6136,33 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
       !C.getDriver().embedBitcodeEnabled() && isa<CompileJobAction>(JA))
     CmdArgs.push_back("-disable-llvm-passes");
 
+  // With -fparallel-codegen=N, the backend writes N partial objects, which
+  // are combined into the output with a relocatable link.  link.exe can't do
+  // that, so the option is ignored for COFF targets.
+  SmallVector<const char *, 8> CodeGenPartitions;
+  if (Arg *A = Args.getLastArg(options::OPT_fparallel_codegen_EQ)) {
+    unsigned Threads;
+    if (StringRef(A->getValue()).getAsInteger(10, Threads) || Threads == 0)
+      D.Diag(diag::err_drv_invalid_int_value) << A->getAsString(Args)
+                                              << A->getValue();
+    else if (Threads > 1 && Output.getType() == types::TY_Object &&
+             Output.isFilename() &&
+             !getToolChain().getTriple().isOSBinFormatCOFF())
+      for (unsigned I = 0; I != Threads; ++I)
+        CodeGenPartitions.push_back(C.addTempFile(
+            C.getArgs().MakeArgString(D.GetTemporaryPath(
+                llvm::sys::path::stem(Output.getFilename()), "o"))));
+  }
+
   if (Output.getType() == types::TY_Dependencies) {
     // Handled with other dependency code.
+  } else if (!CodeGenPartitions.empty()) {
+    CmdArgs.push_back("-o");
+    CmdArgs.push_back(CodeGenPartitions[0]);
+    for (const char *Partition : makeArrayRef(CodeGenPartitions).slice(1)) {
+      CmdArgs.push_back("-parallel-codegen-output");
+      CmdArgs.push_back(Partition);
+    }
   } else if (Output.isFilename()) {
     CmdArgs.push_back("-o");
     CmdArgs.push_back(Output.getFilename());
@@ -6200,6 +6249,18 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     C.addCommand(llvm::make_unique<Command>(JA, *this, Exec, CmdArgs, Inputs));
   }
 
+  // Link the partial objects from -fparallel-codegen, in order.
+  if (!CodeGenPartitions.empty()) {
+    ArgStringList LinkArgs;
+    LinkArgs.push_back("-r");
+    LinkArgs.push_back("-o");
+    LinkArgs.push_back(Output.getFilename());
+    LinkArgs.append(CodeGenPartitions.begin(), CodeGenPartitions.end());
+    const char *Linker = Args.MakeArgString(getToolChain().GetLinkerPath());
+    C.addCommand(
+        llvm::make_unique<Command>(JA, *this, Linker, LinkArgs, Inputs));
+  }
+
   // Handle the debug info splitting at object creation time if we're
   // creating an object.
   // TODO: Currently only works on linux with newer objcopy.
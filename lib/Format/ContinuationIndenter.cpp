@@ -87,7 +87,6 @@ LineState ContinuationIndenter::getInitialState(unsigned FirstIndent,
   State.StartOfStringLiteral = 0;
   State.StartOfLineLevel = 0;
   State.LowestLevelOnLine = 0;
-  State.IgnoreStackForComparison = false;
 
   // The first token has already been indented and thus consumed.
   moveStateToNextToken(State, DryRun, /*Newline=*/false);
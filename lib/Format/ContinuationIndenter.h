@@ -19,6 +19,7 @@
 #include "Encoding.h"
 #include "FormatToken.h"
 #include "clang/Format/Format.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/Support/Regex.h"
 
 namespace clang {
@@ -263,44 +264,39 @@ struct ParenState {
   // "function" in JavaScript) is not wrapped to a new line.
   bool NestedBlockInlined : 1;
 
-  bool operator<(const ParenState &Other) const {
-    if (Indent != Other.Indent)
-      return Indent < Other.Indent;
-    if (LastSpace != Other.LastSpace)
-      return LastSpace < Other.LastSpace;
-    if (NestedBlockIndent != Other.NestedBlockIndent)
-      return NestedBlockIndent < Other.NestedBlockIndent;
-    if (FirstLessLess != Other.FirstLessLess)
-      return FirstLessLess < Other.FirstLessLess;
-    if (BreakBeforeClosingBrace != Other.BreakBeforeClosingBrace)
-      return BreakBeforeClosingBrace;
-    if (QuestionColumn != Other.QuestionColumn)
-      return QuestionColumn < Other.QuestionColumn;
-    if (AvoidBinPacking != Other.AvoidBinPacking)
-      return AvoidBinPacking;
-    if (BreakBeforeParameter != Other.BreakBeforeParameter)
-      return BreakBeforeParameter;
-    if (NoLineBreak != Other.NoLineBreak)
-      return NoLineBreak;
-    if (LastOperatorWrapped != Other.LastOperatorWrapped)
-      return LastOperatorWrapped;
-    if (ColonPos != Other.ColonPos)
-      return ColonPos < Other.ColonPos;
-    if (StartOfFunctionCall != Other.StartOfFunctionCall)
-      return StartOfFunctionCall < Other.StartOfFunctionCall;
-    if (StartOfArraySubscripts != Other.StartOfArraySubscripts)
-      return StartOfArraySubscripts < Other.StartOfArraySubscripts;
-    if (CallContinuation != Other.CallContinuation)
-      return CallContinuation < Other.CallContinuation;
-    if (VariablePos != Other.VariablePos)
-      return VariablePos < Other.VariablePos;
-    if (ContainsLineBreak != Other.ContainsLineBreak)
-      return ContainsLineBreak;
-    if (ContainsUnwrappedBuilder != Other.ContainsUnwrappedBuilder)
-      return ContainsUnwrappedBuilder;
-    if (NestedBlockInlined != Other.NestedBlockInlined)
-      return NestedBlockInlined;
-    return false;
+  /// \brief Whether the two states lead to the same formatting decisions
+  /// for the rest of the line.
+  bool operator==(const ParenState &Other) const {
+    return Indent == Other.Indent && LastSpace == Other.LastSpace &&
+           NestedBlockIndent == Other.NestedBlockIndent &&
+           FirstLessLess == Other.FirstLessLess &&
+           BreakBeforeClosingBrace == Other.BreakBeforeClosingBrace &&
+           QuestionColumn == Other.QuestionColumn &&
+           AvoidBinPacking == Other.AvoidBinPacking &&
+           BreakBeforeParameter == Other.BreakBeforeParameter &&
+           NoLineBreak == Other.NoLineBreak &&
+           LastOperatorWrapped == Other.LastOperatorWrapped &&
+           ColonPos == Other.ColonPos &&
+           StartOfFunctionCall == Other.StartOfFunctionCall &&
+           StartOfArraySubscripts == Other.StartOfArraySubscripts &&
+           CallContinuation == Other.CallContinuation &&
+           VariablePos == Other.VariablePos &&
+           ContainsLineBreak == Other.ContainsLineBreak &&
+           ContainsUnwrappedBuilder == Other.ContainsUnwrappedBuilder &&
+           NestedBlockInlined == Other.NestedBlockInlined;
+  }
+
+  /// \brief Hashes the fields that \c operator== compares.
+  friend llvm::hash_code hash_value(const ParenState &State) {
+    return llvm::hash_combine(
+        State.Indent, State.LastSpace, State.NestedBlockIndent,
+        State.FirstLessLess, State.BreakBeforeClosingBrace,
+        State.QuestionColumn, State.AvoidBinPacking,
+        State.BreakBeforeParameter, State.NoLineBreak,
+        State.LastOperatorWrapped, State.ColonPos, State.StartOfFunctionCall,
+        State.StartOfArraySubscripts, State.CallContinuation,
+        State.VariablePos, State.ContainsLineBreak,
+        State.ContainsUnwrappedBuilder, State.NestedBlockInlined);
   }
 };
 
@@ -331,21 +327,6 @@ struct LineState {
   /// levels.
   std::vector<ParenState> Stack;
 
-  /// \brief Ignore the stack of \c ParenStates for state comparison.
-  ///
-  /// In long and deeply nested unwrapped lines, the current algorithm can
-  /// be insufficient for finding the best formatting with a reasonable amount
-  /// of time and memory. Setting this flag will effectively lead to the
-  /// algorithm not analyzing some combinations. However, these combinations
-  /// rarely contain the optimal solution: In short, accepting a higher
-  /// penalty early would need to lead to different values in the \c
-  /// ParenState stack (in an otherwise identical state) and these different
-  /// values would need to lead to a significant amount of avoided penalty
-  /// later.
-  ///
-  /// FIXME: Come up with a better algorithm instead.
-  bool IgnoreStackForComparison;
-
   /// \brief The indent of the first token.
   unsigned FirstIndent;
 
@@ -354,24 +335,28 @@ struct LineState {
   /// Does not need to be considered for memoization because it doesn't change.
   const AnnotatedLine *Line;
 
-  /// \brief Comparison operator to be able to used \c LineState in \c map.
-  bool operator<(const LineState &Other) const {
-    if (NextToken != Other.NextToken)
-      return NextToken < Other.NextToken;
-    if (Column != Other.Column)
-      return Column < Other.Column;
-    if (LineContainsContinuedForLoopSection !=
-        Other.LineContainsContinuedForLoopSection)
-      return LineContainsContinuedForLoopSection;
-    if (StartOfLineLevel != Other.StartOfLineLevel)
-      return StartOfLineLevel < Other.StartOfLineLevel;
-    if (LowestLevelOnLine != Other.LowestLevelOnLine)
-      return LowestLevelOnLine < Other.LowestLevelOnLine;
-    if (StartOfStringLiteral != Other.StartOfStringLiteral)
-      return StartOfStringLiteral < Other.StartOfStringLiteral;
-    if (IgnoreStackForComparison || Other.IgnoreStackForComparison)
-      return false;
-    return Stack < Other.Stack;
+  /// \brief Whether the two states lead to the same formatting decisions
+  /// for the rest of the line.  The stacks are only compared if
+  /// \p CompareStack is \c true.
+  bool isEquivalentTo(const LineState &Other, bool CompareStack) const {
+    return NextToken == Other.NextToken && Column == Other.Column &&
+           LineContainsContinuedForLoopSection ==
+               Other.LineContainsContinuedForLoopSection &&
+           StartOfLineLevel == Other.StartOfLineLevel &&
+           LowestLevelOnLine == Other.LowestLevelOnLine &&
+           StartOfStringLiteral == Other.StartOfStringLiteral &&
+           (!CompareStack || Stack == Other.Stack);
+  }
+
+  /// \brief Hashes the fields that \c isEquivalentTo compares.
+  llvm::hash_code getHash(bool CompareStack) const {
+    llvm::hash_code Hash = llvm::hash_combine(
+        NextToken, Column, LineContainsContinuedForLoopSection,
+        StartOfLineLevel, LowestLevelOnLine, StartOfStringLiteral);
+    if (!CompareStack)
+      return Hash;
+    return llvm::hash_combine(
+        Hash, llvm::hash_combine_range(Stack.begin(), Stack.end()));
   }
 };
 
@@ -734,7 +734,13 @@ bool getPredefinedStyle(StringRef Name, FormatStyle::LanguageKind Language,
   return true;
 }
 
-std::error_code parseConfiguration(StringRef Text, FormatStyle *Style) {
+static void printConfigurationDiagnostic(const llvm::SMDiagnostic &Diag,
+                                         void *Context) {
+  Diag.print(nullptr, *static_cast<raw_ostream *>(Context));
+}
+
+std::error_code parseConfiguration(StringRef Text, FormatStyle *Style,
+                                   raw_ostream &ErrOS) {
   assert(Style);
   FormatStyle::LanguageKind Language = Style->Language;
   assert(Language != FormatStyle::LK_None);
@@ -742,7 +748,8 @@ std::error_code parseConfiguration(StringRef Text, FormatStyle *Style) {
     return make_error_code(ParseError::Error);
 
   std::vector<FormatStyle> Styles;
-  llvm::yaml::Input Input(Text);
+  llvm::yaml::Input Input(Text, /*Ctxt=*/nullptr, printConfigurationDiagnostic,
+                          &ErrOS);
   // DocumentListTraits<vector<FormatStyle>> uses the context to get default
   // values for the fields, keys for which are missing from the configuration.
   // Mapping also uses the context to get the language to find the correct
@@ -1779,31 +1786,32 @@ static FormatStyle::LanguageKind getLanguageByFileName(StringRef FileName) {
 }
 
 FormatStyle getStyle(StringRef StyleName, StringRef FileName,
-                     StringRef FallbackStyle, vfs::FileSystem *FS) {
+                     StringRef FallbackStyle, vfs::FileSystem *FS,
+                     raw_ostream &ErrOS) {
   if (!FS) {
     FS = vfs::getRealFileSystem().get();
   }
   FormatStyle Style = getLLVMStyle();
   Style.Language = getLanguageByFileName(FileName);
   if (!getPredefinedStyle(FallbackStyle, Style.Language, &Style)) {
-    llvm::errs() << "Invalid fallback style \"" << FallbackStyle
-                 << "\" using LLVM style\n";
+    ErrOS << "Invalid fallback style \"" << FallbackStyle
+          << "\" using LLVM style\n";
     return Style;
   }
 
   if (StyleName.startswith("{")) {
     // Parse YAML/JSON style from the command line.
-    if (std::error_code ec = parseConfiguration(StyleName, &Style)) {
-      llvm::errs() << "Error parsing -style: " << ec.message() << ", using "
-                   << FallbackStyle << " style\n";
+    if (std::error_code ec = parseConfiguration(StyleName, &Style, ErrOS)) {
+      ErrOS << "Error parsing -style: " << ec.message() << ", using "
+            << FallbackStyle << " style\n";
     }
     return Style;
   }
 
   if (!StyleName.equals_lower("file")) {
     if (!getPredefinedStyle(StyleName, Style.Language, &Style))
-      llvm::errs() << "Invalid value for -style, using " << FallbackStyle
-                   << " style\n";
+      ErrOS << "Invalid value for -style, using " << FallbackStyle
+            << " style\n";
     return Style;
   }
 
@@ -1842,19 +1850,19 @@ FormatStyle getStyle(StringRef StyleName, StringRef FileName,
       llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Text =
           FS->getBufferForFile(ConfigFile.str());
       if (std::error_code EC = Text.getError()) {
-        llvm::errs() << EC.message() << "\n";
+        ErrOS << EC.message() << "\n";
         break;
       }
       if (std::error_code ec =
-              parseConfiguration(Text.get()->getBuffer(), &Style)) {
+              parseConfiguration(Text.get()->getBuffer(), &Style, ErrOS)) {
         if (ec == ParseError::Unsuitable) {
           if (!UnsuitableConfigFiles.empty())
             UnsuitableConfigFiles.append(", ");
           UnsuitableConfigFiles.append(ConfigFile);
           continue;
         }
-        llvm::errs() << "Error reading " << ConfigFile << ": " << ec.message()
-                     << "\n";
+        ErrOS << "Error reading " << ConfigFile << ": " << ec.message()
+              << "\n";
         break;
       }
       DEBUG(llvm::dbgs() << "Using configuration file " << ConfigFile << "\n");
@@ -1862,9 +1870,9 @@ FormatStyle getStyle(StringRef StyleName, StringRef FileName,
     }
   }
   if (!UnsuitableConfigFiles.empty()) {
-    llvm::errs() << "Configuration file(s) do(es) not support "
-                 << getLanguageName(Style.Language) << ": "
-                 << UnsuitableConfigFiles << "\n";
+    ErrOS << "Configuration file(s) do(es) not support "
+          << getLanguageName(Style.Language) << ": " << UnsuitableConfigFiles
+          << "\n";
   }
   return Style;
 }
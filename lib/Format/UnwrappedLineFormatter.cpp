@@ -9,6 +9,7 @@
 
 #include "UnwrappedLineFormatter.h"
 #include "WhitespaceManager.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/Support/Debug.h"
 #include <queue>
 
@@ -643,12 +644,27 @@ public:
   }
 
 private:
-  struct CompareLineStatePointers {
-    bool operator()(LineState *obj1, LineState *obj2) const {
-      return *obj1 < *obj2;
+  /// \brief Hashes and compares \c LineStates by the fields that matter for
+  /// the rest of the line, optionally leaving out their stacks.
+  template <bool CompareStack>
+  struct LineStateInfo : llvm::DenseMapInfo<const LineState *> {
+    static unsigned getHashValue(const LineState *State) {
+      return State->getHash(CompareStack);
+    }
+    static bool isEqual(const LineState *LHS, const LineState *RHS) {
+      if (LHS == RHS)
+        return true;
+      if (LHS == getEmptyKey() || LHS == getTombstoneKey() ||
+          RHS == getEmptyKey() || RHS == getTombstoneKey())
+        return false;
+      return LHS->isEquivalentTo(*RHS, CompareStack);
     }
   };
 
+  /// \brief The lowest penalty each state has been queued with.
+  typedef llvm::DenseMap<const LineState *, unsigned, LineStateInfo<true>>
+      QueuedPenaltyMap;
+
   /// \brief A pair of <penalty, count> that is used to prioritize the BFS on.
   ///
   /// In case of equal penalties, we want to prefer states that were inserted
@@ -683,7 +699,9 @@ private:
   ///
   /// If \p DryRun is \c false, directly applies the changes.
   unsigned analyzeSolutionSpace(LineState &InitialState, bool DryRun) {
-    std::set<LineState *, CompareLineStatePointers> Seen;
+    llvm::DenseSet<const LineState *, LineStateInfo<true>> Seen;
+    llvm::DenseSet<const LineState *, LineStateInfo<false>> SeenIgnoringStack;
+    QueuedPenaltyMap QueuedPenalty;
 
     // Increasing count of \c StateNode items we have created. This is used to
     // create a deterministic order independent of the container.
@@ -709,19 +727,37 @@ private:
       Queue.pop();
 
       // Cut off the analysis of certain solutions if the analysis gets too
-      // complex. See description of IgnoreStackForComparison.
-      if (Count > 50000)
-        Node->State.IgnoreStackForComparison = true;
-
-      if (!Seen.insert(&Node->State).second)
+      // complex, by ignoring the stack of \c ParenStates when looking for
+      // states that were already examined.
+      //
+      // In long and deeply nested unwrapped lines, the current algorithm can
+      // be insufficient for finding the best formatting with a reasonable
+      // amount of time and memory. Ignoring the stack will effectively lead
+      // to the algorithm not analyzing some combinations. However, these
+      // combinations rarely contain the optimal solution: In short, accepting
+      // a higher penalty early would need to lead to different values in the
+      // \c ParenState stack (in an otherwise identical state) and these
+      // different values would need to lead to a significant amount of
+      // avoided penalty later.
+      //
+      // FIXME: Come up with a better algorithm instead.
+      bool IgnoreStack = Count > 50000;
+
+      // Remember every examined state both ways, so that the cut-off also
+      // catches the states examined before it.
+      bool NewState = Seen.insert(&Node->State).second;
+      bool NewIgnoringStack = SeenIgnoringStack.insert(&Node->State).second;
+      if (IgnoreStack ? !NewIgnoringStack : !NewState)
         // State already examined with lower penalty.
         continue;
 
       FormatDecision LastFormat = Node->State.NextToken->Decision;
       if (LastFormat == FD_Unformatted || LastFormat == FD_Continue)
-        addNextStateToQueue(Penalty, Node, /*NewLine=*/false, &Count, &Queue);
+        addNextStateToQueue(Penalty, Node, /*NewLine=*/false, &Count, &Queue,
+                            &QueuedPenalty);
       if (LastFormat == FD_Unformatted || LastFormat == FD_Break)
-        addNextStateToQueue(Penalty, Node, /*NewLine=*/true, &Count, &Queue);
+        addNextStateToQueue(Penalty, Node, /*NewLine=*/true, &Count, &Queue,
+                            &QueuedPenalty);
     }
 
     if (Queue.empty()) {
@@ -746,7 +782,8 @@ private:
   /// Assume the current state is \p PreviousNode and has been reached with a
   /// penalty of \p Penalty. Insert a line break if \p NewLine is \c true.
   void addNextStateToQueue(unsigned Penalty, StateNode *PreviousNode,
-                           bool NewLine, unsigned *Count, QueueType *Queue) {
+                           bool NewLine, unsigned *Count, QueueType *Queue,
+                           QueuedPenaltyMap *QueuedPenalty) {
     if (NewLine && !Indenter->canBreak(PreviousNode->State))
       return;
     if (!NewLine && Indenter->mustBreak(PreviousNode->State))
@@ -759,6 +796,18 @@ private:
 
     Penalty += Indenter->addTokenToState(Node->State, NewLine, true);
 
+    // An equivalent state that was queued earlier with at most this penalty
+    // is dequeued first, so this one would only be dropped as already seen.
+    // It still counts towards the cut-off, which stays where it was.
+    auto Queued = QueuedPenalty->insert(std::make_pair(&Node->State, Penalty));
+    if (!Queued.second) {
+      if (Queued.first->second <= Penalty) {
+        ++(*Count);
+        return;
+      }
+      Queued.first->second = Penalty;
+    }
+
     Queue->push(QueueItem(OrderedPenalty(Penalty, *Count), Node));
     ++(*Count);
   }
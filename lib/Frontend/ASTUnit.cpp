@@ -37,10 +37,14 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <atomic>
@@ -858,6 +862,7 @@ public:
 
   // We're not interested in "interesting" decls.
   void HandleInterestingDecl(DeclGroupRef) override {}
+  bool needsInterestingDecls() override { return false; }
 
   void HandleTopLevelDeclInObjCContainer(DeclGroupRef D) override {
     for (Decl *TopLevelDecl : D)
@@ -1316,6 +1321,385 @@ makeStandaloneDiagnostic(const LangOptions &LangOpts,
   return OutDiag;
 }
 
+//===----------------------------------------------------------------------===//
+// Preamble cache
+//===----------------------------------------------------------------------===//
+
+/// \brief Identifies preamble cache entries written by this version of the
+/// entry format.
+static const uint32_t PreambleCacheMagic = 0x50524531; // 'PRE1'
+
+static void hashPreambleKeyString(llvm::MD5 &Hash, StringRef Str) {
+  // Include the length so that adjacent strings can't run into each other.
+  uint32_t Size = Str.size();
+  Hash.update(ArrayRef<uint8_t>((const uint8_t *)&Size, sizeof(Size)));
+  Hash.update(Str);
+}
+
+std::string
+ASTUnit::getPreambleCacheKey(const CompilerInvocation &PreambleInvocation,
+                             const ComputedPreamble &NewPreamble) {
+  const FrontendOptions &FrontendOpts = PreambleInvocation.getFrontendOpts();
+  const PreprocessorOptions &PPOpts = PreambleInvocation.getPreprocessorOpts();
+  const HeaderSearchOptions &HSOpts = PreambleInvocation.getHeaderSearchOpts();
+  const DiagnosticOptions &DiagOpts = PreambleInvocation.getDiagnosticOpts();
+
+  llvm::MD5 Hash;
+  // The module hash covers the compiler version and the language, target
+  // and macro configuration.
+  hashPreambleKeyString(Hash, PreambleInvocation.getModuleHash());
+  hashPreambleKeyString(Hash, FrontendOpts.Inputs[0].getFile());
+  hashPreambleKeyString(
+      Hash, NewPreamble.Buffer->getBuffer().slice(0, NewPreamble.Size));
+  hashPreambleKeyString(Hash,
+                        NewPreamble.PreambleEndsAtStartOfLine ? "1" : "0");
+  hashPreambleKeyString(Hash,
+                        PreambleInvocation.getFileSystemOpts().WorkingDir);
+
+  for (const auto &Macro : PPOpts.Macros) {
+    hashPreambleKeyString(Hash, Macro.first);
+    hashPreambleKeyString(Hash, Macro.second ? "U" : "D");
+  }
+  for (const std::string &Include : PPOpts.Includes)
+    hashPreambleKeyString(Hash, Include);
+  for (const std::string &Include : PPOpts.MacroIncludes)
+    hashPreambleKeyString(Hash, Include);
+  hashPreambleKeyString(Hash, PPOpts.ImplicitPCHInclude);
+  hashPreambleKeyString(Hash, PPOpts.ImplicitPTHInclude);
+
+  for (const HeaderSearchOptions::Entry &E : HSOpts.UserEntries) {
+    hashPreambleKeyString(Hash, E.Path);
+    hashPreambleKeyString(Hash, llvm::utostr(E.Group * 4 + E.IsFramework * 2 +
+                                             E.IgnoreSysRoot));
+  }
+  for (const HeaderSearchOptions::SystemHeaderPrefix &P :
+       HSOpts.SystemHeaderPrefixes) {
+    hashPreambleKeyString(Hash, P.Prefix);
+    hashPreambleKeyString(Hash, P.IsSystemHeader ? "S" : "U");
+  }
+  hashPreambleKeyString(Hash, HSOpts.ModuleCachePath);
+
+  // The warning flags determine which diagnostics the preamble produces.
+  for (const std::string &Warning : DiagOpts.Warnings)
+    hashPreambleKeyString(Hash, Warning);
+  for (const std::string &Remark : DiagOpts.Remarks)
+    hashPreambleKeyString(Hash, Remark);
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Key;
+  llvm::MD5::stringifyResult(Result, Key);
+  return Key.str();
+}
+
+namespace {
+/// \brief Reads the fields of a preamble cache entry, failing softly if the
+/// entry is truncated or corrupt.
+class PreambleCacheEntryReader {
+  const char *Ptr;
+  const char *End;
+  bool Failed;
+
+public:
+  explicit PreambleCacheEntryReader(StringRef Data)
+      : Ptr(Data.begin()), End(Data.end()), Failed(false) {}
+
+  bool hasFailed() const { return Failed; }
+
+  StringRef readBytes(uint64_t Size) {
+    if (Failed || Size > uint64_t(End - Ptr)) {
+      Failed = true;
+      return StringRef();
+    }
+    StringRef Result(Ptr, Size);
+    Ptr += Size;
+    return Result;
+  }
+
+  uint32_t readU32() {
+    StringRef Bytes = readBytes(sizeof(uint32_t));
+    if (Failed)
+      return 0;
+    return llvm::support::endian::read32le(Bytes.data());
+  }
+
+  uint64_t readU64() {
+    StringRef Bytes = readBytes(sizeof(uint64_t));
+    if (Failed)
+      return 0;
+    return llvm::support::endian::read64le(Bytes.data());
+  }
+
+  StringRef readString() { return readBytes(readU32()); }
+
+  std::pair<unsigned, unsigned> readRange() {
+    unsigned Begin = readU32();
+    unsigned End = readU32();
+    return std::make_pair(Begin, End);
+  }
+};
+} // end anonymous namespace
+
+/// \brief Retrieve the path of the cache entry describing the preamble with
+/// the given key.
+static std::string getPreambleCacheEntryPath(StringRef CachePath,
+                                             StringRef Key) {
+  SmallString<128> Path(CachePath);
+  llvm::sys::path::append(Path, Key + ".preamble");
+  return Path.str();
+}
+
+/// \brief Retrieve the path of the precompiled preamble that the given cache
+/// entry refers to, or an empty string if there is no such entry.
+static std::string getCachedPreamblePCHPath(StringRef CachePath,
+                                            StringRef EntryData) {
+  PreambleCacheEntryReader Reader(EntryData);
+  if (Reader.readU32() != PreambleCacheMagic)
+    return std::string();
+  StringRef PCHName = Reader.readString();
+  if (Reader.hasFailed() || PCHName.empty())
+    return std::string();
+  SmallString<128> Path(CachePath);
+  llvm::sys::path::append(Path, PCHName);
+  return Path.str();
+}
+
+/// \brief Copy the file \p From to \p To.
+///
+/// \returns true if an error occurred, false otherwise.
+static bool copyPreambleFile(StringRef From, StringRef To) {
+  auto Buffer = llvm::MemoryBuffer::getFile(From, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return true;
+
+  std::error_code EC;
+  llvm::raw_fd_ostream Out(To, EC, llvm::sys::fs::F_None);
+  if (EC)
+    return true;
+  Out << (*Buffer)->getBuffer();
+  Out.close();
+  if (Out.has_error()) {
+    Out.clear_error();
+    return true;
+  }
+  return false;
+}
+
+bool ASTUnit::loadPreambleFromCache(
+    StringRef Key, const CompilerInvocation &PreambleInvocation,
+    const ComputedPreamble &NewPreamble) {
+  auto Entry = llvm::MemoryBuffer::getFile(
+      getPreambleCacheEntryPath(PreambleCachePath, Key), /*FileSize=*/-1,
+      /*RequiresNullTerminator=*/false);
+  if (!Entry)
+    return false;
+
+  StringRef EntryData = (*Entry)->getBuffer();
+  std::string CachedPCHPath =
+      getCachedPreamblePCHPath(PreambleCachePath, EntryData);
+  if (CachedPCHPath.empty())
+    return false;
+
+  PreambleCacheEntryReader Reader(EntryData);
+  Reader.readU32();
+  Reader.readString();
+
+  // Guard against hash collisions by comparing the preamble itself.
+  StringRef PreambleText = Reader.readBytes(Reader.readU32());
+  bool EndsAtStartOfLine = Reader.readU32();
+  if (Reader.hasFailed() ||
+      PreambleText !=
+          NewPreamble.Buffer->getBuffer().slice(0, NewPreamble.Size) ||
+      EndsAtStartOfLine != NewPreamble.PreambleEndsAtStartOfLine)
+    return false;
+
+  unsigned NumWarnings = Reader.readU32();
+  unsigned TopLevelHashValue = Reader.readU32();
+
+  llvm::StringMap<PreambleFileHash> Files;
+  for (unsigned I = 0, N = Reader.readU32(); I != N && !Reader.hasFailed();
+       ++I) {
+    StringRef Name = Reader.readString();
+    PreambleFileHash &Hash = Files[Name];
+    Hash.Size = Reader.readU64();
+    Hash.ModTime = Reader.readU64();
+    StringRef MD5 = Reader.readBytes(sizeof(Hash.MD5));
+    if (!Reader.hasFailed())
+      memcpy(Hash.MD5, MD5.data(), sizeof(Hash.MD5));
+  }
+
+  std::vector<serialization::DeclID> TopLevelDecls;
+  for (unsigned I = 0, N = Reader.readU32(); I != N && !Reader.hasFailed();
+       ++I)
+    TopLevelDecls.push_back(Reader.readU32());
+
+  SmallVector<StandaloneDiagnostic, 4> Diags;
+  for (unsigned I = 0, N = Reader.readU32(); I != N && !Reader.hasFailed();
+       ++I) {
+    StandaloneDiagnostic Diag;
+    Diag.ID = Reader.readU32();
+    Diag.Level = static_cast<DiagnosticsEngine::Level>(Reader.readU32());
+    Diag.Message = Reader.readString();
+    Diag.Filename = Reader.readString();
+    Diag.LocOffset = Reader.readU32();
+    for (unsigned R = 0, NR = Reader.readU32();
+         R != NR && !Reader.hasFailed(); ++R)
+      Diag.Ranges.push_back(Reader.readRange());
+    for (unsigned F = 0, NF = Reader.readU32();
+         F != NF && !Reader.hasFailed(); ++F) {
+      StandaloneFixIt FixIt;
+      FixIt.RemoveRange = Reader.readRange();
+      FixIt.InsertFromRange = Reader.readRange();
+      FixIt.CodeToInsert = Reader.readString();
+      FixIt.BeforePreviousInsertions = Reader.readU32();
+      Diag.FixIts.push_back(std::move(FixIt));
+    }
+    Diags.push_back(std::move(Diag));
+  }
+  if (Reader.hasFailed())
+    return false;
+
+  // Work from a private copy of the precompiled preamble, so that the cache
+  // entry can be replaced or removed while this ASTUnit still uses it.
+  std::string PreamblePCHPath = GetPreamblePCHPath();
+  if (PreamblePCHPath.empty())
+    return false;
+  if (copyPreambleFile(CachedPCHPath, PreamblePCHPath)) {
+    llvm::sys::fs::remove(PreamblePCHPath);
+    return false;
+  }
+
+  StringRef MainFilename =
+      PreambleInvocation.getFrontendOpts().Inputs[0].getFile();
+  Preamble.assign(FileMgr->getFile(MainFilename), PreambleText.begin(),
+                  PreambleText.end());
+  PreambleEndsAtStartOfLine = EndsAtStartOfLine;
+  setPreambleFile(this, PreamblePCHPath);
+  OriginalSourceFile = MainFilename;
+  NumWarningsInPreamble = NumWarnings;
+  FilesInPreamble = std::move(Files);
+  TopLevelDeclsInPreamble = std::move(TopLevelDecls);
+  PreambleDiagnostics = std::move(Diags);
+
+  CurrentTopLevelHashValue = TopLevelHashValue;
+  if (CurrentTopLevelHashValue != PreambleTopLevelHashValue) {
+    CompletionCacheTopLevelHashValue = 0;
+    PreambleTopLevelHashValue = CurrentTopLevelHashValue;
+  }
+  return true;
+}
+
+void ASTUnit::storePreambleInCache(StringRef Key) {
+  if (llvm::sys::fs::create_directories(PreambleCachePath))
+    return;
+
+  // Copy the precompiled preamble into the cache under a unique name; the
+  // entry written below is what makes it visible to other processes.
+  SmallString<128> CachedPCHModel(PreambleCachePath);
+  llvm::sys::path::append(CachedPCHModel, Key + "-%%%%%%%%.pch");
+  SmallString<128> CachedPCHPath;
+  if (llvm::sys::fs::createUniqueFile(CachedPCHModel, CachedPCHPath))
+    return;
+  if (copyPreambleFile(getPreambleFile(this), CachedPCHPath)) {
+    llvm::sys::fs::remove(CachedPCHPath);
+    return;
+  }
+
+  SmallString<1024> EntryData;
+  {
+    using namespace llvm::support;
+    llvm::raw_svector_ostream Out(EntryData);
+    endian::Writer<little> LE(Out);
+    auto WriteString = [&](StringRef Str) {
+      LE.write<uint32_t>(Str.size());
+      Out << Str;
+    };
+    auto WriteRange = [&](const std::pair<unsigned, unsigned> &Range) {
+      LE.write<uint32_t>(Range.first);
+      LE.write<uint32_t>(Range.second);
+    };
+
+    LE.write<uint32_t>(PreambleCacheMagic);
+    WriteString(llvm::sys::path::filename(CachedPCHPath));
+    WriteString(StringRef(Preamble.getBufferStart(), Preamble.size()));
+    LE.write<uint32_t>(PreambleEndsAtStartOfLine);
+    LE.write<uint32_t>(NumWarningsInPreamble);
+    LE.write<uint32_t>(CurrentTopLevelHashValue);
+
+    LE.write<uint32_t>(FilesInPreamble.size());
+    for (const auto &F : FilesInPreamble) {
+      WriteString(F.first());
+      LE.write<uint64_t>(F.second.Size);
+      LE.write<uint64_t>(F.second.ModTime);
+      Out.write((const char *)F.second.MD5, sizeof(F.second.MD5));
+    }
+
+    LE.write<uint32_t>(TopLevelDeclsInPreamble.size());
+    for (serialization::DeclID D : TopLevelDeclsInPreamble)
+      LE.write<uint32_t>(D);
+
+    LE.write<uint32_t>(PreambleDiagnostics.size());
+    for (const StandaloneDiagnostic &Diag : PreambleDiagnostics) {
+      LE.write<uint32_t>(Diag.ID);
+      LE.write<uint32_t>(Diag.Level);
+      WriteString(Diag.Message);
+      WriteString(Diag.Filename);
+      LE.write<uint32_t>(Diag.LocOffset);
+      LE.write<uint32_t>(Diag.Ranges.size());
+      for (const auto &Range : Diag.Ranges)
+        WriteRange(Range);
+      LE.write<uint32_t>(Diag.FixIts.size());
+      for (const StandaloneFixIt &FixIt : Diag.FixIts) {
+        WriteRange(FixIt.RemoveRange);
+        WriteRange(FixIt.InsertFromRange);
+        WriteString(FixIt.CodeToInsert);
+        LE.write<uint32_t>(FixIt.BeforePreviousInsertions);
+      }
+    }
+  }
+
+  // Publish the entry by renaming it into place, so that readers never see
+  // a partially-written entry.
+  std::string EntryPath = getPreambleCacheEntryPath(PreambleCachePath, Key);
+  SmallString<128> EntryTmpPath;
+  int EntryFD;
+  if (llvm::sys::fs::createUniqueFile(EntryPath + "-%%%%%%%%", EntryFD,
+                                      EntryTmpPath)) {
+    llvm::sys::fs::remove(CachedPCHPath);
+    return;
+  }
+  {
+    llvm::raw_fd_ostream Out(EntryFD, /*shouldClose=*/true);
+    Out << EntryData;
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      llvm::sys::fs::remove(EntryTmpPath);
+      llvm::sys::fs::remove(CachedPCHPath);
+      return;
+    }
+  }
+
+  // Remember the precompiled preamble of the entry we're replacing, if any.
+  std::string OldPCHPath;
+  if (auto OldEntry = llvm::MemoryBuffer::getFile(
+          EntryPath, /*FileSize=*/-1, /*RequiresNullTerminator=*/false))
+    OldPCHPath = getCachedPreamblePCHPath(PreambleCachePath,
+                                          (*OldEntry)->getBuffer());
+
+  if (llvm::sys::fs::rename(EntryTmpPath, EntryPath)) {
+    llvm::sys::fs::remove(EntryTmpPath);
+    llvm::sys::fs::remove(CachedPCHPath);
+    return;
+  }
+
+  // Readers copy the precompiled preamble before using it, so the one that
+  // was just replaced can go away.
+  if (!OldPCHPath.empty() && OldPCHPath != CachedPCHPath)
+    llvm::sys::fs::remove(OldPCHPath);
+}
+
 /// \brief Attempt to build or re-use a precompiled preamble when (re-)parsing
 /// the source file.
 ///
@@ -1360,7 +1744,20 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     PreambleRebuildCounter = 1;
     return nullptr;
   }
-  
+
+  // If we don't have a preamble yet, another process may already have
+  // precompiled this one. It is validated below like one of our own.
+  std::string PreambleCacheKey;
+  if (!PreambleCachePath.empty()) {
+    PreambleCacheKey = getPreambleCacheKey(*PreambleInvocation, NewPreamble);
+    if (Preamble.empty()) {
+      SimpleTimer LoadTimer(WantTiming);
+      LoadTimer.setOutput("Loading preamble from cache");
+      loadPreambleFromCache(PreambleCacheKey, *PreambleInvocation,
+                            NewPreamble);
+    }
+  }
+
   if (!Preamble.empty()) {
     // We've previously computed a preamble. Check whether we have the same
     // preamble now that we did before, and that there's enough space in
@@ -1642,6 +2039,10 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     PreambleTopLevelHashValue = CurrentTopLevelHashValue;
   }
 
+  // Share the new preamble with other processes.
+  if (!PreambleCacheKey.empty())
+    storePreambleInCache(PreambleCacheKey);
+
   return llvm::MemoryBuffer::getMemBufferCopy(NewPreamble.Buffer->getBuffer(),
                                               MainFilename);
 }
@@ -1945,7 +2346,8 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
     bool CacheCodeCompletionResults, bool IncludeBriefCommentsInCodeCompletion,
     bool AllowPCHWithCompilerErrors, bool SkipFunctionBodies,
     bool UserFilesAreVolatile, bool ForSerialization,
-    llvm::Optional<StringRef> ModuleFormat, std::unique_ptr<ASTUnit> *ErrAST) {
+    llvm::Optional<StringRef> ModuleFormat, std::unique_ptr<ASTUnit> *ErrAST,
+    StringRef PreambleCachePath) {
   assert(Diags.get() && "no DiagnosticsEngine was provided");
 
   SmallVector<StoredDiagnostic, 4> StoredDiagnostics;
@@ -1999,6 +2401,7 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
   AST->IncludeBriefCommentsInCodeCompletion
     = IncludeBriefCommentsInCodeCompletion;
   AST->UserFilesAreVolatile = UserFilesAreVolatile;
+  AST->PreambleCachePath = PreambleCachePath;
   AST->NumStoredDiagnosticsFromDriver = StoredDiagnostics.size();
   AST->StoredDiagnostics.swap(StoredDiagnostics);
   AST->Invocation = CI;
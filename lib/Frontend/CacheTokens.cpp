@@ -14,7 +14,6 @@
 
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/FileManager.h"
-#include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Frontend/Utils.h"
@@ -27,12 +26,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/OnDiskHashTable.h"
-#include "llvm/Support/Path.h"
-
-// FIXME: put this somewhere else?
-#ifndef S_ISDIR
-#define S_ISDIR(x) (((x)&_S_IFDIR)!=0)
-#endif
+#include <set>
 
 using namespace clang;
 
@@ -57,110 +51,46 @@ public:
 };
 
 
-class PTHEntryKeyVariant {
-  union { const FileEntry* FE; const char* Path; };
-  enum { IsFE = 0x1, IsDE = 0x2, IsNoExist = 0x0 } Kind;
-  FileData *Data;
-
-public:
-  PTHEntryKeyVariant(const FileEntry *fe) : FE(fe), Kind(IsFE), Data(nullptr) {}
-
-  PTHEntryKeyVariant(FileData *Data, const char *path)
-      : Path(path), Kind(IsDE), Data(new FileData(*Data)) {}
-
-  explicit PTHEntryKeyVariant(const char *path)
-      : Path(path), Kind(IsNoExist), Data(nullptr) {}
-
-  bool isFile() const { return Kind == IsFE; }
-
-  StringRef getString() const {
-    return Kind == IsFE ? FE->getName() : Path;
-  }
-
-  unsigned getKind() const { return (unsigned) Kind; }
-
-  void EmitData(raw_ostream& Out) {
-    using namespace llvm::support;
-    endian::Writer<little> LE(Out);
-    switch (Kind) {
-    case IsFE: {
-      // Emit stat information.
-      llvm::sys::fs::UniqueID UID = FE->getUniqueID();
-      LE.write<uint64_t>(UID.getFile());
-      LE.write<uint64_t>(UID.getDevice());
-      LE.write<uint64_t>(FE->getModificationTime());
-      LE.write<uint64_t>(FE->getSize());
-    } break;
-    case IsDE:
-      // Emit stat information.
-      LE.write<uint64_t>(Data->UniqueID.getFile());
-      LE.write<uint64_t>(Data->UniqueID.getDevice());
-      LE.write<uint64_t>(Data->ModTime);
-      LE.write<uint64_t>(Data->Size);
-      delete Data;
-      break;
-    default:
-      break;
-    }
-  }
-
-  unsigned getRepresentationLength() const {
-    return Kind == IsNoExist ? 0 : 4 * 8;
-  }
-};
-
-class FileEntryPTHEntryInfo {
+/// The file table maps the digest and size of each file's contents to its
+/// token data.
+class PTHFileTableTrait {
 public:
-  typedef PTHEntryKeyVariant key_type;
-  typedef key_type key_type_ref;
+  typedef PTHManager::FileKey key_type;
+  typedef const key_type& key_type_ref;
 
   typedef PTHEntry data_type;
   typedef const PTHEntry& data_type_ref;
 
-  typedef unsigned hash_value_type;
+  typedef uint32_t hash_value_type;
   typedef unsigned offset_type;
 
-  static hash_value_type ComputeHash(PTHEntryKeyVariant V) {
-    return llvm::HashString(V.getString());
+  static hash_value_type ComputeHash(key_type_ref Key) {
+    return (hash_value_type)Key.DigestLo;
   }
 
   static std::pair<unsigned,unsigned>
-  EmitKeyDataLength(raw_ostream& Out, PTHEntryKeyVariant V,
-                    const PTHEntry& E) {
-    using namespace llvm::support;
-    endian::Writer<little> LE(Out);
-
-    unsigned n = V.getString().size() + 1 + 1;
-    LE.write<uint16_t>(n);
-
-    unsigned m = V.getRepresentationLength() + (V.isFile() ? 4 + 4 : 0);
-    LE.write<uint8_t>(m);
-
-    return std::make_pair(n, m);
+  EmitKeyDataLength(raw_ostream& Out, key_type_ref, const PTHEntry&) {
+    // Keys and data have a fixed size, so their lengths aren't stored.
+    return std::make_pair(8 + 8 + 8, 4 + 4);
   }
 
-  static void EmitKey(raw_ostream& Out, PTHEntryKeyVariant V, unsigned n){
+  static void EmitKey(raw_ostream& Out, key_type_ref Key, unsigned) {
     using namespace llvm::support;
-    // Emit the entry kind.
-    endian::Writer<little>(Out).write<uint8_t>((unsigned)V.getKind());
-    // Emit the string.
-    Out.write(V.getString().data(), n - 1);
+    endian::Writer<little> LE(Out);
+    LE.write<uint64_t>(Key.DigestLo);
+    LE.write<uint64_t>(Key.DigestHi);
+    LE.write<uint64_t>(Key.Size);
   }
 
-  static void EmitData(raw_ostream& Out, PTHEntryKeyVariant V,
-                       const PTHEntry& E, unsigned) {
+  static void EmitData(raw_ostream& Out, key_type_ref, const PTHEntry& E,
+                       unsigned) {
     using namespace llvm::support;
     endian::Writer<little> LE(Out);
 
-    // For file entries emit the offsets into the PTH file for token data
-    // and the preprocessor blocks table.
-    if (V.isFile()) {
-      LE.write<uint32_t>(E.getTokenOffset());
-      LE.write<uint32_t>(E.getPPCondTableOffset());
-    }
-
-    // Emit any other data associated with the key (i.e., stat information).
-    V.EmitData(Out);
+    // Emit the offsets into the PTH file for token data and the
+    // preprocessor blocks table.
+    LE.write<uint32_t>(E.getTokenOffset());
+    LE.write<uint32_t>(E.getPPCondTableOffset());
   }
 };
 
@@ -175,7 +105,7 @@ public:
 };
 } // end anonymous namespace
 
-typedef llvm::OnDiskChainedHashTableGenerator<FileEntryPTHEntryInfo> PTHMap;
+typedef llvm::OnDiskChainedHashTableGenerator<PTHFileTableTrait> PTHMap;
 
 namespace {
 class PTHWriter {
@@ -228,8 +158,8 @@ class PTHWriter {
   ///  (the keys of the first table).
   std::pair<Offset, Offset> EmitIdentifierTable();
 
-  /// EmitFileTable - Emit a table mapping from file name strings to PTH
-  /// token data.
+  /// EmitFileTable - Emit a table mapping from the hashes of file contents
+  /// to PTH token data.
   Offset EmitFileTable() { return PM.Emit(Out); }
 
   PTHEntry LexTokens(Lexer& L);
@@ -239,7 +169,6 @@ public:
   PTHWriter(raw_pwrite_stream &out, Preprocessor &pp)
       : Out(out), PP(pp), idcount(0), CurStrOffset(0) {}
 
-  PTHMap &getPM() { return PM; }
   void GeneratePTH(StringRef MainFile);
 };
 } // end anonymous namespace
@@ -483,6 +412,11 @@ void PTHWriter::GeneratePTH(StringRef MainFile) {
   Out << "cfe-pth" << '\0';
   Emit32(PTHManager::Version);
 
+  // Record the language options the tokens are lexed with.
+  using namespace llvm::support;
+  endian::Writer<little>(Out).write<uint64_t>(
+      PTHManager::getLangOptsHash(PP.getLangOpts()));
+
   // Leave 4 words for the prologue.
   Offset PrologueOffset = Out.tell();
   for (unsigned i = 0; i < 4; ++i)
@@ -501,23 +435,25 @@ void PTHWriter::GeneratePTH(StringRef MainFile) {
   // for each file and cache the tokens.
   SourceManager &SM = PP.getSourceManager();
   const LangOptions &LOpts = PP.getLangOpts();
+  std::set<PTHManager::FileKey> CachedContents;
 
   for (SourceManager::fileinfo_iterator I = SM.fileinfo_begin(),
        E = SM.fileinfo_end(); I != E; ++I) {
     const SrcMgr::ContentCache &C = *I->second;
     const FileEntry *FE = C.OrigEntry;
 
-    // FIXME: Handle files with non-absolute paths.
-    if (llvm::sys::path::is_relative(FE->getName()))
-      continue;
-
     const llvm::MemoryBuffer *B = C.getBuffer(PP.getDiagnostics(), SM);
     if (!B) continue;
 
+    // Files with the same contents share their tokens.
+    PTHManager::FileKey Key = PTHManager::getFileKey(B->getBuffer());
+    if (!CachedContents.insert(Key).second)
+      continue;
+
     FileID FID = SM.createFileID(FE, SourceLocation(), SrcMgr::C_User);
     const llvm::MemoryBuffer *FromFile = SM.getBuffer(FID);
     Lexer L(FID, FromFile, SM, LOpts);
-    PM.insert(FE, LexTokens(L));
+    PM.insert(Key, LexTokens(L));
   }
 
   // Write out the identifier table.
@@ -537,38 +473,6 @@ void PTHWriter::GeneratePTH(StringRef MainFile) {
   pwrite32le(Out, SpellingOff, Off);
 }
 
-namespace {
-/// StatListener - A simple "interpose" object used to monitor stat calls
-/// invoked by FileManager while processing the original sources used
-/// as input to PTH generation.  StatListener populates the PTHWriter's
-/// file map with stat information for directories as well as negative stats.
-/// Stat information for files are populated elsewhere.
-class StatListener : public FileSystemStatCache {
-  PTHMap &PM;
-public:
-  StatListener(PTHMap &pm) : PM(pm) {}
-  ~StatListener() override {}
-
-  LookupResult getStat(const char *Path, FileData &Data, bool isFile,
-                       std::unique_ptr<vfs::File> *F,
-                       vfs::FileSystem &FS) override {
-    LookupResult Result = statChained(Path, Data, isFile, F, FS);
-
-    if (Result == CacheMissing) // Failed 'stat'.
-      PM.insert(PTHEntryKeyVariant(Path), PTHEntry());
-    else if (Data.IsDirectory) {
-      // Only cache directories with absolute paths.
-      if (llvm::sys::path::is_relative(Path))
-        return Result;
-
-      PM.insert(PTHEntryKeyVariant(&Data, Path), PTHEntry());
-    }
-
-    return Result;
-  }
-};
-} // end anonymous namespace
-
 void clang::CacheTokens(Preprocessor &PP, raw_pwrite_stream *OS) {
   // Get the name of the main file.
   const SourceManager &SrcMgr = PP.getSourceManager();
@@ -580,12 +484,6 @@ void clang::CacheTokens(Preprocessor &PP, raw_pwrite_stream *OS) {
   // Create the PTHWriter.
   PTHWriter PW(*OS, PP);
 
-  // Install the 'stat' system call listener in the FileManager.
-  auto StatCacheOwner = llvm::make_unique<StatListener>(PW.getPM());
-  StatListener *StatCache = StatCacheOwner.get();
-  PP.getFileManager().addStatCache(std::move(StatCacheOwner),
-                                   /*AtBeginning=*/true);
-
   // Lex through the entire file.  This will populate SourceManager with
   // all of the header information.
   Token Tok;
@@ -593,7 +491,6 @@ void clang::CacheTokens(Preprocessor &PP, raw_pwrite_stream *OS) {
   do { PP.Lex(Tok); } while (Tok.isNot(tok::eof));
 
   // Generate the PTH file.
-  PP.getFileManager().removeStatCache(StatCache);
   PW.GeneratePTH(MainFilePath.str());
 }
 
@@ -11,6 +11,7 @@
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/DeclGroup.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
@@ -451,6 +452,8 @@ bool FrontendAction::BeginSourceFile(CompilerInstance &CI,
 bool FrontendAction::Execute() {
   CompilerInstance &CI = getCompilerInstance();
 
+  TimeTraceScope TimeScope("ExecuteAction", getCurrentFile());
+
   if (CI.hasFrontendTimer()) {
     llvm::TimeRegion Timer(CI.getFrontendTimer());
     ExecuteAction();
@@ -468,6 +471,10 @@ bool FrontendAction::Execute() {
                                     CI.getPCHContainerReader(), Cache);
   }
 
+  // Share the include guards we found with later compilations.
+  if (CI.hasPreprocessor())
+    CI.getPreprocessor().getHeaderSearchInfo().writeIncludeGuardDatabase();
+
   return true;
 }
 
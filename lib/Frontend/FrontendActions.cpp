@@ -13,8 +13,10 @@
 #include "clang/Frontend/ASTConsumers.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Frontend/MinimizedSourceFileSystem.h"
 #include "clang/Frontend/MultiplexConsumer.h"
 #include "clang/Frontend/Utils.h"
+#include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PreprocessorOptions.h"
@@ -95,7 +97,8 @@ GeneratePCHAction::CreateASTConsumer(CompilerInstance &CI, StringRef InFile) {
                         Buffer, CI.getFrontendOpts().ModuleFileExtensions,
                         /*AllowASTWithErrors*/false,
                         /*IncludeTimestamps*/
-                          +CI.getFrontendOpts().IncludeTimestamps));
+                          +CI.getFrontendOpts().IncludeTimestamps,
+                        CI.getFrontendOpts().ASTCompressionThreads));
   Consumers.push_back(CI.getPCHContainerWriter().CreatePCHContainerGenerator(
       CI, InFile, OutputFile, std::move(OS), Buffer));
 
@@ -145,7 +148,8 @@ GenerateModuleAction::CreateASTConsumer(CompilerInstance &CI,
                         Buffer, CI.getFrontendOpts().ModuleFileExtensions,
                         /*AllowASTWithErrors=*/false,
                         /*IncludeTimestamps=*/
-                          +CI.getFrontendOpts().BuildingImplicitModule));
+                          +CI.getFrontendOpts().BuildingImplicitModule,
+                        CI.getFrontendOpts().ASTCompressionThreads));
   Consumers.push_back(CI.getPCHContainerWriter().CreatePCHContainerGenerator(
       CI, InFile, OutputFile, std::move(OS), Buffer));
   return llvm::make_unique<MultiplexConsumer>(std::move(Consumers));
@@ -432,9 +436,17 @@ GenerateModuleInterfaceAction::CreateOutputFile(CompilerInstance &CI,
 SyntaxOnlyAction::~SyntaxOnlyAction() {
 }
 
+namespace {
+/// \brief The consumer for -fsyntax-only, which never generates code.
+class SyntaxOnlyConsumer : public ASTConsumer {
+public:
+  bool needsInterestingDecls() override { return false; }
+};
+} // end anonymous namespace
+
 std::unique_ptr<ASTConsumer>
 SyntaxOnlyAction::CreateASTConsumer(CompilerInstance &CI, StringRef InFile) {
-  return llvm::make_unique<ASTConsumer>();
+  return llvm::make_unique<SyntaxOnlyConsumer>();
 }
 
 std::unique_ptr<ASTConsumer>
@@ -710,6 +722,46 @@ void PreprocessOnlyAction::ExecuteAction() {
   } while (Tok.isNot(tok::eof));
 }
 
+ScanDependencyDirectivesAction::ScanDependencyDirectivesAction(
+    std::shared_ptr<MinimizedSourceCache> Cache)
+    : Cache(std::move(Cache)) {}
+
+bool ScanDependencyDirectivesAction::BeginInvocation(CompilerInstance &CI) {
+  // Sources are read through the file manager's file system, so this only
+  // works if the file manager doesn't exist yet.
+  if (CI.hasFileManager())
+    return true;
+
+  // Modules imported while scanning would be built from minimized headers.
+  // Module dependencies aren't scanned, so preprocess the real sources.
+  if (CI.getLangOpts().Modules)
+    return true;
+
+  IntrusiveRefCntPtr<vfs::FileSystem> FS;
+  if (CI.hasVirtualFileSystem())
+    FS = &CI.getVirtualFileSystem();
+  else
+    FS = createVFSFromCompilerInvocation(CI.getInvocation(),
+                                         CI.getDiagnostics());
+  if (!FS)
+    return false;
+
+  if (!Cache)
+    Cache = std::make_shared<MinimizedSourceCache>();
+  CI.setVirtualFileSystem(new MinimizedSourceFileSystem(FS, Cache));
+  return true;
+}
+
+void PrintDependencyDirectivesSourceMinimizerAction::ExecuteAction() {
+  CompilerInstance &CI = getCompilerInstance();
+  SourceManager &SM = CI.getSourceManager();
+  const llvm::MemoryBuffer *Buffer = SM.getBuffer(SM.getMainFileID());
+
+  SmallString<1024> Output;
+  minimizeSourceToDependencyDirectives(Buffer->getBuffer(), Output);
+  llvm::outs() << Output;
+}
+
 void PrintPreprocessedAction::ExecuteAction() {
   CompilerInstance &CI = getCompilerInstance();
   // Output file may need to be set to 'Binary', to avoid converting Unix style
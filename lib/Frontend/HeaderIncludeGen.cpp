@@ -11,7 +11,9 @@
 #include "clang/Frontend/Utils.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/raw_ostream.h"
 using namespace clang;
@@ -19,6 +21,7 @@ using namespace clang;
 namespace {
 class HeaderIncludesCallback : public PPCallbacks {
   SourceManager &SM;
+  HeaderSearch &HS;
   raw_ostream *OutputFile;
   const DependencyOutputOptions &DepOpts;
   unsigned CurrentIncludeDepth;
@@ -28,12 +31,17 @@ class HeaderIncludesCallback : public PPCallbacks {
   bool ShowDepth;
   bool MSStyle;
 
+  /// The headers skipped because of the include guard database that have
+  /// been shown.
+  llvm::SmallPtrSet<const FileEntry *, 8> ShownSkippedHeaders;
+
 public:
   HeaderIncludesCallback(const Preprocessor *PP, bool ShowAllHeaders_,
                          raw_ostream *OutputFile_,
                          const DependencyOutputOptions &DepOpts,
                          bool OwnsOutputFile_, bool ShowDepth_, bool MSStyle_)
-      : SM(PP->getSourceManager()), OutputFile(OutputFile_), DepOpts(DepOpts),
+      : SM(PP->getSourceManager()), HS(PP->getHeaderSearchInfo()),
+        OutputFile(OutputFile_), DepOpts(DepOpts),
         CurrentIncludeDepth(0), HasProcessedPredefines(false),
         OwnsOutputFile(OwnsOutputFile_), ShowAllHeaders(ShowAllHeaders_),
         ShowDepth(ShowDepth_), MSStyle(MSStyle_) {}
@@ -46,6 +54,9 @@ public:
   void FileChanged(SourceLocation Loc, FileChangeReason Reason,
                    SrcMgr::CharacteristicKind FileType,
                    FileID PrevFID) override;
+
+  void FileSkipped(const FileEntry &SkippedFile, const Token &FilenameTok,
+                   SrcMgr::CharacteristicKind FileType) override;
 };
 }
 
@@ -164,3 +175,20 @@ void HeaderIncludesCallback::FileChanged(SourceLocation Loc,
                     MSStyle);
   }
 }
+
+void HeaderIncludesCallback::FileSkipped(const FileEntry &SkippedFile,
+                                         const Token &FilenameTok,
+                                         SrcMgr::CharacteristicKind FileType) {
+  // Without the include guard database this header would have been entered,
+  // once, so show it as if it had been.
+  if (!HasProcessedPredefines ||
+      !HS.wasSkippedByIncludeGuardDatabase(&SkippedFile) ||
+      !ShownSkippedHeaders.insert(&SkippedFile).second)
+    return;
+
+  unsigned IncludeDepth = CurrentIncludeDepth + 1;
+  if (!DepOpts.ShowIncludesPretendHeader.empty())
+    ++IncludeDepth; // Pretend inclusion by ShowIncludesPretendHeader.
+  PrintHeaderInfo(OutputFile, SkippedFile.getName(), ShowDepth, IncludeDepth,
+                  MSStyle);
+}
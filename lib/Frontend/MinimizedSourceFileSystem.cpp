@@ -0,0 +1,183 @@
+//===--- MinimizedSourceFileSystem.cpp - Directive-only sources -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/MinimizedSourceFileSystem.h"
+#include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+using namespace clang;
+
+std::shared_ptr<const std::string> MinimizedSourceCache::getMinimizedContents(
+    const vfs::Status &Status,
+    llvm::function_ref<llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>()>
+        Read) {
+  {
+    std::lock_guard<std::mutex> Guard(Lock);
+    auto Known = Entries.find(Status.getUniqueID());
+    if (Known != Entries.end() && Known->second.Size == Status.getSize() &&
+        Known->second.ModTime == Status.getLastModificationTime())
+      return Known->second.Contents;
+  }
+
+  // Minimize outside of the lock.  Two threads may both minimize the same
+  // file, which is harmless.
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer = Read();
+  if (!Buffer)
+    return nullptr;
+  SmallString<1024> Minimized;
+  minimizeSourceToDependencyDirectives((*Buffer)->getBuffer(), Minimized);
+  auto Contents = std::make_shared<const std::string>(Minimized.str());
+
+  std::lock_guard<std::mutex> Guard(Lock);
+  Entry &E = Entries[Status.getUniqueID()];
+  E.Size = Status.getSize();
+  E.ModTime = Status.getLastModificationTime();
+  E.Contents = Contents;
+  return Contents;
+}
+
+namespace {
+/// A buffer over minimized contents, which shares them with the cache
+/// instead of copying them.
+class MinimizedBuffer : public llvm::MemoryBuffer {
+  std::shared_ptr<const std::string> Contents;
+  std::string Name;
+
+public:
+  MinimizedBuffer(std::shared_ptr<const std::string> Contents,
+                  StringRef Name)
+      : Contents(std::move(Contents)), Name(Name) {
+    // std::string keeps its contents null-terminated.
+    init(this->Contents->data(),
+         this->Contents->data() + this->Contents->size(),
+         /*RequiresNullTerminator=*/true);
+  }
+
+  StringRef getBufferIdentifier() const override { return Name; }
+
+  BufferKind getBufferKind() const override { return MemoryBuffer_Malloc; }
+};
+
+/// A file whose contents have been replaced by their minimized form.
+class MinimizedFile : public vfs::File {
+  std::unique_ptr<vfs::File> UnderlyingFile;
+  vfs::Status S;
+  std::shared_ptr<const std::string> Contents;
+
+public:
+  MinimizedFile(std::unique_ptr<vfs::File> UnderlyingFile,
+                const vfs::Status &S,
+                std::shared_ptr<const std::string> Contents)
+      : UnderlyingFile(std::move(UnderlyingFile)), S(S),
+        Contents(std::move(Contents)) {}
+
+  llvm::ErrorOr<vfs::Status> status() override { return S; }
+
+  llvm::ErrorOr<std::string> getName() override {
+    return UnderlyingFile->getName();
+  }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+  getBuffer(const Twine &Name, int64_t FileSize, bool RequiresNullTerminator,
+            bool IsVolatile) override {
+    return std::unique_ptr<llvm::MemoryBuffer>(
+        new MinimizedBuffer(Contents, Name.str()));
+  }
+
+  std::error_code close() override { return UnderlyingFile->close(); }
+};
+} // end anonymous namespace
+
+MinimizedSourceFileSystem::MinimizedSourceFileSystem(
+    IntrusiveRefCntPtr<vfs::FileSystem> UnderlyingFS,
+    std::shared_ptr<MinimizedSourceCache> Cache)
+    : UnderlyingFS(std::move(UnderlyingFS)), Cache(std::move(Cache)) {}
+
+bool MinimizedSourceFileSystem::shouldMinimize(StringRef Path) {
+  // Headers often have no extension at all, so only rule out the kinds of
+  // file that the preprocessor reads but that aren't sources.
+  return llvm::StringSwitch<bool>(llvm::sys::path::extension(Path))
+      .Cases(".modulemap", ".map", ".hmap", false)
+      .Cases(".pch", ".pcm", ".pth", ".gch", false)
+      .Default(true);
+}
+
+llvm::ErrorOr<vfs::Status> MinimizedSourceFileSystem::getMinimizedStatus(
+    const vfs::Status &Status,
+    llvm::function_ref<llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>()>
+        Read,
+    std::shared_ptr<const std::string> &Contents) {
+  Contents = Cache->getMinimizedContents(Status, Read);
+  if (!Contents)
+    return std::make_error_code(std::errc::io_error);
+
+  // The size has to match the contents we hand out later.
+  vfs::Status Result(Status.getName(), Status.getUniqueID(),
+                     Status.getLastModificationTime(), Status.getUser(),
+                     Status.getGroup(), Contents->size(), Status.getType(),
+                     Status.getPermissions());
+  Result.IsVFSMapped = Status.IsVFSMapped;
+  return Result;
+}
+
+llvm::ErrorOr<vfs::Status>
+MinimizedSourceFileSystem::status(const Twine &Path) {
+  SmallString<256> PathStr;
+  StringRef Name = Path.toStringRef(PathStr);
+  llvm::ErrorOr<vfs::Status> Status = UnderlyingFS->status(Name);
+  if (!Status || !Status->isRegularFile() || !shouldMinimize(Name))
+    return Status;
+
+  std::shared_ptr<const std::string> Contents;
+  return getMinimizedStatus(
+      *Status, [&] { return UnderlyingFS->getBufferForFile(Name); },
+      Contents);
+}
+
+llvm::ErrorOr<std::unique_ptr<vfs::File>>
+MinimizedSourceFileSystem::openFileForRead(const Twine &Path) {
+  SmallString<256> PathStr;
+  StringRef Name = Path.toStringRef(PathStr);
+  llvm::ErrorOr<std::unique_ptr<vfs::File>> File =
+      UnderlyingFS->openFileForRead(Name);
+  if (!File || !shouldMinimize(Name))
+    return File;
+
+  llvm::ErrorOr<vfs::Status> Status = (*File)->status();
+  if (!Status)
+    return Status.getError();
+  if (!Status->isRegularFile())
+    return File;
+
+  std::shared_ptr<const std::string> Contents;
+  llvm::ErrorOr<vfs::Status> Minimized = getMinimizedStatus(
+      *Status, [&] { return (*File)->getBuffer(Name, Status->getSize()); },
+      Contents);
+  if (!Minimized)
+    return Minimized.getError();
+  return std::unique_ptr<vfs::File>(
+      new MinimizedFile(std::move(*File), *Minimized, std::move(Contents)));
+}
+
+vfs::directory_iterator
+MinimizedSourceFileSystem::dir_begin(const Twine &Dir, std::error_code &EC) {
+  return UnderlyingFS->dir_begin(Dir, EC);
+}
+
+llvm::ErrorOr<std::string>
+MinimizedSourceFileSystem::getCurrentWorkingDirectory() const {
+  return UnderlyingFS->getCurrentWorkingDirectory();
+}
+
+std::error_code
+MinimizedSourceFileSystem::setCurrentWorkingDirectory(const Twine &Path) {
+  return UnderlyingFS->setCurrentWorkingDirectory(Path);
+}
@@ -300,6 +300,13 @@ void MultiplexConsumer::HandleInterestingDecl(DeclGroupRef D) {
     Consumer->HandleInterestingDecl(D);
 }
 
+bool MultiplexConsumer::needsInterestingDecls() {
+  for (auto &Consumer : Consumers)
+    if (Consumer->needsInterestingDecls())
+      return true;
+  return false;
+}
+
 void MultiplexConsumer::HandleTranslationUnit(ASTContext &Ctx) {
   for (auto &Consumer : Consumers)
     Consumer->HandleTranslationUnit(Ctx);
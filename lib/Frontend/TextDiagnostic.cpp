@@ -797,8 +797,6 @@ void TextDiagnostic::emitDiagnosticLoc(SourceLocation Loc, PresumedLoc PLoc,
       const FileEntry* FE = SM.getFileEntryForID(FID);
       if (FE && FE->isValid()) {
         emitFilename(FE->getName(), SM);
-        if (FE->isInPCH())
-          OS << " (in PCH)";
         OS << ": ";
       }
     }
@@ -0,0 +1,52 @@
+//===--- TimeTraceHeaders.cpp - Time trace regions for headers ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/Utils.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TimeTraceProfiler.h"
+#include "clang/Lex/Preprocessor.h"
+using namespace clang;
+
+namespace {
+/// Records a "Source" time trace region for every file the preprocessor
+/// enters other than the main file, covering the time spent until the
+/// preprocessor returns from it (including nested includes).
+class TimeTraceHeadersCallback : public PPCallbacks {
+  SourceManager &SM;
+  unsigned CurrentIncludeDepth;
+
+public:
+  explicit TimeTraceHeadersCallback(const Preprocessor &PP)
+      : SM(PP.getSourceManager()), CurrentIncludeDepth(0) {}
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override {
+    if (Reason == PPCallbacks::EnterFile) {
+      // The main source file is at depth 1 and is covered by the region of
+      // the frontend action.
+      if (CurrentIncludeDepth++ == 0)
+        return;
+      PresumedLoc UserLoc = SM.getPresumedLoc(Loc);
+      StringRef Filename =
+          UserLoc.isValid() ? UserLoc.getFilename() : "<unknown>";
+      timeTraceProfilerBegin("Source", Filename);
+    } else if (Reason == PPCallbacks::ExitFile) {
+      if (CurrentIncludeDepth > 1)
+        timeTraceProfilerEnd();
+      if (CurrentIncludeDepth)
+        --CurrentIncludeDepth;
+    }
+  }
+};
+}
+
+void clang::AttachTimeTraceHeaders(Preprocessor &PP) {
+  PP.addPPCallbacks(llvm::make_unique<TimeTraceHeadersCallback>(PP));
+}
@@ -0,0 +1,367 @@
+//===--- DependencyDirectivesSourceMinimizer.cpp - Minimize sources -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements minimizeSourceToDependencyDirectives.  The scan works
+// on characters rather than tokens: it only has to know enough about
+// comments, literals and escaped newlines to find the lines that start with
+// a directive, and to copy those directives out.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "clang/Basic/CharInfo.h"
+#include "llvm/ADT/StringSwitch.h"
+using namespace clang;
+
+namespace {
+class Minimizer {
+  /// The start and end of the input.
+  const char *const First;
+  const char *const End;
+
+  SmallVectorImpl<char> &Out;
+
+public:
+  Minimizer(StringRef Input, SmallVectorImpl<char> &Out)
+      : First(Input.begin()), End(Input.end()), Out(Out) {}
+
+  void minimize();
+
+private:
+  const char *skipNewline(const char *P);
+  const char *skipEscapedNewline(const char *P);
+  const char *skipBlockComment(const char *P);
+  const char *skipLineComment(const char *P);
+  const char *skipQuoted(const char *P);
+  const char *skipRawString(const char *P);
+  const char *skipLiteral(const char *P);
+  const char *skipWhitespace(const char *P);
+  const char *skipLine(const char *P);
+  bool isRawStringLiteral(const char *Quote);
+  bool isCharLiteral(const char *Quote);
+  bool startsWith(const char *P, StringRef Prefix);
+  StringRef lexIdentifier(const char *&P);
+  const char *lexDirective(const char *P);
+  const char *copyLine(const char *P, bool IsInclude);
+  const char *copyLiteral(const char *P);
+};
+} // end anonymous namespace
+
+bool Minimizer::startsWith(const char *P, StringRef Prefix) {
+  return StringRef(P, End - P).startswith(Prefix);
+}
+
+/// Skip the newline at \p P.  \\r\\n and \\n\\r count as one newline.
+const char *Minimizer::skipNewline(const char *P) {
+  char C = *P++;
+  if (P != End && isVerticalWhitespace(*P) && *P != C)
+    ++P;
+  return P;
+}
+
+/// If the backslash at \p P escapes a newline, return the position after the
+/// newline.  Otherwise return null.
+const char *Minimizer::skipEscapedNewline(const char *P) {
+  const char *Q = P + 1;
+  while (Q != End && isHorizontalWhitespace(*Q))
+    ++Q;
+  if (Q == End || !isVerticalWhitespace(*Q))
+    return nullptr;
+  return skipNewline(Q);
+}
+
+const char *Minimizer::skipBlockComment(const char *P) {
+  for (P += 2; P != End; ++P)
+    if (*P == '*' && P + 1 != End && P[1] == '/')
+      return P + 2;
+  return End;
+}
+
+/// Skip a line comment, stopping at the newline that ends it.
+const char *Minimizer::skipLineComment(const char *P) {
+  for (P += 2; P != End; ++P) {
+    if (!isVerticalWhitespace(*P))
+      continue;
+    // The comment goes on if the newline is escaped.
+    const char *Q = P;
+    while (Q != First && isHorizontalWhitespace(Q[-1]))
+      --Q;
+    if (Q == First || Q[-1] != '\\')
+      return P;
+    P = skipNewline(P) - 1;
+  }
+  return End;
+}
+
+/// Skip a string or character literal.  An unterminated literal ends at the
+/// end of the line.
+const char *Minimizer::skipQuoted(const char *P) {
+  char Quote = *P++;
+  while (P != End) {
+    char C = *P;
+    if (C == Quote)
+      return P + 1;
+    if (isVerticalWhitespace(C))
+      return P;
+    if (C == '\\') {
+      if (const char *Next = skipEscapedNewline(P)) {
+        P = Next;
+        continue;
+      }
+      if (P + 1 != End)
+        ++P;
+    }
+    ++P;
+  }
+  return End;
+}
+
+/// Skip a raw string literal, given its opening quote.
+const char *Minimizer::skipRawString(const char *P) {
+  const char *Delim = ++P;
+  while (P != End && *P != '(' && !isWhitespace(*P) && *P != '\\' &&
+         *P != ')' && *P != '"')
+    ++P;
+  // Not a valid raw string literal; lex it as an ordinary one.
+  if (P == End || *P != '(')
+    return skipQuoted(Delim - 1);
+
+  StringRef Terminator = StringRef(Delim, P - Delim);
+  for (++P; P != End; ++P)
+    if (*P == ')' && startsWith(P + 1, Terminator) &&
+        P + 1 + Terminator.size() != End && P[1 + Terminator.size()] == '"')
+      return P + Terminator.size() + 2;
+  return End;
+}
+
+/// Whether the quote at \p Quote starts a raw string literal, i.e., is
+/// preceded by R, u8R, uR, UR or LR at the start of an identifier.
+bool Minimizer::isRawStringLiteral(const char *Quote) {
+  if (Quote == First || Quote[-1] != 'R')
+    return false;
+  const char *Prefix = Quote - 1;
+  if (Prefix - First >= 2 && Prefix[-1] == '8' && Prefix[-2] == 'u')
+    Prefix -= 2;
+  else if (Prefix != First &&
+           (Prefix[-1] == 'u' || Prefix[-1] == 'U' || Prefix[-1] == 'L'))
+    --Prefix;
+  return Prefix == First || !isIdentifierBody(Prefix[-1]);
+}
+
+/// Whether the quote at \p Quote starts a character literal rather than
+/// being a digit separator.
+bool Minimizer::isCharLiteral(const char *Quote) {
+  return Quote == First || !isIdentifierBody(Quote[-1]);
+}
+
+/// Skip the literal at \p P, if any; otherwise skip one character.
+const char *Minimizer::skipLiteral(const char *P) {
+  if (*P == '"')
+    return isRawStringLiteral(P) ? skipRawString(P) : skipQuoted(P);
+  if (*P == '\'' && isCharLiteral(P))
+    return skipQuoted(P);
+  return P + 1;
+}
+
+/// Skip whitespace, comments and escaped newlines, but not newlines.
+const char *Minimizer::skipWhitespace(const char *P) {
+  while (P != End) {
+    if (isHorizontalWhitespace(*P)) {
+      ++P;
+    } else if (*P == '/' && P + 1 != End && P[1] == '*') {
+      P = skipBlockComment(P);
+    } else if (*P == '\\') {
+      const char *Next = skipEscapedNewline(P);
+      if (!Next)
+        break;
+      P = Next;
+    } else {
+      break;
+    }
+  }
+  return P;
+}
+
+/// Skip the rest of the logical line starting at \p P, including the newline
+/// that ends it.
+const char *Minimizer::skipLine(const char *P) {
+  while (P != End) {
+    char C = *P;
+    if (isVerticalWhitespace(C))
+      return skipNewline(P);
+    if (C == '/' && P + 1 != End && P[1] == '*') {
+      P = skipBlockComment(P);
+    } else if (C == '/' && P + 1 != End && P[1] == '/') {
+      P = skipLineComment(P);
+    } else if (C == '\\') {
+      const char *Next = skipEscapedNewline(P);
+      P = Next ? Next : P + 1;
+    } else {
+      P = skipLiteral(P);
+    }
+  }
+  return End;
+}
+
+StringRef Minimizer::lexIdentifier(const char *&P) {
+  P = skipWhitespace(P);
+  const char *Start = P;
+  while (P != End && isIdentifierBody(*P))
+    ++P;
+  return StringRef(Start, P - Start);
+}
+
+/// Copy a string or character literal to the output, splicing escaped
+/// newlines.
+const char *Minimizer::copyLiteral(const char *P) {
+  const char *LiteralEnd = skipLiteral(P);
+  // Raw string literals are copied as they are, newlines and all.
+  if (*P == '"' && isRawStringLiteral(P)) {
+    Out.append(P, LiteralEnd);
+    return LiteralEnd;
+  }
+  while (P != LiteralEnd) {
+    if (*P == '\\')
+      if (const char *Next = skipEscapedNewline(P)) {
+        P = Next;
+        continue;
+      }
+    Out.push_back(*P++);
+  }
+  return P;
+}
+
+/// Copy the rest of a directive's line to the output, with comments and
+/// escaped newlines removed and whitespace collapsed, and end it with a
+/// newline.  Returns the position after the line.
+const char *Minimizer::copyLine(const char *P, bool IsInclude) {
+  bool PendingSpace = false;
+  bool AtStart = true;
+  while (P != End) {
+    char C = *P;
+    if (isVerticalWhitespace(C)) {
+      P = skipNewline(P);
+      break;
+    }
+    if (isHorizontalWhitespace(C)) {
+      PendingSpace = true;
+      ++P;
+      continue;
+    }
+    if (C == '/' && P + 1 != End && P[1] == '*') {
+      P = skipBlockComment(P);
+      PendingSpace = true;
+      continue;
+    }
+    if (C == '/' && P + 1 != End && P[1] == '/') {
+      P = skipLineComment(P);
+      continue;
+    }
+    if (C == '\\') {
+      if (const char *Next = skipEscapedNewline(P)) {
+        P = Next;
+        continue;
+      }
+    }
+
+    if (PendingSpace)
+      Out.push_back(' ');
+    PendingSpace = false;
+
+    // The name in #include <...> is not tokenized, so it might contain
+    // anything that looks like a comment.
+    if (C == '<' && IsInclude && AtStart) {
+      while (P != End && *P != '>' && !isVerticalWhitespace(*P))
+        Out.push_back(*P++);
+      if (P != End && *P == '>')
+        Out.push_back(*P++);
+    } else if (C == '"' || (C == '\'' && isCharLiteral(P))) {
+      P = copyLiteral(P);
+    } else {
+      Out.push_back(*P++);
+    }
+    AtStart = false;
+  }
+  Out.push_back('\n');
+  return P;
+}
+
+/// Handle the directive whose '#' (or '%:') is at \p P, and return the
+/// position after its line.
+const char *Minimizer::lexDirective(const char *P) {
+  const char *NameStart = P + (*P == '#' ? 1 : 2);
+  const char *NameEnd = NameStart;
+  StringRef Name = lexIdentifier(NameEnd);
+
+  bool IsInclude = llvm::StringSwitch<bool>(Name)
+                       .Cases("include", "include_next", "import",
+                              "__include_macros", true)
+                       .Default(false);
+  bool Keep = IsInclude || llvm::StringSwitch<bool>(Name)
+                               .Cases("if", "ifdef", "ifndef", "elif", true)
+                               .Cases("else", "endif", "define", "undef", true)
+                               .Default(false);
+
+  // Only keep the pragmas that affect header search, macros, or whether a
+  // header counts as a system header (which -MM depends on).
+  if (Name == "pragma") {
+    const char *Q = NameEnd;
+    StringRef Kind = lexIdentifier(Q);
+    if (Kind == "GCC" || Kind == "clang") {
+      StringRef SubKind = lexIdentifier(Q);
+      Keep = SubKind == "system_header" ||
+             (Kind == "clang" && SubKind == "module");
+    } else {
+      Keep = Kind == "once" || Kind == "push_macro" || Kind == "pop_macro" ||
+             Kind == "include_alias";
+    }
+  }
+
+  if (!Keep)
+    return skipLine(NameEnd);
+
+  Out.push_back('#');
+  Out.append(Name.begin(), Name.end());
+  return copyLine(NameEnd, IsInclude);
+}
+
+void Minimizer::minimize() {
+  const char *P = First;
+
+  // Skip a UTF-8 byte order mark.
+  if (startsWith(P, "\xEF\xBB\xBF"))
+    P += 3;
+
+  while (P != End) {
+    // Comments and whitespace before a '#' leave it at the start of the
+    // line, even if a comment spans several lines.
+    P = skipWhitespace(P);
+    if (P == End)
+      break;
+
+    if (*P == '#' || startsWith(P, "%:")) {
+      P = lexDirective(P);
+      continue;
+    }
+
+    if (startsWith(P, "@import") &&
+        (P + 7 == End || !isIdentifierBody(P[7]))) {
+      Out.append(P, P + 7);
+      P = copyLine(P + 7, /*IsInclude=*/false);
+      continue;
+    }
+
+    P = skipLine(P);
+  }
+}
+
+void clang::minimizeSourceToDependencyDirectives(
+    StringRef Input, SmallVectorImpl<char> &Output) {
+  Minimizer(Input, Output).minimize();
+}
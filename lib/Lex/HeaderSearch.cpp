@@ -17,6 +17,7 @@
 #include "clang/Lex/ExternalPreprocessorSource.h"
 #include "clang/Lex/HeaderMap.h"
 #include "clang/Lex/HeaderSearchOptions.h"
+#include "clang/Lex/IncludeGuardDatabase.h"
 #include "clang/Lex/LexDiagnostic.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
@@ -66,7 +67,12 @@ HeaderSearch::HeaderSearch(IntrusiveRefCntPtr<HeaderSearchOptions> HSOpts,
   ExternalSource = nullptr;
   NumIncluded = 0;
   NumMultiIncludeFileOptzn = 0;
+  NumGuardDatabaseOptzn = 0;
   NumFrameworkLookups = NumSubFrameworkLookups = 0;
+
+  if (!this->HSOpts->IncludeGuardDatabasePath.empty())
+    GuardDatabase = llvm::make_unique<IncludeGuardDatabase>(
+        FileMgr, this->HSOpts->IncludeGuardDatabasePath);
 }
 
 HeaderSearch::~HeaderSearch() {
@@ -92,6 +98,9 @@ void HeaderSearch::PrintStats() {
   fprintf(stderr, "  %d #include/#include_next/#import.\n", NumIncluded);
   fprintf(stderr, "    %d #includes skipped due to"
           " the multi-include optimization.\n", NumMultiIncludeFileOptzn);
+  if (GuardDatabase)
+    fprintf(stderr, "    %d #includes skipped due to"
+            " the include guard database.\n", NumGuardDatabaseOptzn);
 
   fprintf(stderr, "%d framework lookups.\n", NumFrameworkLookups);
   fprintf(stderr, "%d subframework lookups.\n", NumSubFrameworkLookups);
@@ -1078,14 +1087,30 @@ bool HeaderSearch::ShouldEnterIncludeFile(Preprocessor &PP,
 
   // Next, check to see if the file is wrapped with #ifndef guards.  If so, and
   // if the macro that guards it is defined, we know the #include has no effect.
-  if (const IdentifierInfo *ControllingMacro
-      = FileInfo.getControllingMacro(ExternalLookup)) {
+  const IdentifierInfo *ControllingMacro =
+      FileInfo.getControllingMacro(ExternalLookup);
+
+  // If we haven't lexed the file yet, an earlier compilation may have.
+  bool FromGuardDatabase = false;
+  if (!ControllingMacro && !FileInfo.NumIncludes && GuardDatabase) {
+    StringRef Name = GuardDatabase->lookup(File);
+    if (!Name.empty()) {
+      ControllingMacro = PP.getIdentifierInfo(Name);
+      FromGuardDatabase = true;
+    }
+  }
+
+  if (ControllingMacro) {
     // If the header corresponds to a module, check whether the macro is already
     // defined in that module rather than checking in the current set of visible
     // modules.
     if (M ? PP.isMacroDefinedInLocalModule(ControllingMacro, M)
           : PP.isMacroDefined(ControllingMacro)) {
       ++NumMultiIncludeFileOptzn;
+      if (FromGuardDatabase) {
+        ++NumGuardDatabaseOptzn;
+        SkippedByGuardDatabase.insert(File);
+      }
       return false;
     }
   }
@@ -1096,6 +1121,19 @@ bool HeaderSearch::ShouldEnterIncludeFile(Preprocessor &PP,
   return true;
 }
 
+void HeaderSearch::SetFileControllingMacro(
+    const FileEntry *File, const IdentifierInfo *ControllingMacro) {
+  getFileInfo(File).ControllingMacro = ControllingMacro;
+  if (GuardDatabase)
+    GuardDatabase->addGuard(File, ControllingMacro->getName());
+}
+
+void HeaderSearch::writeIncludeGuardDatabase() {
+  // The database is only a cache, so failing to update it isn't an error.
+  if (GuardDatabase)
+    GuardDatabase->write();
+}
+
 size_t HeaderSearch::getTotalMemory() const {
   return SearchDirs.capacity()
     + llvm::capacity_in_bytes(FileInfo)
@@ -0,0 +1,161 @@
+//===--- IncludeGuardDatabase.cpp - Persistent include guards -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the IncludeGuardDatabase class.
+//
+// The database is a text file with one line per header:
+//
+//   <size> <modification time> <guard macro> <absolute path>
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/IncludeGuardDatabase.h"
+#include "clang/Basic/FileManager.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LockFileManager.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+using namespace clang;
+
+IncludeGuardDatabase::IncludeGuardDatabase(FileManager &FileMgr,
+                                           StringRef Path)
+    : FileMgr(FileMgr), Path(Path) {
+  read(Path, Entries);
+}
+
+/// Compute the key under which \p File is stored.  This doesn't use the real
+/// path of the file, which is only known once the file has been opened.
+void IncludeGuardDatabase::getKey(const FileEntry *File,
+                                  SmallVectorImpl<char> &Key) const {
+  StringRef Name = File->getName();
+  Key.assign(Name.begin(), Name.end());
+  FileMgr.makeAbsolutePath(Key);
+  llvm::sys::path::remove_dots(Key, /*remove_dot_dot=*/false);
+}
+
+void IncludeGuardDatabase::read(StringRef Path,
+                                llvm::StringMap<Entry> &Entries) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return;
+
+  // Malformed lines are ignored; they can only cost us an optimization.
+  StringRef Rest = (*Buffer)->getBuffer();
+  while (!Rest.empty()) {
+    StringRef Line;
+    std::tie(Line, Rest) = Rest.split('\n');
+
+    StringRef Size, ModTime, Macro;
+    std::tie(Size, Line) = Line.split(' ');
+    std::tie(ModTime, Line) = Line.split(' ');
+    std::tie(Macro, Line) = Line.split(' ');
+
+    Entry E;
+    long long Time;
+    if (Size.getAsInteger(10, E.Size) || ModTime.getAsInteger(10, Time) ||
+        Macro.empty() || Line.empty())
+      continue;
+    E.ModTime = static_cast<time_t>(Time);
+    E.Macro = Macro;
+    Entries[Line] = std::move(E);
+  }
+}
+
+StringRef IncludeGuardDatabase::lookup(const FileEntry *File) const {
+  SmallString<256> Key;
+  getKey(File, Key);
+
+  auto Known = Entries.find(Key);
+  if (Known == Entries.end() ||
+      Known->second.Size != static_cast<uint64_t>(File->getSize()) ||
+      Known->second.ModTime != File->getModificationTime())
+    return StringRef();
+  return Known->second.Macro;
+}
+
+void IncludeGuardDatabase::addGuard(const FileEntry *File, StringRef Macro) {
+  SmallString<256> Key;
+  getKey(File, Key);
+
+  Entry E;
+  E.Size = File->getSize();
+  E.ModTime = File->getModificationTime();
+  E.Macro = Macro;
+
+  // Only rewrite the database if we learned something.
+  auto Known = Entries.find(Key);
+  if (Known != Entries.end() && Known->second.Size == E.Size &&
+      Known->second.ModTime == E.ModTime && Known->second.Macro == E.Macro)
+    return;
+  NewEntries[Key] = std::move(E);
+}
+
+bool IncludeGuardDatabase::write() {
+  if (NewEntries.empty())
+    return false;
+
+  while (true) {
+    llvm::LockFileManager Locked(Path);
+    switch (Locked) {
+    case llvm::LockFileManager::LFS_Error:
+      return true;
+
+    case llvm::LockFileManager::LFS_Owned:
+      return writeLocked();
+
+    case llvm::LockFileManager::LFS_Shared:
+      // Another compilation is updating the database.  Wait for it, then
+      // merge our entries into what it wrote.
+      if (Locked.waitForUnlock() == llvm::LockFileManager::Res_Timeout)
+        return true;
+      break;
+    }
+  }
+}
+
+bool IncludeGuardDatabase::writeLocked() {
+  // Start from what is on disk now, which may include entries written by
+  // other compilations since we read it.
+  llvm::StringMap<Entry> Merged;
+  read(Path, Merged);
+  for (const auto &New : NewEntries)
+    Merged[New.getKey()] = New.getValue();
+
+  SmallString<128> TempPath;
+  int TempFD;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", TempFD, TempPath))
+    return true;
+
+  {
+    llvm::raw_fd_ostream Out(TempFD, /*shouldClose=*/true);
+    for (const auto &E : Merged)
+      Out << E.getValue().Size << ' '
+          << static_cast<long long>(E.getValue().ModTime) << ' '
+          << E.getValue().Macro << ' ' << E.getKey() << '\n';
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return true;
+    }
+  }
+
+  if (llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return true;
+  }
+
+  for (auto &New : NewEntries)
+    Entries[New.getKey()] = std::move(New.getValue());
+  NewEntries.clear();
+  return false;
+}
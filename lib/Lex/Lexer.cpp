@@ -35,6 +35,13 @@
 #include <tuple>
 #include <utility>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif __ALTIVEC__
+#include <altivec.h>
+#undef bool
+#endif
+
 using namespace clang;
 
 //===----------------------------------------------------------------------===//
@@ -1504,9 +1511,103 @@ bool Lexer::tryConsumeIdentifierUTF8Char(const char *&CurPtr) {
   return true;
 }
 
+//===----------------------------------------------------------------------===//
+// Vectorized scanning
+//===----------------------------------------------------------------------===//
+//
+// These helpers skip a run of characters that need no special handling, 16 at
+// a time, and return a pointer to the first character that might.  They only
+// look at whole blocks that end before BufferEnd; the caller's scalar loop
+// handles the tail of the buffer and whatever character stopped the scan.
+
+#ifdef __SSE2__
+/// Returns a mask with one bit set for each byte of \p Chars equal to \p C.
+static inline unsigned matchChar(__m128i Chars, char C) {
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(Chars, _mm_set1_epi8(C)));
+}
+
+/// Returns a mask with one bit set for each byte of \p Chars in [Lo, Hi].
+/// Both bounds must be ASCII.
+static inline unsigned matchRange(__m128i Chars, char Lo, char Hi) {
+  // Bytes >= 0x80 compare as negative, so they're never in range.
+  return _mm_movemask_epi8(
+      _mm_and_si128(_mm_cmpgt_epi8(Chars, _mm_set1_epi8(Lo - 1)),
+                    _mm_cmpgt_epi8(_mm_set1_epi8(Hi + 1), Chars)));
+}
+#endif
+
+/// Skip spaces, tabs, form feeds and vertical tabs.
+static const char *skipHorizontalWhitespaceRun(const char *CurPtr,
+                                               const char *BufferEnd) {
+#ifdef __SSE2__
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i Chars = _mm_loadu_si128((const __m128i *)CurPtr);
+    unsigned Whitespace = matchChar(Chars, ' ') | matchChar(Chars, '\t') |
+                          matchChar(Chars, '\f') | matchChar(Chars, '\v');
+    if (unsigned Other = Whitespace ^ 0xFFFF)
+      return CurPtr + llvm::countTrailingZeros(Other);
+    CurPtr += 16;
+  }
+#endif
+  return CurPtr;
+}
+
+/// Skip the body of a line comment up to a newline or a nul, which is either
+/// the end of the buffer or a code-completion point.
+static const char *skipLineCommentRun(const char *CurPtr,
+                                      const char *BufferEnd) {
+#ifdef __SSE2__
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i Chars = _mm_loadu_si128((const __m128i *)CurPtr);
+    if (unsigned Stop = matchChar(Chars, '\n') | matchChar(Chars, '\r') |
+                        matchChar(Chars, '\0'))
+      return CurPtr + llvm::countTrailingZeros(Stop);
+    CurPtr += 16;
+  }
+#endif
+  return CurPtr;
+}
+
+/// Skip [_A-Za-z0-9]*.
+static const char *skipIdentifierBodyRun(const char *CurPtr,
+                                         const char *BufferEnd) {
+#ifdef __SSE2__
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i Chars = _mm_loadu_si128((const __m128i *)CurPtr);
+    // Setting 0x20 maps upper case letters onto lower case ones, and no
+    // other character onto a letter.
+    __m128i Lower = _mm_or_si128(Chars, _mm_set1_epi8(0x20));
+    unsigned Body = matchRange(Lower, 'a', 'z') | matchRange(Chars, '0', '9') |
+                    matchChar(Chars, '_');
+    if (unsigned Other = Body ^ 0xFFFF)
+      return CurPtr + llvm::countTrailingZeros(Other);
+    CurPtr += 16;
+  }
+#endif
+  return CurPtr;
+}
+
+/// Skip the characters of a string literal that getAndAdvanceChar() would
+/// return unchanged and that don't end the literal.
+static const char *skipStringLiteralRun(const char *CurPtr,
+                                        const char *BufferEnd) {
+#ifdef __SSE2__
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i Chars = _mm_loadu_si128((const __m128i *)CurPtr);
+    if (unsigned Stop = matchChar(Chars, '"') | matchChar(Chars, '\\') |
+                        matchChar(Chars, '?') | matchChar(Chars, '\n') |
+                        matchChar(Chars, '\r') | matchChar(Chars, '\0'))
+      return CurPtr + llvm::countTrailingZeros(Stop);
+    CurPtr += 16;
+  }
+#endif
+  return CurPtr;
+}
+
 bool Lexer::LexIdentifier(Token &Result, const char *CurPtr) {
   // Match [_A-Za-z0-9]*, we have already matched [_A-Za-z$]
   unsigned Size;
+  CurPtr = skipIdentifierBodyRun(CurPtr, BufferEnd);
   unsigned char C = *CurPtr++;
   while (isIdentifierBody(C))
     C = *CurPtr++;
@@ -1792,6 +1893,7 @@ bool Lexer::LexStringLiteral(Token &Result, const char *CurPtr,
 
       NulCharacter = CurPtr-1;
     }
+    CurPtr = skipStringLiteralRun(CurPtr, BufferEnd);
     C = getAndAdvanceChar(CurPtr, Result);
   }
 
@@ -2005,7 +2107,12 @@ bool Lexer::SkipWhitespace(Token &Result, const char *CurPtr,
 
   // Skip consecutive spaces efficiently.
   while (true) {
-    // Skip horizontal whitespace very aggressively.
+    // Skip horizontal whitespace very aggressively.  Only runs of it, such as
+    // indentation, are worth a vector scan.
+    if (isHorizontalWhitespace(Char) && isHorizontalWhitespace(CurPtr[1])) {
+      CurPtr = skipHorizontalWhitespaceRun(CurPtr, BufferEnd);
+      Char = *CurPtr;
+    }
     while (isHorizontalWhitespace(Char))
       Char = *++CurPtr;
 
@@ -2072,6 +2179,7 @@ bool Lexer::SkipLineComment(Token &Result, const char *CurPtr,
   // them.  As such, optimize for this case with the inner loop.
   char C;
   do {
+    CurPtr = skipLineCommentRun(CurPtr, BufferEnd);
     C = *CurPtr;
     // Skip over characters in the fast loop.
     while (C != 0 &&                // Potentially EOF.
@@ -2277,13 +2385,6 @@ static bool isEndOfBlockCommentWithEscapedNewLine(const char *CurPtr,
   return true;
 }
 
-#ifdef __SSE2__
-#include <emmintrin.h>
-#elif __ALTIVEC__
-#include <altivec.h>
-#undef bool
-#endif
-
 /// We have just read from input the / and * characters that started a comment.
 /// Read until we find the * and / characters that terminate the comment.
 /// Note that we don't bother decoding trigraphs or escaped newlines in block
@@ -2511,6 +2612,180 @@ void Lexer::ReadToEndOfLine(SmallVectorImpl<char> *Result) {
   }
 }
 
+/// SkipExcludedLines - Skip over the part of an excluded conditional block
+/// that cannot contain a preprocessor directive, without forming any tokens.
+/// Only comments and string and character literals are tracked; everything
+/// else is just scanned for the start of the next line.  This stops at the
+/// start of a line whose first token is '#' or '%:', or in front of anything
+/// the scan doesn't model exactly (escaped newlines, trigraphs, literal
+/// prefixes and digit separators, raw string literals, embedded nuls, the
+/// code-completion point and the end of the buffer) so that the regular lexer
+/// handles it.  The caller lexes the next token as usual afterwards.
+void Lexer::SkipExcludedLines() {
+  if (LangOpts.TraditionalCPP || LangOpts.AsmPreprocessor ||
+      isKeepWhitespaceMode())
+    return;
+
+  const char *CurPtr = BufferPtr;
+  // The start of the current line, as long as nothing but whitespace and
+  // comments have been seen on it.
+  const char *LineStart = IsAtStartOfLine ? CurPtr : nullptr;
+  // The start of the identifier or pp-number CurPtr is in, if any.
+  const char *RunStart = nullptr;
+  // Where the regular lexer should pick up.
+  const char *StopPtr = nullptr;
+
+  while (true) {
+    char C = *CurPtr;
+    switch (C) {
+    case '\n':
+    case '\r':
+      LineStart = ++CurPtr;
+      RunStart = nullptr;
+      continue;
+
+    case ' ':
+    case '\t':
+    case '\f':
+    case '\v':
+      CurPtr = skipHorizontalWhitespaceRun(CurPtr + 1, BufferEnd);
+      RunStart = nullptr;
+      continue;
+
+    case '#':
+      if (LineStart)
+        goto Stop; // A directive, or a null directive.
+      break;
+
+    case '%':
+      if (LineStart && CurPtr[1] == ':' && LangOpts.Digraphs)
+        goto Stop;
+      break;
+
+    case '/':
+      if (CurPtr[1] == '*') {
+        const char *P = CurPtr + 2;
+        for (; P[0] != '*' || P[1] != '/'; ++P)
+          if (P[0] == '\0' || (P[0] == '\\' && isWhitespace(P[1])) ||
+              (P[0] == '?' && P[1] == '?' && LangOpts.Trigraphs)) {
+            StopPtr = CurPtr;
+            goto Stop;
+          }
+        // A comment that starts at the start of a line leaves it there, even
+        // if it spans several lines.
+        CurPtr = P + 2;
+        RunStart = nullptr;
+        continue;
+      }
+      if (CurPtr[1] == '/' && LangOpts.LineComment) {
+        const char *P = skipLineCommentRun(CurPtr + 2, BufferEnd);
+        while (*P != '\n' && *P != '\r' && *P != '\0')
+          ++P;
+        // The comment continues onto the next line if the newline is
+        // escaped, and a nul might be the code-completion point.
+        const char *End = P;
+        while (isHorizontalWhitespace(End[-1]))
+          --End;
+        if (*P == '\0' || End[-1] == '\\' ||
+            (LangOpts.Trigraphs && End[-1] == '/' && End[-2] == '?' &&
+             End[-3] == '?')) {
+          StopPtr = CurPtr;
+          goto Stop;
+        }
+        CurPtr = P;
+        RunStart = nullptr;
+        continue;
+      }
+      break;
+
+    case '"':
+    case '\'': {
+      // A literal right after an identifier has an encoding prefix or is a
+      // raw string literal, and a ' in a number may be a digit separator.
+      if (RunStart) {
+        StopPtr = RunStart;
+        goto Stop;
+      }
+      const char *P = CurPtr + 1;
+      while (true) {
+        if (C == '"')
+          P = skipStringLiteralRun(P, BufferEnd);
+        char Next = *P;
+        if (Next == C) {
+          ++P;
+          break;
+        }
+        // An unterminated literal ends at the end of the line.
+        if (Next == '\n' || Next == '\r')
+          break;
+        if (Next == '\0' ||
+            (Next == '\\' && (isWhitespace(P[1]) || P[1] == '?' ||
+                              P[1] == '\0')) ||
+            (Next == '?' && P[1] == '?' && LangOpts.Trigraphs)) {
+          StopPtr = CurPtr;
+          goto Stop;
+        }
+        P += Next == '\\' ? 2 : 1;
+      }
+      CurPtr = P;
+      LineStart = nullptr;
+      continue;
+    }
+
+    case '\\':
+    case '\0':
+      // Escaped newlines, UCNs, nuls and the end of the buffer.
+      StopPtr = RunStart ? RunStart : CurPtr;
+      goto Stop;
+
+    case '?':
+      if (CurPtr[1] == '?' && LangOpts.Trigraphs) {
+        StopPtr = RunStart ? RunStart : CurPtr;
+        goto Stop;
+      }
+      break;
+
+    default:
+      break;
+    }
+
+    // Anything else is part of some token other than a comment or literal.
+    // Non-ASCII characters at the start of a line might be whitespace, which
+    // is left to the lexer to decide.
+    if (!isASCII(C) && LineStart) {
+      StopPtr = CurPtr;
+      goto Stop;
+    }
+    LineStart = nullptr;
+    if (isIdentifierBody(C, LangOpts.DollarIdents) || C == '.' || !isASCII(C)) {
+      if (!RunStart)
+        RunStart = CurPtr;
+      CurPtr = skipIdentifierBodyRun(CurPtr + 1, BufferEnd);
+    } else if ((C == '+' || C == '-') && RunStart &&
+               (CurPtr[-1] == 'e' || CurPtr[-1] == 'E' ||
+                CurPtr[-1] == 'p' || CurPtr[-1] == 'P')) {
+      // An exponent sign in a pp-number.
+      ++CurPtr;
+    } else {
+      RunStart = nullptr;
+      ++CurPtr;
+    }
+  }
+
+Stop:
+  // If nothing but whitespace and comments precede the stopping point on its
+  // line, let the lexer start at the start of the line so that the next token
+  // is flagged as such.
+  if (LineStart) {
+    if (LineStart != BufferPtr)
+      IsAtStartOfLine = IsAtPhysicalStartOfLine = true;
+    BufferPtr = LineStart;
+    return;
+  }
+  IsAtStartOfLine = IsAtPhysicalStartOfLine = false;
+  BufferPtr = StopPtr;
+}
+
 /// LexEndOfFile - CurPtr points to the end of this file.  Handle this
 /// condition, reporting diagnostics and handling other edge cases as required.
 /// This returns true if Result contains a token, false if PP.Lex should be
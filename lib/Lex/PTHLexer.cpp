@@ -12,8 +12,6 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Lex/PTHLexer.h"
-#include "clang/Basic/FileManager.h"
-#include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/TokenKinds.h"
 #include "clang/Lex/LexDiagnostic.h"
@@ -22,7 +20,9 @@
 #include "clang/Lex/Token.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/EndianStream.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
 #include <memory>
 #include <system_error>
 using namespace clang;
@@ -296,12 +296,11 @@ SourceLocation PTHLexer::getSourceLocation() {
 }
 
 //===----------------------------------------------------------------------===//
-// PTH file lookup: map from strings to file data.
+// PTH file lookup: map from file contents to file data.
 //===----------------------------------------------------------------------===//
 
 /// PTHFileLookup - This internal data structure is used by the PTHManager
-///  to map from FileEntry objects managed by FileManager to offsets within
-///  the PTH file.
+///  to map from the hash of a file's contents to offsets within the PTH file.
 namespace {
 class PTHFileData {
   const uint32_t TokenOff;
@@ -313,51 +312,46 @@ public:
   uint32_t getTokenOffset() const { return TokenOff; }
   uint32_t getPPCondOffset() const { return PPCondOff; }
 };
+} // end anonymous namespace
 
-
-class PTHFileLookupCommonTrait {
+class PTHManager::PTHFileLookupTrait {
 public:
-  typedef std::pair<unsigned char, const char*> internal_key_type;
-  typedef unsigned hash_value_type;
-  typedef unsigned offset_type;
+  typedef PTHManager::FileKey external_key_type;
+  typedef PTHManager::FileKey internal_key_type;
+  typedef PTHFileData data_type;
+  typedef uint32_t    hash_value_type;
+  typedef unsigned    offset_type;
 
-  static hash_value_type ComputeHash(internal_key_type x) {
-    return llvm::HashString(x.second);
+  static const internal_key_type &GetInternalKey(const external_key_type &K) {
+    return K;
   }
 
-  static std::pair<unsigned, unsigned>
-  ReadKeyDataLength(const unsigned char*& d) {
-    using namespace llvm::support;
-    unsigned keyLen =
-        (unsigned)endian::readNext<uint16_t, little, unaligned>(d);
-    unsigned dataLen = (unsigned) *(d++);
-    return std::make_pair(keyLen, dataLen);
+  static bool EqualKey(const internal_key_type &a,
+                       const internal_key_type &b) {
+    return a == b;
   }
 
-  static internal_key_type ReadKey(const unsigned char* d, unsigned) {
-    unsigned char k = *(d++); // Read the entry kind.
-    return std::make_pair(k, (const char*) d);
+  static hash_value_type ComputeHash(const internal_key_type &K) {
+    return (hash_value_type)K.DigestLo;
   }
-};
-
-} // end anonymous namespace
-
-class PTHManager::PTHFileLookupTrait : public PTHFileLookupCommonTrait {
-public:
-  typedef const FileEntry* external_key_type;
-  typedef PTHFileData      data_type;
 
-  static internal_key_type GetInternalKey(const FileEntry* FE) {
-    return std::make_pair((unsigned char) 0x1, FE->getName());
+  static std::pair<unsigned, unsigned>
+  ReadKeyDataLength(const unsigned char*& d) {
+    // Keys and data have a fixed size, so their lengths aren't stored.
+    return std::make_pair(8 + 8 + 8, 4 + 4);
   }
 
-  static bool EqualKey(internal_key_type a, internal_key_type b) {
-    return a.first == b.first && strcmp(a.second, b.second) == 0;
+  static internal_key_type ReadKey(const unsigned char* d, unsigned) {
+    using namespace llvm::support;
+    internal_key_type K;
+    K.DigestLo = endian::readNext<uint64_t, little, unaligned>(d);
+    K.DigestHi = endian::readNext<uint64_t, little, unaligned>(d);
+    K.Size = endian::readNext<uint64_t, little, unaligned>(d);
+    return K;
   }
 
-  static PTHFileData ReadData(const internal_key_type& k,
-                              const unsigned char* d, unsigned) {
-    assert(k.first == 0x1 && "Only file lookups can match!");
+  static PTHFileData ReadData(internal_key_type, const unsigned char* d,
+                              unsigned) {
     using namespace llvm::support;
     uint32_t x = endian::readNext<uint32_t, little, unaligned>(d);
     uint32_t y = endian::readNext<uint32_t, little, unaligned>(d);
@@ -421,7 +415,8 @@ PTHManager::PTHManager(
     : Buf(std::move(buf)), PerIDCache(std::move(perIDCache)),
       FileLookup(std::move(fileLookup)), IdDataTable(idDataTable),
       StringIdLookup(std::move(stringIdLookup)), NumIds(numIds), PP(nullptr),
-      SpellingBase(spellingBase), OriginalSourceFile(originalSourceFile) {}
+      SpellingBase(spellingBase), OriginalSourceFile(originalSourceFile),
+      NumFilesFromCache(0) {}
 
 PTHManager::~PTHManager() {
 }
@@ -430,10 +425,13 @@ static void InvalidPTH(DiagnosticsEngine &Diags, const char *Msg) {
   Diags.Report(Diags.getCustomDiagID(DiagnosticsEngine::Error, "%0")) << Msg;
 }
 
-PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
-  // Memory map the PTH file.
+PTHManager *PTHManager::Create(StringRef file, const LangOptions &LangOpts,
+                               DiagnosticsEngine &Diags) {
+  // Memory map the PTH file.  Nothing reads past the end of its tables, so
+  // it doesn't need to be null terminated.
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> FileOrErr =
-      llvm::MemoryBuffer::getFile(file);
+      llvm::MemoryBuffer::getFile(file, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
 
   if (!FileOrErr) {
     // FIXME: Add ec.message() to this diag.
@@ -450,7 +448,7 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
   const unsigned char *BufEnd = (const unsigned char*)File->getBufferEnd();
 
   // Check the prologue of the file.
-  if ((BufEnd - BufBeg) < (signed)(sizeof("cfe-pth") + 4 + 4) ||
+  if ((BufEnd - BufBeg) < (signed)(sizeof("cfe-pth") + 4 + 8 + 4) ||
       memcmp(BufBeg, "cfe-pth", sizeof("cfe-pth")) != 0) {
     Diags.Report(diag::err_invalid_pth_file) << file;
     return nullptr;
@@ -468,6 +466,14 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
     return nullptr;
   }
 
+  // Tokens are only valid for the language options they were lexed with.
+  uint64_t LangOptsHash = endian::readNext<uint64_t, little, unaligned>(p);
+  if (LangOptsHash != getLangOptsHash(LangOpts)) {
+    InvalidPTH(Diags, "PTH file was generated with incompatible language "
+                      "options");
+    return nullptr;
+  }
+
   // Compute the address of the index table at the end of the PTH file.
   const unsigned char *PrologueOffset = p;
 
@@ -477,7 +483,7 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
   }
 
   // Construct the file lookup table.  This will be used for mapping from
-  // FileEntry*'s to cached tokens.
+  // file contents to cached tokens.
   const unsigned char* FileTableOffset = PrologueOffset + sizeof(uint32_t)*2;
   const unsigned char *FileTable =
       BufBeg + endian::readNext<uint32_t, little, aligned>(FileTableOffset);
@@ -591,137 +597,84 @@ IdentifierInfo* PTHManager::get(StringRef Name) {
   return GetIdentifierInfo(*I-1);
 }
 
+PTHManager::FileKey PTHManager::getFileKey(StringRef Contents) {
+  llvm::MD5 Hash;
+  Hash.update(Contents);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  using namespace llvm::support;
+  FileKey K;
+  K.DigestLo = endian::read<uint64_t, little, unaligned>(Result);
+  K.DigestHi = endian::read<uint64_t, little, unaligned>(Result + 8);
+  K.Size = Contents.size();
+  return K;
+}
+
+uint64_t PTHManager::getLangOptsHash(const LangOptions &LangOpts) {
+  // These are the options the Lexer consults.  Keywords are not included:
+  // they are assigned to the cached identifiers by the IdentifierTable of
+  // the compilation using the cache.
+  const unsigned Opts[] = {
+    LangOpts.AsmPreprocessor, LangOpts.C99,         LangOpts.C11,
+    LangOpts.CPlusPlus,       LangOpts.CPlusPlus11, LangOpts.CPlusPlus14,
+    LangOpts.CPlusPlus1z,     LangOpts.CUDA,        LangOpts.Digraphs,
+    LangOpts.DollarIdents,    LangOpts.LineComment, LangOpts.MSVCCompat,
+    LangOpts.MicrosoftExt,    LangOpts.ObjC1,       LangOpts.OpenCL,
+    LangOpts.TraditionalCPP,  LangOpts.Trigraphs
+  };
+  uint64_t Hash = 0;
+  for (unsigned I = 0; I != llvm::array_lengthof(Opts); ++I)
+    Hash |= uint64_t(Opts[I]) << I;
+  return Hash;
+}
+
+void PTHManager::PrintStats() const {
+  llvm::errs() << "\n*** PTH Stats:\n";
+  llvm::errs() << NumFilesFromCache << " files lexed from cached tokens.\n";
+}
+
 PTHLexer *PTHManager::CreateLexer(FileID FID) {
-  const FileEntry *FE = PP->getSourceManager().getFileEntryForID(FID);
-  if (!FE)
+  assert(PP && "No preprocessor set yet!");
+
+  SourceManager &SM = PP->getSourceManager();
+  bool Invalid = false;
+  const SrcMgr::SLocEntry &Entry = SM.getSLocEntry(FID, &Invalid);
+  if (Invalid || !Entry.isFile())
     return nullptr;
 
-  using namespace llvm::support;
+  // Cached tokens are found by the contents of the file rather than its
+  // name, so they are used however the file was reached, and never for a
+  // file that has changed since the PTH file was generated.  The lookup is
+  // remembered per content cache so that re-entered files aren't rehashed.
+  const SrcMgr::ContentCache *CC = Entry.getFile().getContentCache();
+  auto Cached = FileDataCache.find(CC);
+  if (Cached == FileDataCache.end()) {
+    const llvm::MemoryBuffer *Buffer = SM.getBuffer(FID, &Invalid);
+    if (Invalid)
+      return nullptr;
 
-  // Lookup the FileEntry object in our file lookup data structure.  It will
-  // return a variant that indicates whether or not there is an offset within
-  // the PTH file that contains cached tokens.
-  PTHFileLookup::iterator I = FileLookup->find(FE);
+    std::pair<uint32_t, uint32_t> Offsets(0, 0);
+    PTHFileLookup::iterator I =
+        FileLookup->find(getFileKey(Buffer->getBuffer()));
+    if (I != FileLookup->end())
+      Offsets = std::make_pair((*I).getTokenOffset(), (*I).getPPCondOffset());
+    Cached = FileDataCache.insert(std::make_pair(CC, Offsets)).first;
+  }
 
-  if (I == FileLookup->end()) // No tokens available?
+  if (Cached->second.first == 0) // No tokens available?
     return nullptr;
 
-  const PTHFileData& FileData = *I;
+  using namespace llvm::support;
 
   const unsigned char *BufStart = (const unsigned char *)Buf->getBufferStart();
   // Compute the offset of the token data within the buffer.
-  const unsigned char* data = BufStart + FileData.getTokenOffset();
+  const unsigned char* data = BufStart + Cached->second.first;
 
   // Get the location of pp-conditional table.
-  const unsigned char* ppcond = BufStart + FileData.getPPCondOffset();
+  const unsigned char* ppcond = BufStart + Cached->second.second;
   uint32_t Len = endian::readNext<uint32_t, little, aligned>(ppcond);
   if (Len == 0) ppcond = nullptr;
 
-  assert(PP && "No preprocessor set yet!");
+  ++NumFilesFromCache;
   return new PTHLexer(*PP, FID, data, ppcond, *this);
 }
-
-//===----------------------------------------------------------------------===//
-// 'stat' caching.
-//===----------------------------------------------------------------------===//
-
-namespace {
-class PTHStatData {
-public:
-  uint64_t Size;
-  time_t ModTime;
-  llvm::sys::fs::UniqueID UniqueID;
-  const bool HasData;
-  bool IsDirectory;
-
-  PTHStatData(uint64_t Size, time_t ModTime, llvm::sys::fs::UniqueID UniqueID,
-              bool IsDirectory)
-      : Size(Size), ModTime(ModTime), UniqueID(UniqueID), HasData(true),
-        IsDirectory(IsDirectory) {}
-
-  PTHStatData() : HasData(false) {}
-};
-
-class PTHStatLookupTrait : public PTHFileLookupCommonTrait {
-public:
-  typedef const char* external_key_type;  // const char*
-  typedef PTHStatData data_type;
-
-  static internal_key_type GetInternalKey(const char *path) {
-    // The key 'kind' doesn't matter here because it is ignored in EqualKey.
-    return std::make_pair((unsigned char) 0x0, path);
-  }
-
-  static bool EqualKey(internal_key_type a, internal_key_type b) {
-    // When doing 'stat' lookups we don't care about the kind of 'a' and 'b',
-    // just the paths.
-    return strcmp(a.second, b.second) == 0;
-  }
-
-  static data_type ReadData(const internal_key_type& k, const unsigned char* d,
-                            unsigned) {
-
-    if (k.first /* File or Directory */) {
-      bool IsDirectory = true;
-      if (k.first == 0x1 /* File */) {
-        IsDirectory = false;
-        d += 4 * 2; // Skip the first 2 words.
-      }
-
-      using namespace llvm::support;
-
-      uint64_t File = endian::readNext<uint64_t, little, unaligned>(d);
-      uint64_t Device = endian::readNext<uint64_t, little, unaligned>(d);
-      llvm::sys::fs::UniqueID UniqueID(Device, File);
-      time_t ModTime = endian::readNext<uint64_t, little, unaligned>(d);
-      uint64_t Size = endian::readNext<uint64_t, little, unaligned>(d);
-      return data_type(Size, ModTime, UniqueID, IsDirectory);
-    }
-
-    // Negative stat.  Don't read anything.
-    return data_type();
-  }
-};
-} // end anonymous namespace
-
-namespace clang {
-class PTHStatCache : public FileSystemStatCache {
-  typedef llvm::OnDiskChainedHashTable<PTHStatLookupTrait> CacheTy;
-  CacheTy Cache;
-
-public:
-  PTHStatCache(PTHManager::PTHFileLookup &FL)
-      : Cache(FL.getNumBuckets(), FL.getNumEntries(), FL.getBuckets(),
-              FL.getBase()) {}
-
-  LookupResult getStat(const char *Path, FileData &Data, bool isFile,
-                       std::unique_ptr<vfs::File> *F,
-                       vfs::FileSystem &FS) override {
-    // Do the lookup for the file's data in the PTH file.
-    CacheTy::iterator I = Cache.find(Path);
-
-    // If we don't get a hit in the PTH file just forward to 'stat'.
-    if (I == Cache.end())
-      return statChained(Path, Data, isFile, F, FS);
-
-    const PTHStatData &D = *I;
-
-    if (!D.HasData)
-      return CacheMissing;
-
-    Data.Name = Path;
-    Data.Size = D.Size;
-    Data.ModTime = D.ModTime;
-    Data.UniqueID = D.UniqueID;
-    Data.IsDirectory = D.IsDirectory;
-    Data.IsNamedPipe = false;
-    Data.InPCH = true;
-
-    return CacheExists;
-  }
-};
-}
-
-std::unique_ptr<FileSystemStatCache> PTHManager::createStatCache() {
-  return llvm::make_unique<PTHStatCache>(*FileLookup);
-}
@@ -218,7 +218,6 @@ void Preprocessor::FinalizeForModelFile() {
 
 void Preprocessor::setPTHManager(PTHManager* pm) {
   PTH.reset(pm);
-  FileMgr.addStatCache(PTH->createStatCache());
 }
 
 void Preprocessor::DumpToken(const Token &Tok, bool DumpFlags) const {
@@ -294,6 +293,9 @@ void Preprocessor::PrintStats() {
                << llvm::capacity_in_bytes(PoisonReasons);
   llvm::errs() << "\n  Comment Handlers: "
                << llvm::capacity_in_bytes(CommentHandlers) << "\n";
+
+  if (PTH)
+    PTH->PrintStats();
 }
 
 Preprocessor::macro_iterator
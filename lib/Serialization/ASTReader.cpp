@@ -1278,13 +1278,19 @@ bool ASTReader::ReadSLocEntry(int ID) {
     unsigned RecCode = SLocEntryCursor.readRecord(Code, Record, &Blob);
 
     if (RecCode == SM_SLOC_BUFFER_BLOB_COMPRESSED) {
-      SmallString<0> Uncompressed;
-      if (llvm::zlib::uncompress(Blob, Uncompressed, Record[0]) !=
-          llvm::zlib::StatusOK) {
+      // Decompress straight into the buffer we hand out.
+      std::unique_ptr<llvm::MemoryBuffer> Uncompressed =
+          llvm::MemoryBuffer::getNewUninitMemBuffer(Record[0], Name);
+      size_t UncompressedSize = Record[0];
+      if (!Uncompressed ||
+          llvm::zlib::uncompress(
+              Blob, const_cast<char *>(Uncompressed->getBufferStart()),
+              UncompressedSize) != llvm::zlib::StatusOK ||
+          UncompressedSize != Record[0]) {
         Error("could not decompress embedded file contents");
         return nullptr;
       }
-      return llvm::MemoryBuffer::getMemBufferCopy(Uncompressed, Name);
+      return Uncompressed;
     } else if (RecCode == SM_SLOC_BUFFER_BLOB) {
       return llvm::MemoryBuffer::getMemBuffer(Blob.drop_back(1), Name, true);
     } else {
@@ -4193,7 +4199,8 @@ std::string ASTReader::getOriginalSourceFile(
     const std::string &ASTFileName, FileManager &FileMgr,
     const PCHContainerReader &PCHContainerRdr, DiagnosticsEngine &Diags) {
   // Open the AST file.
-  auto Buffer = FileMgr.getBufferForFile(ASTFileName);
+  auto Buffer =
+      FileMgr.getBufferForFile(ASTFileName, /*RequiresNullTerminator=*/false);
   if (!Buffer) {
     Diags.Report(diag::err_fe_unable_to_read_pch_file)
         << ASTFileName << Buffer.getError().message();
@@ -4297,7 +4304,8 @@ bool ASTReader::readASTFileControlBlock(
   // Open the AST file.
   // FIXME: This allows use of the VFS; we do not allow use of the
   // VFS when actually loading a module.
-  auto Buffer = FileMgr.getBufferForFile(Filename);
+  auto Buffer =
+      FileMgr.getBufferForFile(Filename, /*RequiresNullTerminator=*/false);
   if (!Buffer) {
     return true;
   }
@@ -6679,6 +6687,7 @@ Stmt *ASTReader::GetExternalDeclStmt(uint64_t Offset) {
   // Offset here is a global offset across the entire chain.
   RecordLocation Loc = getLocalBitOffset(Offset);
   Loc.F->DeclsCursor.JumpToBit(Loc.Offset);
+  ++NumBodiesRead;
   return ReadStmtFromStream(*Loc.F);
 }
 
@@ -6883,9 +6892,21 @@ void ASTReader::PassInterestingDeclsToConsumer() {
                                                    true);
 
   // Ensure that we've loaded all potentially-interesting declarations
-  // that need to be eagerly loaded.
-  for (auto ID : EagerlyDeserializedDecls)
+  // that need to be eagerly loaded. If the consumer won't look at them, the
+  // variables and functions from PCH files can wait until something refers
+  // to them. Anything else (an @implementation, an import, an OpenMP
+  // directive) still has to be seen by Sema, and those from modules are
+  // still loaded, as loading them merges their redeclarations.
+  bool NeedsInterestingDecls = Consumer->needsInterestingDecls();
+  for (auto ID : EagerlyDeserializedDecls) {
+    if (!NeedsInterestingDecls &&
+        !GlobalDeclMap.find(ID)->second->isModule() &&
+        isCodeGenOnlyDeclRecord(ID)) {
+      ++NumEagerlyDeserializedDeclsSkipped;
+      continue;
+    }
     GetDecl(ID);
+  }
   EagerlyDeserializedDecls.clear();
 
   while (!InterestingDecls.empty()) {
@@ -6963,6 +6984,14 @@ void ASTReader::PrintStats() {
     std::fprintf(stderr, "  %u/%u statements read (%f%%)\n",
                  NumStatementsRead, TotalNumStatements,
                  ((float)NumStatementsRead/TotalNumStatements * 100));
+  if (TotalLazyBodies)
+    std::fprintf(stderr, "  %u/%u function bodies read (%f%%)\n",
+                 NumBodiesRead, TotalLazyBodies,
+                 ((float)NumBodiesRead/TotalLazyBodies * 100));
+  if (NumEagerlyDeserializedDeclsSkipped)
+    std::fprintf(stderr,
+                 "  %u eagerly-deserialized declarations skipped\n",
+                 NumEagerlyDeserializedDeclsSkipped);
   if (TotalNumMacros)
     std::fprintf(stderr, "  %u/%u macros read (%f%%)\n",
                  NumMacrosRead, TotalNumMacros,
@@ -8619,16 +8648,20 @@ void ASTReader::finishPendingActions() {
       // FIXME: Check for =delete/=default?
       // FIXME: Complain about ODR violations here?
       const FunctionDecl *Defn = nullptr;
-      if (!getContext().getLangOpts().Modules || !FD->hasBody(Defn))
+      if (!getContext().getLangOpts().Modules || !FD->hasBody(Defn)) {
         FD->setLazyBody(PB->second);
-      else
+        ++TotalLazyBodies;
+      } else {
         mergeDefinitionVisibility(const_cast<FunctionDecl*>(Defn), FD);
+      }
       continue;
     }
 
     ObjCMethodDecl *MD = cast<ObjCMethodDecl>(PB->first);
-    if (!getContext().getLangOpts().Modules || !MD->hasBody())
+    if (!getContext().getLangOpts().Modules || !MD->hasBody()) {
       MD->setLazyBody(PB->second);
+      ++TotalLazyBodies;
+    }
   }
   PendingBodies.clear();
 
@@ -8889,7 +8922,9 @@ ASTReader::ASTReader(
       ProcessingUpdateRecords(false),
       CurrSwitchCaseStmts(&SwitchCaseStmts), NumSLocEntriesRead(0),
       TotalNumSLocEntries(0), NumStatementsRead(0), TotalNumStatements(0),
-      NumMacrosRead(0), TotalNumMacros(0), NumIdentifierLookups(0),
+      NumBodiesRead(0), TotalLazyBodies(0),
+      NumEagerlyDeserializedDeclsSkipped(0), NumMacrosRead(0),
+      TotalNumMacros(0), NumIdentifierLookups(0),
       NumIdentifierLookupHits(0), NumSelectorsRead(0),
       NumMethodPoolEntriesRead(0), NumMethodPoolLookups(0),
       NumMethodPoolHits(0), NumMethodPoolTableLookups(0),
@@ -2541,6 +2541,26 @@ static bool isConsumerInterestedIn(ASTContext &Ctx, Decl *D, bool HasBody) {
   return false;
 }
 
+/// \brief Determine, without deserializing it, whether the declaration with
+/// the given ID is a plain variable or function, which an eagerly
+/// deserialized declaration only is because code generation needs it.
+bool ASTReader::isCodeGenOnlyDeclRecord(DeclID ID) {
+  SourceLocation DeclLoc;
+  RecordLocation Loc = DeclCursorForID(ID, DeclLoc);
+  llvm::BitstreamCursor &DeclsCursor = Loc.F->DeclsCursor;
+  SavedStreamPosition SavedPosition(DeclsCursor);
+
+  DeclsCursor.JumpToBit(Loc.Offset);
+  unsigned Code = DeclsCursor.ReadCode();
+  switch ((DeclCode)DeclsCursor.skipRecord(Code)) {
+  case DECL_VAR:
+  case DECL_FUNCTION:
+    return true;
+  default:
+    return false;
+  }
+}
+
 /// \brief Get the correct cursor and offset for loading a declaration.
 ASTReader::RecordLocation
 ASTReader::DeclCursorForID(DeclID ID, SourceLocation &Loc) {
@@ -78,8 +78,10 @@
 #include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
@@ -87,6 +89,7 @@
 #include <deque>
 #include <limits>
 #include <new>
+#include <thread>
 #include <tuple>
 #include <utility>
 
@@ -1790,6 +1793,50 @@ static unsigned CreateSLocExpansionAbbrev(llvm::BitstreamWriter &Stream) {
   return Stream.EmitAbbrev(Abbrev);
 }
 
+namespace {
+/// \brief A buffer embedded in the source manager block, as it is written.
+struct CompressedBuffer {
+  CompressedBuffer() : Compressed(false) {}
+
+  /// \brief Whether \c Data holds the compressed contents.  If not, the
+  /// buffer is written uncompressed.
+  bool Compressed;
+  SmallString<0> Data;
+};
+} // end anonymous namespace
+
+/// \brief Compress each of \p Buffers into the same element of \p Results,
+/// on up to \p Threads threads (0 for one per hardware thread).
+///
+/// zlib produces the same output on any thread, so the AST file is the same
+/// however many threads are used.
+static void compressBuffers(ArrayRef<StringRef> Buffers,
+                            MutableArrayRef<CompressedBuffer> Results,
+                            unsigned Threads) {
+  auto Compress = [&](unsigned I) {
+    Results[I].Compressed = llvm::zlib::compress(Buffers[I], Results[I].Data) ==
+                            llvm::zlib::StatusOK;
+  };
+
+  if (Threads == 0)
+    Threads = std::thread::hardware_concurrency();
+  unsigned ThreadCount = std::min<size_t>(Threads, Buffers.size());
+  if (!llvm::zlib::isAvailable() || ThreadCount < 2) {
+    for (unsigned I = 0, E = Buffers.size(); I != E; ++I)
+      Compress(I);
+    return;
+  }
+
+  std::atomic<unsigned> NextBuffer(0);
+  llvm::ThreadPool Pool(ThreadCount);
+  for (unsigned T = 0; T != ThreadCount; ++T)
+    Pool.async([&] {
+      for (unsigned I = NextBuffer++; I < Buffers.size(); I = NextBuffer++)
+        Compress(I);
+    });
+  Pool.wait();
+}
+
 namespace {
 
   // Trait used for the on-disk hash table of header search information.
@@ -2004,6 +2051,25 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
       CreateSLocBufferBlobAbbrev(Stream, true);
   unsigned SLocExpansionAbbrv = CreateSLocExpansionAbbrev(Stream);
 
+  // Compress the buffers whose contents are embedded in the block up front.
+  // That only depends on the buffers, so it can be done in parallel.
+  std::vector<StringRef> EmbeddedBuffers;
+  for (unsigned I = 1, N = SourceMgr.local_sloc_entry_size(); I != N; ++I) {
+    const SrcMgr::SLocEntry &SLoc = SourceMgr.getLocalSLocEntry(I);
+    if (!SLoc.isFile())
+      continue;
+    const SrcMgr::ContentCache *Content = SLoc.getFile().getContentCache();
+    if (Content->OrigEntry && !Content->BufferOverridden &&
+        !Content->IsTransient)
+      continue;
+    const llvm::MemoryBuffer *Buffer =
+        Content->getBuffer(PP.getDiagnostics(), PP.getSourceManager());
+    EmbeddedBuffers.push_back(Buffer->getBuffer());
+  }
+  std::vector<CompressedBuffer> CompressedBuffers(EmbeddedBuffers.size());
+  compressBuffers(EmbeddedBuffers, CompressedBuffers, CompressionThreads);
+  unsigned NextEmbeddedBuffer = 0;
+
   // Write out the source location entry table. We skip the first
   // entry, which is always the same dummy entry.
   std::vector<uint32_t> SLocEntryOffsets;
@@ -2093,13 +2159,16 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
 
         // Compress the buffer if possible. We expect that almost all PCM
         // consumers will not want its contents.
-        SmallString<0> CompressedBuffer;
-        if (llvm::zlib::compress(Blob.drop_back(1), CompressedBuffer) ==
-            llvm::zlib::StatusOK) {
+        assert(NextEmbeddedBuffer < CompressedBuffers.size() &&
+               EmbeddedBuffers[NextEmbeddedBuffer] == Blob.drop_back(1) &&
+               "Embedded buffers out of sync");
+        const CompressedBuffer &Compressed =
+            CompressedBuffers[NextEmbeddedBuffer++];
+        if (Compressed.Compressed) {
           RecordData::value_type Record[] = {SM_SLOC_BUFFER_BLOB_COMPRESSED,
                                              Blob.size() - 1};
           Stream.EmitRecordWithBlob(SLocBufferBlobCompressedAbbrv, Record,
-                                    CompressedBuffer);
+                                    Compressed.Data);
         } else {
           RecordData::value_type Record[] = {SM_SLOC_BUFFER_BLOB};
           Stream.EmitRecordWithBlob(SLocBufferBlobAbbrv, Record, Blob);
@@ -4179,9 +4248,10 @@ void ASTWriter::SetSelectorOffset(Selector Sel, uint32_t Offset) {
 ASTWriter::ASTWriter(
   llvm::BitstreamWriter &Stream,
   ArrayRef<llvm::IntrusiveRefCntPtr<ModuleFileExtension>> Extensions,
-  bool IncludeTimestamps)
+  bool IncludeTimestamps, unsigned CompressionThreads)
     : Stream(Stream), Context(nullptr), PP(nullptr), Chain(nullptr),
       WritingModule(nullptr), IncludeTimestamps(IncludeTimestamps),
+      CompressionThreads(CompressionThreads),
       WritingAST(false), DoneWritingDeclsAndTypes(false),
       ASTHasCompilerErrors(false), FirstDeclID(NUM_PREDEF_DECL_IDS),
       NextDeclID(FirstDeclID), FirstTypeID(NUM_PREDEF_TYPE_IDS),
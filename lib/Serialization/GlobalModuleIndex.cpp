@@ -19,13 +19,14 @@
 #include "clang/Serialization/GlobalModuleIndex.h"
 #include "clang/Serialization/Module.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Bitcode/BitstreamReader.h"
 #include "llvm/Bitcode/BitstreamWriter.h"
 #include "llvm/Support/FileSystem.h"
-#include "llvm/Support/LockFileManager.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
@@ -33,6 +34,13 @@
 using namespace clang;
 using namespace serialization;
 
+#define DEBUG_TYPE "global-module-index"
+
+STATISTIC(NumModuleFilesLoaded,
+          "Number of module files loaded to write the global module index");
+STATISTIC(NumModuleFilesReused,
+          "Number of module files carried over from an existing global index");
+
 //----------------------------------------------------------------------------//
 // Shared constants
 //----------------------------------------------------------------------------//
@@ -239,8 +247,12 @@ GlobalModuleIndex::readIndex(StringRef Path) {
   IndexPath += Path;
   llvm::sys::path::append(IndexPath, IndexFileName);
 
+  // The index is never modified in place (see writeIndex), so it can be
+  // mapped without copying and without a null terminator; identifier lookups
+  // then only touch the pages of the buckets they probe.
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> BufferOrErr =
-      llvm::MemoryBuffer::getFile(IndexPath.c_str());
+      llvm::MemoryBuffer::getFile(IndexPath.c_str(), /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
   if (!BufferOrErr)
     return std::make_pair(nullptr, EC_NotFound);
   std::unique_ptr<llvm::MemoryBuffer> Buffer = std::move(BufferOrErr.get());
@@ -427,6 +439,27 @@ namespace {
     /// \returns true if an error occurred, false otherwise.
     bool loadModuleFile(const FileEntry *File);
 
+    /// \brief Add a module file that is unchanged since it was recorded in
+    /// an existing index, without loading it again.
+    void addIndexedModuleFile(const FileEntry *File,
+                              ArrayRef<const FileEntry *> Dependencies) {
+      (void)getModuleFileInfo(File);
+      for (const FileEntry *DependsOnFile : Dependencies) {
+        unsigned DependsOnID = getModuleFileInfo(DependsOnFile).ID;
+        getModuleFileInfo(File).Dependencies.push_back(DependsOnID);
+      }
+    }
+
+    /// \brief Add an identifier recorded in an existing index, along with
+    /// the module files added by \c addIndexedModuleFile() that consider it
+    /// interesting.
+    void addIndexedIdentifier(StringRef Name,
+                              ArrayRef<const FileEntry *> Files) {
+      SmallVector<unsigned, 2> &IDs = InterestingIdentifiers[Name];
+      for (const FileEntry *File : Files)
+        IDs.push_back(getModuleFileInfo(File).ID);
+    }
+
     /// \brief Write the index to the given bitstream.
     void writeIndex(llvm::BitstreamWriter &Stream);
   };
@@ -772,26 +805,87 @@ GlobalModuleIndex::writeIndex(FileManager &FileMgr,
   IndexPath += Path;
   llvm::sys::path::append(IndexPath, IndexFileName);
 
-  // Coordinate building the global index file with other processes that might
-  // try to do the same.
-  llvm::LockFileManager Locked(IndexPath);
-  switch (Locked) {
-  case llvm::LockFileManager::LFS_Error:
-    return EC_IOError;
-
-  case llvm::LockFileManager::LFS_Owned:
-    // We're responsible for building the index ourselves. Do so below.
-    break;
-
-  case llvm::LockFileManager::LFS_Shared:
-    // Someone else is responsible for building the index. We don't care
-    // when they finish, so we're done.
-    return EC_Building;
-  }
+  // No lock is taken: every writer builds a complete index in a temporary
+  // file and atomically renames it into place, so readers always see either
+  // the old or the new index. Concurrent writers may drop each other's
+  // updates, which the next writer picks up again.
 
   // The module index builder.
   GlobalModuleIndexBuilder Builder(FileMgr, PCHContainerRdr);
 
+  // Carry over what the current index knows about module files that have not
+  // changed since it was written, so that only new or rebuilt module files
+  // have to be loaded.
+  llvm::DenseSet<const FileEntry *> IndexedFiles;
+  bool IndexIsStale = true;
+  if (std::unique_ptr<GlobalModuleIndex> Existing{readIndex(Path).first}) {
+    IndexIsStale = false;
+
+    // Find the module files whose size and modification time still match.
+    unsigned NumModules = Existing->Modules.size();
+    SmallVector<const FileEntry *, 16> Unchanged(NumModules);
+    for (unsigned I = 0; I != NumModules; ++I) {
+      const ModuleInfo &Info = Existing->Modules[I];
+      if (Info.FileName.empty())
+        continue;
+      const FileEntry *File = FileMgr.getFile(Info.FileName,
+                                              /*openFile=*/false,
+                                              /*cacheFailure=*/false);
+      if (File && File->getSize() == Info.Size &&
+          File->getModificationTime() == Info.ModTime)
+        Unchanged[I] = File;
+      else
+        IndexIsStale = true;
+    }
+
+    // A module file is only reused if everything it depends on is.
+    for (bool Changed = true; Changed;) {
+      Changed = false;
+      for (unsigned I = 0; I != NumModules; ++I) {
+        if (!Unchanged[I])
+          continue;
+        for (unsigned DepID : Existing->Modules[I].Dependencies) {
+          if (DepID >= NumModules || !Unchanged[DepID]) {
+            Unchanged[I] = nullptr;
+            IndexIsStale = Changed = true;
+            break;
+          }
+        }
+      }
+    }
+
+    SmallVector<const FileEntry *, 4> Files;
+    for (unsigned I = 0; I != NumModules; ++I) {
+      if (!Unchanged[I])
+        continue;
+      Files.clear();
+      for (unsigned DepID : Existing->Modules[I].Dependencies)
+        Files.push_back(Unchanged[DepID]);
+      Builder.addIndexedModuleFile(Unchanged[I], Files);
+      IndexedFiles.insert(Unchanged[I]);
+      ++NumModuleFilesReused;
+    }
+
+    // Copy the identifiers over. Identifiers that were only interesting in
+    // module files which changed are kept as known-but-uninteresting, which
+    // is what a module file that no longer declares them would record.
+    if (Existing->IdentifierIndex) {
+      IdentifierIndexTable &Table =
+          *static_cast<IdentifierIndexTable *>(Existing->IdentifierIndex);
+      for (IdentifierIndexTable::key_iterator Key = Table.key_begin(),
+                                              KeyEnd = Table.key_end();
+           Key != KeyEnd; ++Key) {
+        StringRef Name = *Key;
+        SmallVector<unsigned, 2> ModuleIDs = *Table.find(Name);
+        Files.clear();
+        for (unsigned ID : ModuleIDs)
+          if (ID < NumModules && Unchanged[ID])
+            Files.push_back(Unchanged[ID]);
+        Builder.addIndexedIdentifier(Name, Files);
+      }
+    }
+  }
+
   // Load each of the module files.
   std::error_code EC;
   for (llvm::sys::fs::directory_iterator D(Path, EC), DEnd;
@@ -813,11 +907,23 @@ GlobalModuleIndex::writeIndex(FileManager &FileMgr,
     if (!ModuleFile)
       continue;
 
+    // If the existing index already describes this module file, we're done
+    // with it.
+    if (IndexedFiles.count(ModuleFile))
+      continue;
+
     // Load this module file.
     if (Builder.loadModuleFile(ModuleFile))
       return EC_IOError;
+    ++NumModuleFilesLoaded;
+    IndexIsStale = true;
   }
 
+  // If the existing index describes exactly the module files in the cache,
+  // there is nothing to write.
+  if (!IndexIsStale)
+    return EC_None;
+
   // The output buffer, into which the global index will be written.
   SmallVector<char, 16> OutputBuffer;
   {
@@ -843,10 +949,8 @@ GlobalModuleIndex::writeIndex(FileManager &FileMgr,
   if (Out.has_error())
     return EC_IOError;
 
-  // Remove the old index file. It isn't relevant any more.
-  llvm::sys::fs::remove(IndexPath);
-
-  // Rename the newly-written index file to the proper name.
+  // Rename the newly-written index file to the proper name, replacing the
+  // old index.
   if (llvm::sys::fs::rename(IndexTmpPath, IndexPath)) {
     // Rename failed; just remove the 
     llvm::sys::fs::remove(IndexTmpPath);
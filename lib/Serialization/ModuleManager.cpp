@@ -120,9 +120,15 @@ ModuleManager::addModule(StringRef FileName, ModuleKind Type,
         // ModuleManager it must be the same underlying file.
         // FIXME: Because FileManager::getFile() doesn't guarantee that it will
         // give us an open file, this may not be 100% reliable.
+        //
+        // Module files are written to a temporary file and then renamed into
+        // place, and the reader decodes them where they are, so map them
+        // read-only.  That way all the processes importing a module share
+        // its pages.
         Buf = FileMgr.getBufferForFile(ModuleEntry->File,
                                        /*IsVolatile=*/false,
-                                       /*ShouldClose=*/false);
+                                       /*ShouldClose=*/false,
+                                       /*RequiresNullTerminator=*/false);
       }
 
       if (!Buf) {
@@ -2731,7 +2731,6 @@ PathDiagnosticLocation BugReport::getLocation(const SourceManager &SM) const {
 //===----------------------------------------------------------------------===//
 
 BugReportEquivClass::~BugReportEquivClass() { }
-GRBugReporter::~GRBugReporter() { }
 BugReporterData::~BugReporterData() {}
 
 ExplodedGraph &GRBugReporter::getGraph() { return Eng.getGraph(); }
@@ -2955,6 +2954,39 @@ bool TrimmedGraph::popNextReportGraph(ReportGraph &GraphWrapper) {
   return true;
 }
 
+/// The trimmed graph for the reports of one equivalence class, and the
+/// single-path graphs extracted from it so far, shortest first.
+class GRBugReporter::ReportPathCache {
+  SmallVector<BugReport *, 10> Reports;
+  TrimmedGraph TrimG;
+  std::vector<std::unique_ptr<ReportGraph>> Paths;
+
+public:
+  ReportPathCache(const ExplodedGraph *G, ArrayRef<BugReport *> Reports,
+                  ArrayRef<const ExplodedNode *> ErrorNodes)
+      : Reports(Reports.begin(), Reports.end()), TrimG(G, ErrorNodes) {}
+
+  bool isFor(ArrayRef<BugReport *> OtherReports) const {
+    return OtherReports.equals(Reports);
+  }
+
+  /// Returns the \p I'th shortest path, or null if there are fewer paths.
+  ReportGraph *getPath(unsigned I) {
+    while (Paths.size() <= I) {
+      auto Path = llvm::make_unique<ReportGraph>();
+      if (!TrimG.popNextReportGraph(*Path))
+        return nullptr;
+      Paths.push_back(std::move(Path));
+    }
+    return Paths[I].get();
+  }
+};
+
+GRBugReporter::GRBugReporter(BugReporterData &d, ExprEngine &eng)
+    : BugReporter(d, GRBugReporterKind), Eng(eng) {}
+
+GRBugReporter::~GRBugReporter() { }
+
 
 /// CompactPathDiagnostic - This function postprocesses a PathDiagnostic object
 ///  and collapses PathDiagosticPieces that are expanded by macros.
@@ -3086,19 +3118,29 @@ bool GRBugReporter::generatePathDiagnostic(PathDiagnostic& PD,
     }
   }
 
-  TrimmedGraph TrimG(&getGraph(), errorNodes);
-  ReportGraph ErrorGraph;
+  // Every consumer asks for a path for the same reports in turn, so only
+  // trim the graph for the first of them.
+  if (!PathCache || !PathCache->isFor(bugReports))
+    PathCache.reset(new ReportPathCache(&getGraph(), bugReports, errorNodes));
+
+  for (unsigned PathIndex = 0;; ++PathIndex) {
+    ReportGraph *ErrorGraph = PathCache->getPath(PathIndex);
+    if (!ErrorGraph)
+      break;
 
-  while (TrimG.popNextReportGraph(ErrorGraph)) {
     // Find the BugReport with the original location.
-    assert(ErrorGraph.Index < bugReports.size());
-    BugReport *R = bugReports[ErrorGraph.Index];
+    assert(ErrorGraph->Index < bugReports.size());
+    BugReport *R = bugReports[ErrorGraph->Index];
     assert(R && "No original report found for sliced graph.");
-    assert(R->isValid() && "Report selected by trimmed graph marked invalid.");
+
+    // The report may have been suppressed while generating the path for an
+    // earlier consumer.
+    if (!R->isValid())
+      continue;
 
     // Start building the path diagnostic...
-    PathDiagnosticBuilder PDB(*this, R, ErrorGraph.BackMap, &PC);
-    const ExplodedNode *N = ErrorGraph.ErrorNode;
+    PathDiagnosticBuilder PDB(*this, R, ErrorGraph->BackMap, &PC);
+    const ExplodedNode *N = ErrorGraph->ErrorNode;
 
     // Register additional node visitors.
     R->addVisitor(llvm::make_unique<NilReceiverBRVisitor>());
@@ -18,6 +18,7 @@
 #include "clang/AST/StmtCXX.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Casting.h"
 
@@ -32,6 +33,8 @@ STATISTIC(NumReachedMaxSteps,
             "The # of times we reached the max number of steps.");
 STATISTIC(NumPathsExplored,
             "The # of paths explored by the analyzer.");
+STATISTIC(NumDeadPathNodes,
+            "The # of nodes removed because they reached no report.");
 
 //===----------------------------------------------------------------------===//
 // Worklist classes for exploration of reachable states.
@@ -156,10 +159,139 @@ WorkList* WorkList::makeBFSBlockDFSContents() {
   return new BFSBlockDFSContents();
 }
 
+namespace {
+/// A DFS worklist that resumes the paths entering a not yet reached block
+/// before any of the others.
+///
+/// Plain DFS keeps unrolling the same loops and diamonds of the paths it
+/// happens to start with, so when the node budget runs out large parts of
+/// the function may never have been looked at.  Here a path that enters a
+/// block which has already been reached is set aside until no path leads
+/// anywhere new.  Blocks are told apart by stack frame, so the body of an
+/// inlined call counts as unexplored for every new call site.
+class UnexploredFirstStack : public WorkList {
+  /// Paths that are inside, or about to enter, a block not reached before.
+  SmallVector<WorkListUnit, 20> StackUnexplored;
+  /// Paths that have entered a block which had already been reached.
+  SmallVector<WorkListUnit, 20> StackOthers;
+
+  typedef std::pair<unsigned, const StackFrameContext *> BlockInFrame;
+  llvm::DenseSet<BlockInFrame> Reached;
+
+public:
+  bool hasWork() const override {
+    return !StackUnexplored.empty() || !StackOthers.empty();
+  }
+
+  void enqueue(const WorkListUnit &U) override {
+    const ExplodedNode *N = U.getNode();
+    Optional<BlockEntrance> BE = N->getLocation().getAs<BlockEntrance>();
+
+    // Only a block entrance tells whether a path goes anywhere new; keep
+    // working on everything else as plain DFS would.
+    if (!BE) {
+      StackUnexplored.push_back(U);
+      return;
+    }
+
+    BlockInFrame Key(BE->getBlock()->getBlockID(),
+                     N->getLocationContext()->getCurrentStackFrame());
+    if (Reached.insert(Key).second)
+      StackUnexplored.push_back(U);
+    else
+      StackOthers.push_back(U);
+  }
+
+  WorkListUnit dequeue() override {
+    SmallVectorImpl<WorkListUnit> &Stack =
+        StackUnexplored.empty() ? StackOthers : StackUnexplored;
+    assert(!Stack.empty());
+    // Don't use const reference.  The subsequent pop_back() might make it
+    // unsafe.
+    WorkListUnit U = Stack.back();
+    Stack.pop_back();
+    return U;
+  }
+
+  bool visitItemsInWorkList(Visitor &V) override {
+    for (const WorkListUnit &U : StackUnexplored)
+      if (V.visit(U))
+        return true;
+    for (const WorkListUnit &U : StackOthers)
+      if (V.visit(U))
+        return true;
+    return false;
+  }
+};
+} // end anonymous namespace
+
+WorkList *WorkList::makeUnexploredFirst() {
+  return new UnexploredFirstStack();
+}
+
 //===----------------------------------------------------------------------===//
 // Core analysis engine.
 //===----------------------------------------------------------------------===//
 
+static WorkList *makeWorkList(AnalyzerOptions &Opts) {
+  switch (Opts.getExplorationStrategy()) {
+  case ESK_DFS:
+    return WorkList::makeDFS();
+  case ESK_BFS:
+    return WorkList::makeBFS();
+  case ESK_BFSBlockDFSContents:
+    return WorkList::makeBFSBlockDFSContents();
+  case ESK_UnexploredFirst:
+    return WorkList::makeUnexploredFirst();
+  case ESK_NotSet:
+    break;
+  }
+  llvm_unreachable("Unknown exploration strategy");
+}
+
+/// The graph size at which dead paths are first removed.  After that the
+/// graph has to double in size before it is swept again, so the sweeps take
+/// time linear in the number of nodes created.
+static const unsigned MinDeadPathSweepSize = 4096;
+
+CoreEngine::CoreEngine(SubEngine &subengine, FunctionSummariesTy *FS,
+                       AnalyzerOptions &Opts)
+    : SubEng(subengine), WList(makeWorkList(Opts)),
+      BCounterFactory(G.getAllocator()), FunctionSummaries(FS),
+      ReclaimDeadPaths(Opts.shouldReclaimDeadPaths()),
+      DeadPathSweepSize(MinDeadPathSweepSize) {}
+
+namespace {
+class CollectWorkListNodes : public WorkList::Visitor {
+  SmallVectorImpl<const ExplodedNode *> &Nodes;
+
+public:
+  CollectWorkListNodes(SmallVectorImpl<const ExplodedNode *> &Nodes)
+      : Nodes(Nodes) {}
+
+  bool visit(const WorkListUnit &U) override {
+    Nodes.push_back(U.getNode());
+    return false;
+  }
+};
+} // end anonymous namespace
+
+void CoreEngine::reclaimDeadPaths() {
+  // Everything outside the graph that refers to a node: the paths still to
+  // be explored, the bug reports, and the places where we gave up.
+  SmallVector<const ExplodedNode *, 64> Live;
+  CollectWorkListNodes Collector(Live);
+  WList->visitItemsInWorkList(Collector);
+  SubEng.collectReportedNodes(Live);
+  for (const auto &Exhausted : blocksExhausted)
+    Live.push_back(Exhausted.second);
+  for (const auto &Aborted : blocksAborted)
+    Live.push_back(Aborted.second);
+
+  NumDeadPathNodes += G.removeNodesNotReaching(Live);
+  DeadPathSweepSize = std::max(2 * G.size(), MinDeadPathSweepSize);
+}
+
 /// ExecuteWorkList - Run the worklist algorithm for a maximum number of steps.
 bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
                                    ProgramStateRef InitState) {
@@ -224,6 +356,11 @@ bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
 
     NumSteps++;
 
+    // Nothing but the worklist refers to a node between two steps, so this
+    // is where dead paths can be removed.
+    if (ReclaimDeadPaths && G.size() >= DeadPathSweepSize)
+      reclaimDeadPaths();
+
     const WorkListUnit& WU = WList->dequeue();
 
     // Set the current block counter.
@@ -196,6 +196,60 @@ void ExplodedGraph::reclaimRecentlyAllocatedNodes() {
   ChangedNodes.clear();
 }
 
+unsigned
+ExplodedGraph::removeNodesNotReaching(ArrayRef<const ExplodedNode *> Live) {
+  // Mark everything that reaches a live node, walking backwards.
+  llvm::DenseSet<const ExplodedNode *> Reaching;
+  SmallVector<const ExplodedNode *, 32> WL;
+  for (const ExplodedNode *N : Live)
+    if (Reaching.insert(N).second)
+      WL.push_back(N);
+  for (const ExplodedNode *N : Roots)
+    if (Reaching.insert(N).second)
+      WL.push_back(N);
+
+  while (!WL.empty()) {
+    const ExplodedNode *N = WL.pop_back_val();
+    for (ExplodedNode::const_pred_iterator I = N->pred_begin(),
+                                           E = N->pred_end();
+         I != E; ++I)
+      if (Reaching.insert(*I).second)
+        WL.push_back(*I);
+  }
+
+  if (Reaching.size() == NumNodes)
+    return 0;
+
+  NodeVector Dead;
+  for (ExplodedNode &N : Nodes)
+    if (!Reaching.count(&N))
+      Dead.push_back(&N);
+
+  // The successors of a dead node are dead as well, so the only edges that
+  // have to be fixed up are the ones from surviving predecessors.
+  for (ExplodedNode *N : Dead)
+    for (ExplodedNode::pred_iterator I = N->pred_begin(), E = N->pred_end();
+         I != E; ++I)
+      if (Reaching.count(*I))
+        (*I)->Succs.removeNode(N);
+
+  for (ExplodedNode *N : Dead) {
+    Nodes.RemoveNode(N);
+    N->~ExplodedNode();
+    FreeNodes.push_back(N);
+  }
+  NumNodes -= Dead.size();
+
+  auto IsDead = [&](const ExplodedNode *N) { return !Reaching.count(N); };
+  ChangedNodes.erase(
+      std::remove_if(ChangedNodes.begin(), ChangedNodes.end(), IsDead),
+      ChangedNodes.end());
+  EndNodes.erase(std::remove_if(EndNodes.begin(), EndNodes.end(), IsDead),
+                 EndNodes.end());
+
+  return Dead.size();
+}
+
 //===----------------------------------------------------------------------===//
 // ExplodedNode.
 //===----------------------------------------------------------------------===//
@@ -231,6 +285,23 @@ void ExplodedNode::NodeGroup::replaceNode(ExplodedNode *node) {
   assert(Storage.is<ExplodedNode *>());
 }
 
+void ExplodedNode::NodeGroup::removeNode(ExplodedNode *node) {
+  assert(!getFlag());
+
+  GroupStorage &Storage = reinterpret_cast<GroupStorage&>(P);
+  if (ExplodedNodeVector *V = Storage.dyn_cast<ExplodedNodeVector *>()) {
+    ExplodedNodeVector::iterator I = std::find(V->begin(), V->end(), node);
+    assert(I != V->end() && "Node is not in the group");
+    std::copy(I + 1, V->end(), I);
+    V->pop_back();
+    return;
+  }
+
+  assert(Storage.get<ExplodedNode *>() == node && "Node is not in the group");
+  Storage = GroupStorage();
+  assert(!getFlag());
+}
+
 void ExplodedNode::NodeGroup::addNode(ExplodedNode *N, ExplodedGraph &G) {
   assert(!getFlag());
 
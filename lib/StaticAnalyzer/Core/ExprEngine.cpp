@@ -73,7 +73,7 @@ ExprEngine::ExprEngine(AnalysisManager &mgr, bool gcEnabled,
                        InliningModes HowToInlineIn)
   : AMgr(mgr),
     AnalysisDeclContexts(mgr.getAnalysisDeclContextManager()),
-    Engine(*this, FS),
+    Engine(*this, FS, mgr.getAnalyzerOptions()),
     G(Engine.getGraph()),
     StateMgr(getContext(), mgr.getStoreManagerCreator(),
              mgr.getConstraintManagerCreator(), G.getAllocator(),
@@ -285,6 +285,16 @@ void ExprEngine::processEndWorklist(bool hasWorkRemaining) {
   getCheckerManager().runCheckersForEndAnalysis(G, BR, *this);
 }
 
+void ExprEngine::collectReportedNodes(
+    SmallVectorImpl<const ExplodedNode *> &Nodes) {
+  for (BugReporter::EQClasses_iterator I = BR.EQClasses_begin(),
+                                       E = BR.EQClasses_end();
+       I != E; ++I)
+    for (const BugReport &R : *I)
+      if (const ExplodedNode *N = R.getErrorNode())
+        Nodes.push_back(N);
+}
+
 void ExprEngine::processCFGElement(const CFGElement E, ExplodedNode *Pred,
                                    unsigned StmtIdx, NodeBuilderContext *Ctx) {
   PrettyStackTraceLocationContext CrashInfo(Pred->getLocationContext());
@@ -483,6 +483,12 @@ ProgramStateManager::FindGDMContext(void *K,
 
 ProgramStateRef ProgramStateManager::addGDM(ProgramStateRef St, void *Key, void *Data){
   ProgramState::GenericDataMap M1 = St->getGDM();
+
+  // Don't allocate a new map just to find that it is the same as the old one.
+  if (void *const *Existing = M1.lookup(Key))
+    if (*Existing == Data)
+      return St;
+
   ProgramState::GenericDataMap M2 = GDMFactory.add(M1, Key, Data);
 
   if (M1 == M2)
@@ -18,11 +18,17 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramStateTrait.h"
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/ImmutableSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace clang;
 using namespace ento;
 
+#define DEBUG_TYPE "RangeConstraintManager"
+
+STATISTIC(NumRedundantConstraints,
+          "The # of assumptions that did not change a symbol's range");
+
 /// A Range represents the closed range [from, to].  The caller must
 /// guarantee that from <= to.  Note that Range is immutable, so as not
 /// to subvert RangeSet's immutability.
@@ -154,6 +160,21 @@ private:
     return ranges.begin()->From();
   }
 
+  /// Returns true if every range in the set lies within [Lower, Upper], taken
+  /// to wrap around as in Intersect().  This may return false for a wrapping
+  /// range that leaves no gap, which is only a missed shortcut.
+  bool isWithin(const llvm::APSInt &Lower, const llvm::APSInt &Upper) const {
+    for (const Range &R : ranges) {
+      if (Lower <= Upper) {
+        if (R.From() < Lower || R.To() > Upper)
+          return false;
+      } else if (R.From() < Lower && R.To() > Upper) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   bool pin(llvm::APSInt &Lower, llvm::APSInt &Upper) const {
     // This function has nine cases, the cartesian product of range-testing
     // both the upper and lower bounds against the symbol's type.
@@ -248,6 +269,12 @@ public:
     if (!pin(Lower, Upper))
       return F.getEmptySet();
 
+    // Most assumptions re-check something that is already known.  Building
+    // the same set again would allocate a new tree only to find the
+    // existing one when it is canonicalized.
+    if (isWithin(Lower, Upper))
+      return *this;
+
     PrimRangeSet newRanges = F.getEmptySet();
 
     PrimRangeSet::iterator i = begin(), e = end();
@@ -411,6 +438,22 @@ RangeConstraintManager::removeDeadBindings(ProgramStateRef state,
   return state->set<ConstraintRange>(CR);
 }
 
+/// Record \p New as the range of values of \p Sym, or return null if it is
+/// empty.
+static ProgramStateRef setRange(ProgramStateRef St, SymbolRef Sym,
+                                const RangeSet &New) {
+  if (New.isEmpty())
+    return nullptr;
+
+  // Don't rebuild the constraint map if the assumption was already known.
+  const RangeSet *Old = St->get<ConstraintRange>(Sym);
+  if (Old && *Old == New) {
+    ++NumRedundantConstraints;
+    return St;
+  }
+  return St->set<ConstraintRange>(Sym, New);
+}
+
 RangeSet
 RangeConstraintManager::GetRange(ProgramStateRef state, SymbolRef sym) {
   if (ConstraintRangeTy::data_type* V = state->get<ConstraintRange>(sym))
@@ -462,7 +505,7 @@ RangeConstraintManager::assumeSymNE(ProgramStateRef St, SymbolRef Sym,
   // [Int-Adjustment+1, Int-Adjustment-1]
   // Notice that the lower bound is greater than the upper bound.
   RangeSet New = GetRange(St, Sym).Intersect(getBasicVals(), F, Upper, Lower);
-  return New.isEmpty() ? nullptr : St->set<ConstraintRange>(Sym, New);
+  return setRange(St, Sym, New);
 }
 
 ProgramStateRef
@@ -477,7 +520,7 @@ RangeConstraintManager::assumeSymEQ(ProgramStateRef St, SymbolRef Sym,
   // [Int-Adjustment, Int-Adjustment]
   llvm::APSInt AdjInt = AdjustmentType.convert(Int) - Adjustment;
   RangeSet New = GetRange(St, Sym).Intersect(getBasicVals(), F, AdjInt, AdjInt);
-  return New.isEmpty() ? nullptr : St->set<ConstraintRange>(Sym, New);
+  return setRange(St, Sym, New);
 }
 
 RangeSet RangeConstraintManager::getSymLTRange(ProgramStateRef St,
@@ -513,7 +556,7 @@ RangeConstraintManager::assumeSymLT(ProgramStateRef St, SymbolRef Sym,
                                     const llvm::APSInt &Int,
                                     const llvm::APSInt &Adjustment) {
   RangeSet New = getSymLTRange(St, Sym, Int, Adjustment);
-  return New.isEmpty() ? nullptr : St->set<ConstraintRange>(Sym, New);
+  return setRange(St, Sym, New);
 }
 
 RangeSet
@@ -549,7 +592,7 @@ RangeConstraintManager::assumeSymGT(ProgramStateRef St, SymbolRef Sym,
                                     const llvm::APSInt &Int,
                                     const llvm::APSInt &Adjustment) {
   RangeSet New = getSymGTRange(St, Sym, Int, Adjustment);
-  return New.isEmpty() ? nullptr : St->set<ConstraintRange>(Sym, New);
+  return setRange(St, Sym, New);
 }
 
 RangeSet
@@ -585,7 +628,7 @@ RangeConstraintManager::assumeSymGE(ProgramStateRef St, SymbolRef Sym,
                                     const llvm::APSInt &Int,
                                     const llvm::APSInt &Adjustment) {
   RangeSet New = getSymGERange(St, Sym, Int, Adjustment);
-  return New.isEmpty() ? nullptr : St->set<ConstraintRange>(Sym, New);
+  return setRange(St, Sym, New);
 }
 
 RangeSet
@@ -649,7 +692,7 @@ RangeConstraintManager::assumeSymLE(ProgramStateRef St, SymbolRef Sym,
                                     const llvm::APSInt &Int,
                                     const llvm::APSInt &Adjustment) {
   RangeSet New = getSymLERange(St, Sym, Int, Adjustment);
-  return New.isEmpty() ? nullptr : St->set<ConstraintRange>(Sym, New);
+  return setRange(St, Sym, New);
 }
 
 ProgramStateRef
@@ -660,7 +703,7 @@ RangeConstraintManager::assumeSymbolWithinInclusiveRange(
   if (New.isEmpty())
     return nullptr;
   New = getSymLERange(New, To, Adjustment);
-  return New.isEmpty() ? nullptr : State->set<ConstraintRange>(Sym, New);
+  return setRange(State, Sym, New);
 }
 
 ProgramStateRef
@@ -670,7 +713,7 @@ RangeConstraintManager::assumeSymbolOutOfInclusiveRange(
   RangeSet RangeLT = getSymLTRange(State, Sym, From, Adjustment);
   RangeSet RangeGT = getSymGTRange(State, Sym, To, Adjustment);
   RangeSet New(RangeLT.addRange(F, RangeGT));
-  return New.isEmpty() ? nullptr : State->set<ConstraintRange>(Sym, New);
+  return setRange(State, Sym, New);
 }
 
 //===------------------------------------------------------------------------===
@@ -28,12 +28,18 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/SubEngine.h"
 #include "llvm/ADT/ImmutableMap.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/raw_ostream.h"
 #include <utility>
 
 using namespace clang;
 using namespace ento;
 
+#define DEBUG_TYPE "RegionStore"
+
+STATISTIC(NumRedundantBindings,
+          "The # of bindings that stored the value already bound");
+
 //===----------------------------------------------------------------------===//
 // Representation of binding keys.
 //===----------------------------------------------------------------------===//
@@ -240,6 +246,17 @@ RegionBindingsRef RegionBindingsRef::addBinding(BindingKey K, SVal V) const {
   const MemRegion *Base = K.getBaseRegion();
 
   const ClusterBindings *ExistingCluster = lookup(Base);
+
+  // Storing the value a location already has is common, e.g. on every trip
+  // around a loop.  Neither map needs to change, and keeping the same store
+  // lets the new state be uniqued with the old one.
+  if (ExistingCluster)
+    if (const SVal *Existing = ExistingCluster->lookup(K))
+      if (*Existing == V) {
+        ++NumRedundantBindings;
+        return *this;
+      }
+
   ClusterBindings Cluster =
       (ExistingCluster ? *ExistingCluster : CBFactory->getEmptyMap());
 
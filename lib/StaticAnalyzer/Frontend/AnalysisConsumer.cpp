@@ -35,6 +35,7 @@
 #include "clang/StaticAnalyzer/Frontend/CheckerRegistration.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
@@ -371,6 +372,20 @@ private:
   /// \brief Check if we should skip (not analyze) the given function.
   AnalysisMode getModeForDecl(Decl *D, AnalysisMode Mode);
 
+  /// \brief Whether this process runs the checks that are not divided up by
+  /// the 'shard-count' option: the syntax-based checks and the translation
+  /// unit checks.
+  bool isFirstAnalysisShard();
+
+  /// \brief Whether this process analyzes \p D as a top-level function.
+  ///
+  /// A shard reports every issue found while analyzing its own top-level
+  /// functions, including the issues in the callees they inline.  A callee
+  /// can therefore be reported both by its caller's shard and by its own;
+  /// whatever merges the shards' output removes such duplicates by issue
+  /// hash, as scan-build does.
+  bool isInAnalysisShard(const Decl *D);
+
 };
 } // end anonymous namespace
 
@@ -511,7 +526,9 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
     // Introduce a scope to destroy BR before Mgr.
     BugReporter BR(*Mgr);
     TranslationUnitDecl *TU = C.getTranslationUnitDecl();
-    checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
+    bool IsFirstShard = isFirstAnalysisShard();
+    if (IsFirstShard)
+      checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
 
     // Run the AST-only checks using the order in which functions are defined.
     // If inlining is not turned on, use the simplest function order for path
@@ -536,7 +553,8 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
       HandleDeclsCallGraph(LocalTUDeclsSize);
 
     // After all decls handled, run checkers on the entire TranslationUnit.
-    checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
+    if (IsFirstShard)
+      checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
 
     RecVisitorBR = nullptr;
   }
@@ -637,12 +655,43 @@ AnalysisConsumer::getModeForDecl(Decl *D, AnalysisMode Mode) {
   if (!Opts->AnalyzeAll && !SM.isWrittenInMainFile(SL)) {
     if (SL.isInvalid() || SM.isInSystemHeader(SL))
       return AM_None;
-    return Mode & ~AM_Path;
+    Mode &= ~AM_Path;
   }
 
+  // When the work is divided between several processes, the syntax-based
+  // checks are cheap enough to all run in the first one, and each process
+  // runs the path-sensitive checks on its own share of the functions.
+  if (!isFirstAnalysisShard())
+    Mode &= ~AM_Syntax;
+  if ((Mode & AM_Path) && !isInAnalysisShard(D))
+    Mode &= ~AM_Path;
+
   return Mode;
 }
 
+bool AnalysisConsumer::isFirstAnalysisShard() {
+  return Opts->getAnalysisShardCount() <= 1 ||
+         Opts->getAnalysisShardIndex() == 0;
+}
+
+bool AnalysisConsumer::isInAnalysisShard(const Decl *D) {
+  unsigned ShardCount = Opts->getAnalysisShardCount();
+  if (ShardCount <= 1)
+    return true;
+
+  // Use where the declaration is written rather than anything address-based,
+  // so that every process divides the functions up the same way.
+  SourceManager &SM = Ctx->getSourceManager();
+  PresumedLoc Loc = SM.getPresumedLoc(SM.getExpansionLoc(D->getLocation()));
+  if (Loc.isInvalid())
+    return isFirstAnalysisShard();
+  std::string Key;
+  llvm::raw_string_ostream OS(Key);
+  OS << Loc.getFilename() << ':' << Loc.getLine() << ':' << Loc.getColumn();
+  return llvm::HashString(OS.str()) % ShardCount ==
+         Opts->getAnalysisShardIndex();
+}
+
 void AnalysisConsumer::HandleCode(Decl *D, AnalysisMode Mode,
                                   ExprEngine::InliningModes IMode,
                                   SetOfConstDecls *VisitedCallees) {
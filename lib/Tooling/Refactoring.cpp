@@ -34,6 +34,11 @@ std::map<std::string, Replacements> &RefactoringTool::getReplacements() {
   return FileToReplaces;
 }
 
+llvm::Error RefactoringTool::addReplacement(const Replacement &R) {
+  std::lock_guard<std::mutex> Lock(ReplacementsMutex);
+  return FileToReplaces[R.getFilePath()].add(R);
+}
+
 int RefactoringTool::runAndSave(FrontendActionFactory *ActionFactory) {
   if (int Result = run(ActionFactory)) {
     return Result;
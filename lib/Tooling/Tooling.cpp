@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Tooling/Tooling.h"
+#include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Driver/Compilation.h"
 #include "clang/Driver/Driver.h"
 #include "clang/Driver/Options.h"
@@ -33,7 +34,12 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include <utility>
 
 #define DEBUG_TYPE "clang-tooling"
@@ -468,6 +474,207 @@ int ClangTool::run(ToolAction *Action) {
 
 namespace {
 
+/// Collects the diagnostics of one translation unit and forwards them to
+/// another consumer when the source file ends, holding a lock for the whole
+/// file, so that translation units processed at the same time never call into
+/// that consumer concurrently or interleave their diagnostics.
+class BufferedDiagnosticConsumer : public DiagnosticConsumer {
+  DiagnosticConsumer &Consumer;
+  std::mutex &Mutex;
+  std::vector<StoredDiagnostic> Diags;
+  const LangOptions *LangOpts;
+  const Preprocessor *PP;
+
+public:
+  BufferedDiagnosticConsumer(DiagnosticConsumer &Consumer, std::mutex &Mutex)
+      : Consumer(Consumer), Mutex(Mutex), LangOpts(nullptr), PP(nullptr) {}
+
+  void BeginSourceFile(const LangOptions &LangOpts,
+                       const Preprocessor *PP) override {
+    // Diagnostics from before the source file, e.g. from the driver.
+    flush();
+    this->LangOpts = &LangOpts;
+    this->PP = PP;
+  }
+
+  void EndSourceFile() override {
+    flush();
+    LangOpts = nullptr;
+    PP = nullptr;
+  }
+
+  void finish() override {
+    flush();
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Consumer.finish();
+  }
+
+  bool IncludeInDiagnosticCounts() const override {
+    return Consumer.IncludeInDiagnosticCounts();
+  }
+
+  void HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
+                        const Diagnostic &Info) override {
+    DiagnosticConsumer::HandleDiagnostic(DiagLevel, Info);
+    Diags.push_back(StoredDiagnostic(DiagLevel, Info));
+  }
+
+  /// Replays the buffered diagnostics. Must be called while the source
+  /// manager they refer to is still alive.
+  void flush() {
+    if (Diags.empty())
+      return;
+
+    std::lock_guard<std::mutex> Lock(Mutex);
+    DiagnosticsEngine Engine(new DiagnosticIDs, new DiagnosticOptions,
+                             &Consumer, /*ShouldOwnClient=*/false);
+    if (LangOpts)
+      Consumer.BeginSourceFile(*LangOpts, PP);
+    for (const StoredDiagnostic &Diag : Diags) {
+      if (Diag.getLocation().isValid())
+        Engine.setSourceManager(&Diag.getLocation().getManager());
+      Engine.Report(Diag);
+    }
+    if (LangOpts)
+      Consumer.EndSourceFile();
+    Diags.clear();
+  }
+};
+
+/// A compile command which is ready to be run by ClangTool::runParallel.
+struct ParallelToolJob {
+  std::string File;
+  std::string Directory;
+  std::vector<std::string> CommandLine;
+};
+
+} // end anonymous namespace
+
+int ClangTool::runParallel(ToolAction *Action, unsigned ThreadCount) {
+  // Exists solely for the purpose of lookup of the resource path.
+  // This just needs to be some symbol in the binary.
+  static int StaticSymbol;
+
+  if (ThreadCount == 0)
+    ThreadCount = std::max(1u, std::thread::hardware_concurrency());
+
+  // Looking up compile commands may change the state of the file system (see
+  // run()), and argument adjusters need not be thread-safe, so prepare all
+  // command lines on this thread before any tool invocation starts.
+  std::vector<ParallelToolJob> Jobs;
+  for (const auto &SourcePath : SourcePaths) {
+    std::string File(getAbsolutePath(SourcePath));
+    std::vector<CompileCommand> CompileCommandsForFile =
+        Compilations.getCompileCommands(File);
+    if (CompileCommandsForFile.empty()) {
+      llvm::errs() << "Skipping " << File << ". Compile command not found.\n";
+      continue;
+    }
+    for (CompileCommand &CompileCommand : CompileCommandsForFile) {
+      std::vector<std::string> CommandLine = CompileCommand.CommandLine;
+      if (ArgsAdjuster)
+        CommandLine = ArgsAdjuster(CommandLine, CompileCommand.Filename);
+      assert(!CommandLine.empty());
+      injectResourceDir(CommandLine, "clang_tool", &StaticSymbol);
+      // run() changes into the command's directory, which is process-wide,
+      // so let the driver and the frontend resolve relative paths instead.
+      CommandLine.insert(CommandLine.begin() + 1,
+                         "-working-directory=" + CompileCommand.Directory);
+      Jobs.push_back(
+          {File, std::move(CompileCommand.Directory), std::move(CommandLine)});
+    }
+  }
+
+  IntrusiveRefCntPtr<SharedStatCache> StatCache(new SharedStatCache);
+  std::mutex DiagMutex, OutputMutex;
+  std::atomic<unsigned> NextJob(0);
+  std::atomic<bool> ProcessingFailed(false);
+
+  // The chdir performed by run() is process-wide, so workers instead resolve
+  // relative paths through the working directory of their FileManager, which
+  // matches the -working-directory added to each command line.
+  auto Worker = [&] {
+    IntrusiveRefCntPtr<vfs::OverlayFileSystem> WorkerFS(
+        new vfs::OverlayFileSystem(vfs::getRealFileSystem()));
+    IntrusiveRefCntPtr<vfs::InMemoryFileSystem> WorkerMemFS(
+        new vfs::InMemoryFileSystem);
+    WorkerFS->pushOverlay(WorkerMemFS);
+    for (const auto &MappedFile : MappedFileContents)
+      if (llvm::sys::path::is_absolute(MappedFile.first))
+        WorkerMemFS->addFile(
+            MappedFile.first, 0,
+            llvm::MemoryBuffer::getMemBuffer(MappedFile.second));
+
+    llvm::StringSet<> WorkerDirectories;
+    IntrusiveRefCntPtr<FileManager> WorkerFiles;
+    for (unsigned I = NextJob++; I < Jobs.size(); I = NextJob++) {
+      ParallelToolJob &Job = Jobs[I];
+
+      if (WorkerDirectories.insert(Job.Directory).second)
+        for (const auto &MappedFile : MappedFileContents)
+          if (!llvm::sys::path::is_absolute(MappedFile.first)) {
+            SmallString<128> Path(Job.Directory);
+            llvm::sys::path::append(Path, MappedFile.first);
+            WorkerMemFS->addFile(
+                Path, 0, llvm::MemoryBuffer::getMemBuffer(MappedFile.second));
+          }
+
+      // Entries for relative paths are only valid for one working directory.
+      if (!WorkerFiles ||
+          WorkerFiles->getFileSystemOpts().WorkingDir != Job.Directory) {
+        FileSystemOptions FileSystemOpts;
+        FileSystemOpts.WorkingDir = Job.Directory;
+        WorkerFiles = new FileManager(FileSystemOpts, WorkerFS);
+        WorkerFiles->setSharedStatCache(StatCache);
+      }
+
+      // Without a user-provided consumer, buffer the diagnostics of each
+      // translation unit so they are not interleaved with those of others.
+      std::string DiagBuffer;
+      llvm::raw_string_ostream DiagOS(DiagBuffer);
+      IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+      TextDiagnosticPrinter DiagPrinter(DiagOS, &*DiagOpts);
+      std::unique_ptr<BufferedDiagnosticConsumer> BufferedConsumer;
+      if (DiagConsumer)
+        BufferedConsumer =
+            llvm::make_unique<BufferedDiagnosticConsumer>(*DiagConsumer,
+                                                          DiagMutex);
+
+      DEBUG({ llvm::dbgs() << "Processing: " << Job.File << ".\n"; });
+      ToolInvocation Invocation(std::move(Job.CommandLine), Action,
+                                WorkerFiles.get(), PCHContainerOps);
+      if (BufferedConsumer)
+        Invocation.setDiagnosticConsumer(BufferedConsumer.get());
+      else
+        Invocation.setDiagnosticConsumer(&DiagPrinter);
+      bool Success = Invocation.run();
+      if (!Success)
+        ProcessingFailed = true;
+      // Only diagnostics reported outside a source file, e.g. by the driver,
+      // can still be buffered here.
+      if (BufferedConsumer)
+        BufferedConsumer->flush();
+
+      DiagOS.flush();
+      if (!DiagBuffer.empty() || !Success) {
+        std::lock_guard<std::mutex> Lock(OutputMutex);
+        llvm::errs() << DiagBuffer;
+        if (!Success)
+          llvm::errs() << "Error while processing " << Job.File << ".\n";
+      }
+    }
+  };
+
+  llvm::ThreadPool Pool(ThreadCount);
+  for (unsigned I = 0; I != ThreadCount; ++I)
+    Pool.async(Worker);
+  Pool.wait();
+
+  return ProcessingFailed ? 1 : 0;
+}
+
+namespace {
+
 class ASTBuilderAction : public ToolAction {
   std::vector<std::unique_ptr<ASTUnit>> &ASTs;
 
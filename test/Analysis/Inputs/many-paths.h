@@ -0,0 +1,23 @@
+// Ten independent branches over ten parameters, for tests that need a
+// function with 2^10 distinct paths through it.  Summing the parameters at
+// the end keeps every one of them alive, so that no two paths merge.
+
+#define MANY_PATHS_PARAMS                                                     \
+  int x1, int x2, int x3, int x4, int x5,                                     \
+  int x6, int x7, int x8, int x9, int x10
+
+#define MANY_PATHS_ARGS x1, x2, x3, x4, x5, x6, x7, x8, x9, x10
+
+#define MANY_PATHS_BRANCHES(r)                                                \
+  if (x1) r += 1; else r -= 1;                                                \
+  if (x2) r += 1; else r -= 1;                                                \
+  if (x3) r += 1; else r -= 1;                                                \
+  if (x4) r += 1; else r -= 1;                                                \
+  if (x5) r += 1; else r -= 1;                                                \
+  if (x6) r += 1; else r -= 1;                                                \
+  if (x7) r += 1; else r -= 1;                                                \
+  if (x8) r += 1; else r -= 1;                                                \
+  if (x9) r += 1; else r -= 1;                                                \
+  if (x10) r += 1; else r -= 1
+
+#define MANY_PATHS_SUM (x1 + x2 + x3 + x4 + x5 + x6 + x7 + x8 + x9 + x10)
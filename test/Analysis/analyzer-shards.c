@@ -0,0 +1,76 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,deadcode.DeadStores %s \
+// RUN:   2>&1 | FileCheck %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,deadcode.DeadStores %s \
+// RUN:   2>&1 | grep warning: | count 9
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,deadcode.DeadStores %s \
+// RUN:   -analyzer-config shard-count=3,shard-index=0 > %t.0 2>&1
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,deadcode.DeadStores %s \
+// RUN:   -analyzer-config shard-count=3,shard-index=1 > %t.1 2>&1
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,deadcode.DeadStores %s \
+// RUN:   -analyzer-config shard-count=3,shard-index=2 > %t.2 2>&1
+// RUN: cat %t.0 %t.1 %t.2 | FileCheck %s
+// RUN: cat %t.0 %t.1 %t.2 | grep warning: | sort -u | count 9
+
+// However the functions are divided up, the shards between them report
+// every issue that a single process does.  A shard reports what it finds
+// while analyzing its own top-level functions, including in the callees
+// they inline.  So the issue in 'store_through', which is only found
+// through 'pass_null', is reported by whichever shard has 'pass_null'.  The
+// issue in 'callee' is found both through 'caller' and on its own, so two
+// shards may report it, and merging the output removes the duplicate.
+
+// RUN: not %clang_cc1 -analyze -analyzer-checker=core %s \
+// RUN:   -analyzer-config shard-count=3,shard-index=3 2>&1 \
+// RUN:   | FileCheck -check-prefix=INVALID %s
+// INVALID: error: analyzer-config option 'shard-index=3' is not less than 'shard-count=3'
+
+// CHECK-DAG: warning: Value stored to 'first_unused' is never read
+// CHECK-DAG: warning: Value stored to 'second_unused' is never read
+// CHECK-DAG: warning: Value stored to 'third_unused' is never read
+// CHECK-DAG: warning: Dereference of null pointer (loaded from variable 'first_ptr')
+// CHECK-DAG: warning: Dereference of null pointer (loaded from variable 'second_ptr')
+// CHECK-DAG: warning: Dereference of null pointer (loaded from variable 'third_ptr')
+// CHECK-DAG: warning: Dereference of null pointer (loaded from variable 'callee_ptr')
+// CHECK-DAG: warning: Dereference of null pointer (loaded from variable 'p')
+// CHECK-DAG: warning: Division by zero
+
+void first() {
+  int *first_ptr = 0;
+  int first_unused;
+  first_unused = 1;
+  *first_ptr = 1;
+}
+
+void second() {
+  int *second_ptr = 0;
+  int second_unused;
+  second_unused = 1;
+  *second_ptr = 1;
+}
+
+void third() {
+  int *third_ptr = 0;
+  int third_unused;
+  third_unused = 1;
+  *third_ptr = 1;
+}
+
+void callee(int x) {
+  int *callee_ptr = 0;
+  if (x)
+    *callee_ptr = 1;
+}
+
+int caller(int y) {
+  int zero = 0;
+  callee(1);
+  return y / zero;
+}
+
+void store_through(int *p) {
+  *p = 1;
+}
+
+void pass_null() {
+  store_through(0);
+}
@@ -0,0 +1,21 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.Stats -analyzer-config exploration-strategy=dfs,max-nodes=1000 -DDFS -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.Stats -analyzer-config exploration-strategy=unexplored-first,max-nodes=1000 -DUNEXPLORED_FIRST -verify %s
+
+// Every path through 'branches' is different, so there are 2^10 of them.
+// With a budget of 1000 steps, DFS is still working through the paths that
+// share the first branch it took when it runs out.  Preferring the paths
+// that reach new blocks covers all of the function with the same budget.
+
+#include "Inputs/many-paths.h"
+
+#ifdef DFS
+// expected-warning-re@+5{{branches -> Total CFGBlocks: {{[0-9]+}} | Unreachable CFGBlocks: {{[1-9][0-9]*}} | Exhausted Block: no | Empty WorkList: no}}
+#else
+// expected-warning-re@+3{{branches -> Total CFGBlocks: {{[0-9]+}} | Unreachable CFGBlocks: 0 | Exhausted Block: no | Empty WorkList: no}}
+#endif
+
+int branches(MANY_PATHS_PARAMS) {
+  int r = 0;
+  MANY_PATHS_BRANCHES(r);
+  return r + MANY_PATHS_SUM;
+}
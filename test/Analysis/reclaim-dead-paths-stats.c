@@ -0,0 +1,25 @@
+// REQUIRES: asserts
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-stats \
+// RUN:   -analyzer-config reclaim-dead-paths=true -verify %s 2>&1 \
+// RUN:   | FileCheck %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-stats \
+// RUN:   -verify %s 2>&1 | FileCheck -check-prefix=OFF %s
+
+// The paths that end without a report are removed from the graph once it is
+// big enough, and only when the option is set.
+
+// CHECK: ... Statistics Collected ...
+// CHECK: {{[1-9][0-9]*}} CoreEngine - The # of nodes removed because they reached no report
+// OFF: ... Statistics Collected ...
+// OFF-NOT: nodes removed because they reached no report
+
+#include "Inputs/many-paths.h"
+
+int manyPaths(MANY_PATHS_PARAMS) {
+  int *p = 0;
+  int r = 0;
+  MANY_PATHS_BRANCHES(r);
+  if (r == 10)
+    return *p; // expected-warning{{Dereference of null pointer (loaded from variable 'p')}}
+  return r + MANY_PATHS_SUM;
+}
@@ -0,0 +1,25 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config reclaim-dead-paths=true -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config reclaim-dead-paths=true,exploration-strategy=bfs -verify %s
+
+// There are 2^10 distinct paths through 'manyPaths', enough for the graph to
+// be swept several times.  Most of them end without a report, and only one
+// of them reaches the null dereference.
+
+#include "Inputs/many-paths.h"
+
+int manyPaths(MANY_PATHS_PARAMS) {
+  int *p = 0;
+  int r = 0;
+  MANY_PATHS_BRANCHES(r);
+  if (r == 10)
+    return *p; // expected-warning{{Dereference of null pointer (loaded from variable 'p')}}
+  return r + MANY_PATHS_SUM;
+}
+
+// A report found before a sweep keeps the path that leads to it.
+void earlyReport(MANY_PATHS_PARAMS) {
+  int *p = 0;
+  if (x1 == 42)
+    *p = 1; // expected-warning{{Dereference of null pointer (loaded from variable 'p')}}
+  manyPaths(MANY_PATHS_ARGS);
+}
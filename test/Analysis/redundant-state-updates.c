@@ -0,0 +1,24 @@
+// REQUIRES: asserts
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-stats -verify %s 2>&1 | FileCheck %s
+
+void clang_analyzer_eval(int);
+
+void rebind(int n) {
+  int x = 0;
+  for (int i = 0; i < n; ++i)
+    x = 0;
+  clang_analyzer_eval(x == 0); // expected-warning{{TRUE}}
+}
+
+void reassume(int n) {
+  if (n > 0) {
+    if (n > 0)
+      clang_analyzer_eval(n > 0); // expected-warning{{TRUE}}
+    else
+      clang_analyzer_eval(0); // no-warning
+  }
+}
+
+// CHECK: ... Statistics Collected ...
+// CHECK-DAG: {{[0-9]+}} RangeConstraintManager - The # of assumptions that did not change a symbol's range
+// CHECK-DAG: {{[0-9]+}} RegionStore - The # of bindings that stored the value already bound
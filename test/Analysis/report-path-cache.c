@@ -0,0 +1,38 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-output=plist \
+// RUN:   -o %t.plist -verify %s
+// RUN: FileCheck --input-file=%t.plist %s
+
+// The compiler's own diagnostics and the plist file each ask for a path for
+// the same report.  The shortest path goes through getNull(), and is
+// suppressed while the first path is built.  The plist file has to get the
+// longer path that was kept, not the suppressed one.
+
+int *getNull() {
+  return 0;
+}
+
+void test(int coin) {
+  int *p;
+  if (coin) {
+    p = getNull();
+  } else {
+    int i = 0;
+    ++i;
+    ++i;
+    ++i;
+    ++i;
+    ++i;
+    ++i;
+    ++i;
+    ++i;
+    p = 0;
+  }
+  *p = 1; // expected-warning{{Dereference of null pointer (loaded from variable 'p')}}
+}
+
+// CHECK: <key>diagnostics</key>
+// CHECK-NOT: getNull
+// CHECK: <string>Null pointer value stored to &apos;p&apos;</string>
+// CHECK-NOT: getNull
+// CHECK: <key>description</key><string>Dereference of null pointer (loaded from variable &apos;p&apos;)</string>
+// CHECK-NOT: <key>description</key>
@@ -0,0 +1,53 @@
+// REQUIRES: x86-registered-target
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj %s -o %t.0.o \
+// RUN:     -parallel-codegen-output %t.1.o -parallel-codegen-output %t.2.o
+// RUN: llvm-nm -defined-only %t.0.o %t.1.o %t.2.o | FileCheck %s
+
+// Every definition ends up in exactly one partition, and static functions
+// stay local.
+// CHECK-DAG: T alpha
+// CHECK-DAG: T beta
+// CHECK-DAG: T delta
+// CHECK-DAG: t helper
+// CHECK-DAG: D counter
+
+// Backend diagnostics from the partitions reach the frontend, with their
+// source locations.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj %s -o %t.0.o \
+// RUN:     -parallel-codegen-output %t.1.o -parallel-codegen-output %t.2.o \
+// RUN:     -mllvm -warn-stack-size=0 2>&1 | FileCheck -check-prefix=STACK %s
+// STACK-DAG: warning: stack frame size of {{[0-9]+}} bytes in function 'alpha'
+// STACK-DAG: warning: stack frame size of {{[0-9]+}} bytes in function 'beta'
+// STACK-DAG: warning: stack frame size of {{[0-9]+}} bytes in function 'delta'
+
+// RUN: not %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj %s \
+// RUN:     -o %t.0.o -parallel-codegen-output %t.1.o -DBAD_ASM 2>&1 \
+// RUN:   | FileCheck -check-prefix=BAD-ASM %s
+// BAD-ASM: parallel-codegen.c:[[@LINE+11]]:{{[0-9]+}}: error: invalid instruction mnemonic 'abc'
+
+// Module-level asm can refer to locals, so it stays with the rest of the
+// module in the first partition.
+// RUN: %clang_cc1 -triple x86_64-unknown-linux-gnu -emit-obj %s -o %t.0.o \
+// RUN:     -parallel-codegen-output %t.1.o -DMODULE_ASM
+// RUN: llvm-nm -defined-only %t.0.o | FileCheck -check-prefix=MODULE-ASM %s
+// RUN: llvm-nm -defined-only %t.1.o \
+// RUN:   | FileCheck -allow-empty -check-prefix=EMPTY %s
+// EMPTY-NOT: {{ [TtDd] }}
+#ifdef BAD_ASM
+void bad(int x) { __asm__("abc incl %0" : "+r"(x)); }
+#endif
+
+#ifdef MODULE_ASM
+__asm__(".globl from_asm\nfrom_asm:\n  jmp helper\n");
+// MODULE-ASM-DAG: T alpha
+// MODULE-ASM-DAG: T from_asm
+// MODULE-ASM-DAG: t helper
+#endif
+
+int counter = 1;
+
+static int helper(int x) { return x * counter; }
+
+int alpha(int x) { return helper(x) + 1; }
+int beta(int x) { return helper(x) + 2; }
+int delta(int x) { return x - counter; }
@@ -0,0 +1,19 @@
+// RUN: %clang -### -c -ftime-trace %s -o %t/out.o 2>&1 \
+// RUN:   | FileCheck -check-prefix=OBJECT %s
+// OBJECT: "-cc1"
+// OBJECT-SAME: "-ftime-trace={{.*}}out.json"
+
+// RUN: %clang -### -fsyntax-only -ftime-trace %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=SYNTAX %s
+// SYNTAX: "-cc1"
+// SYNTAX-SAME: "-ftime-trace=ftime-trace.json"
+
+// RUN: %clang -### -c -ftime-trace=%t.trace.json \
+// RUN:   -ftime-trace-granularity=0 %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=EXPLICIT %s
+// EXPLICIT: "-cc1"
+// EXPLICIT-SAME: "-ftime-trace={{.*}}.trace.json"
+// EXPLICIT-SAME: "-ftime-trace-granularity=0"
+
+// RUN: %clang -### -c %s 2>&1 | FileCheck -check-prefix=NONE %s
+// NONE-NOT: -ftime-trace
@@ -0,0 +1,21 @@
+// RUN: %clang -target x86_64-unknown-linux -### -c -fparallel-codegen=3 %s \
+// RUN:     -o %t.o 2>&1 | FileCheck %s
+// CHECK: "-cc1"
+// CHECK-SAME: "-o" "[[P0:[^"]+]]"
+// CHECK-SAME: "-parallel-codegen-output" "[[P1:[^"]+]]"
+// CHECK-SAME: "-parallel-codegen-output" "[[P2:[^"]+]]"
+// CHECK-NEXT: ld{{(.exe)?}}" "-r" "-o" "{{[^"]*}}.o" "[[P0]]" "[[P1]]" "[[P2]]"
+
+// One thread, assembly output and COFF targets compile as usual.
+// RUN: %clang -target x86_64-unknown-linux -### -c -fparallel-codegen=1 %s \
+// RUN:     2>&1 | FileCheck -check-prefix=SERIAL %s
+// RUN: %clang -target x86_64-unknown-linux -### -S -fparallel-codegen=4 %s \
+// RUN:     2>&1 | FileCheck -check-prefix=SERIAL %s
+// RUN: %clang -target x86_64-pc-windows-msvc -### -c -fparallel-codegen=4 %s \
+// RUN:     2>&1 | FileCheck -check-prefix=SERIAL %s
+// SERIAL-NOT: "-parallel-codegen-output"
+// SERIAL-NOT: "-r"
+
+// RUN: %clang -target x86_64-unknown-linux -### -c -fparallel-codegen=0 %s \
+// RUN:     2>&1 | FileCheck -check-prefix=INVALID %s
+// INVALID: invalid integral value '0' in '-fparallel-codegen=0'
@@ -0,0 +1,36 @@
+// REQUIRES: x86-registered-target
+
+// RUN: %clang -parallel-jobs=4 -fsyntax-only %s %S/Inputs/parallel-jobs-b.c \
+// RUN:   2>&1 | FileCheck %s
+// RUN: %clang -j 4 -fsyntax-only %s %S/Inputs/parallel-jobs-b.c \
+// RUN:   2>&1 | FileCheck %s
+// CHECK: parallel-jobs.c:[[@LINE+2]]:2: warning: first input
+// CHECK: parallel-jobs-b.c:1:2: warning: second input
+#warning first input
+
+// A failing job does not prevent the diagnostics of jobs that already ran
+// from being reported.
+// RUN: not %clang -j2 -fsyntax-only -DFAIL %s %S/Inputs/parallel-jobs-b.c \
+// RUN:   2>&1 | FileCheck -check-prefix=FAIL %s
+// FAIL: parallel-jobs.c:[[@LINE+2]]:2: error: failing input
+#ifdef FAIL
+#error failing input
+#endif
+
+// RUN: not %clang -parallel-jobs=0 -fsyntax-only %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=INVALID %s
+// RUN: not %clang -parallel-jobs=x -fsyntax-only %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=INVALID %s
+// INVALID: error: invalid integral value '{{.*}}' in '-parallel-jobs={{.*}}'
+
+// RUN: %clang -target x86_64-unknown-linux -parallel-jobs=2 -c %s -### 2>&1 \
+// RUN:   | FileCheck -check-prefix=UNUSED %s
+// UNUSED-NOT: argument unused
+
+// A failed compile stops the link that depends on it.
+// RUN: not %clang -target x86_64-unknown-linux -j2 -v -DFAIL %s \
+// RUN:   %S/Inputs/parallel-jobs-b.c -o %t.exe 2>&1 \
+// RUN:   | FileCheck -check-prefix=NOLINK %s
+// NOLINK-NOT: "-o" "{{[^"]*}}.tmp.exe"
+// NOLINK: error: failing input
+// NOLINK-NOT: "-o" "{{[^"]*}}.tmp.exe"
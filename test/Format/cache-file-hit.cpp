@@ -0,0 +1,16 @@
+// REQUIRES: asserts
+// RUN: rm -f %t.cache
+// RUN: echo 'int *i;' > %t-1.cpp
+// RUN: clang-format -style=LLVM -cache-file=%t.cache \
+// RUN:   -debug-only=format-formatter %t-1.cpp 2>&1 \
+// RUN:   | FileCheck -check-prefix=MISS %s
+// RUN: clang-format -style=LLVM -cache-file=%t.cache \
+// RUN:   -debug-only=format-formatter %t-1.cpp 2>&1 \
+// RUN:   | FileCheck -check-prefix=HIT %s
+
+// The first run formats the file and records it.  The second one finds it
+// in the cache, and neither sorts its includes nor formats it.
+// MISS: Language: C++
+// HIT-NOT: Language:
+// HIT: {{^int \*i;}}
+// HIT-NOT: Language:
@@ -0,0 +1,23 @@
+// RUN: rm -f %t.cache
+// RUN: cp %s %t-1.cpp
+// RUN: clang-format -style=LLVM -i -cache-file=%t.cache %t-1.cpp
+// RUN: FileCheck -strict-whitespace -input-file=%t-1.cpp %s
+
+// The file had to be changed, so it wasn't recorded.
+// RUN: not test -f %t.cache
+
+// Now it is formatted, and gets recorded.
+// RUN: clang-format -style=LLVM -i -cache-file=%t.cache %t-1.cpp
+// RUN: test -f %t.cache
+// RUN: clang-format -style=LLVM -output-replacements-xml \
+// RUN:   -cache-file=%t.cache %t-1.cpp | FileCheck -check-prefix=XML %s
+
+// RUN: not clang-format -style=LLVM -cache-file=%t.cache -lines=1:2 %t-1.cpp \
+// RUN:   2>&1 | FileCheck -check-prefix=ERROR %s
+
+// CHECK: {{^int\ \*i;}}
+// XML: <?xml
+// XML-NEXT: {{<replacements.*incomplete_format='false'}}
+// XML-NEXT: </replacements>
+// ERROR: error: -cache-file can't be used with -offset, -length, -lines
+ int   *  i  ;
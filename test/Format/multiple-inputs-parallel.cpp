@@ -0,0 +1,31 @@
+// RUN: echo ' int   *  a  ;' > %t-1.cpp
+// RUN: echo ' int   *  b  ;' > %t-2.cpp
+// RUN: echo ' int   *  c  ;' > %t-3.cpp
+// RUN: clang-format -style=LLVM -j 2 %t-1.cpp %t-2.cpp %t-3.cpp \
+// RUN:   | FileCheck -strict-whitespace %s
+
+// The results come out in the order of the inputs.
+// CHECK: {{^int\ \*a;}}
+// CHECK-NEXT: {{^int\ \*b;}}
+// CHECK-NEXT: {{^int\ \*c;}}
+
+// Problems with the style of each file are reported in the order of the
+// inputs too.
+// RUN: rm -rf %t.dir
+// RUN: mkdir -p %t.dir/bad1 %t.dir/good %t.dir/bad2
+// RUN: echo 'ColumnLimit: bad1' > %t.dir/bad1/.clang-format
+// RUN: echo 'ColumnLimit: bad2' > %t.dir/bad2/.clang-format
+// RUN: echo 'int a;' > %t.dir/bad1/a.cpp
+// RUN: echo 'int b;' > %t.dir/good/b.cpp
+// RUN: echo 'int c;' > %t.dir/bad2/c.cpp
+// RUN: clang-format -style=file -j 3 %t.dir/bad1/a.cpp %t.dir/good/b.cpp \
+// RUN:   %t.dir/bad2/c.cpp 2>&1 >/dev/null \
+// RUN:   | FileCheck -check-prefix=ERRORS %s
+
+// ERRORS: error: invalid number
+// ERRORS-NEXT: ColumnLimit: bad1
+// ERRORS: Error reading {{.*}}bad1{{/|\\}}.clang-format
+// ERRORS-NOT: bad1
+// ERRORS: error: invalid number
+// ERRORS-NEXT: ColumnLimit: bad2
+// ERRORS: Error reading {{.*}}bad2{{/|\\}}.clang-format
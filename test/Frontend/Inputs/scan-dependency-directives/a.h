@@ -0,0 +1,6 @@
+#ifndef A_H
+#define A_H
+// #include "not-a-dependency.h"
+#include "b.h"
+struct A { int member; };
+#endif
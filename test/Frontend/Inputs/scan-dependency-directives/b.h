@@ -0,0 +1,5 @@
+#pragma once
+#if USE_C
+#include "c.h"
+#endif
+static const char *text = "#include \"not-a-dependency.h\"";
@@ -0,0 +1,2 @@
+/* Only included when USE_C is set. */
+int c;
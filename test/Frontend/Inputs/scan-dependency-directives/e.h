@@ -0,0 +1 @@
+int in_system_header;
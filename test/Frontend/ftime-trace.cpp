@@ -0,0 +1,16 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-linux -emit-llvm -o %t.ll \
+// RUN:   -ftime-trace=%t.json -ftime-trace-granularity=0 -I %S/Inputs %s
+// RUN: FileCheck %s < %t.json
+
+// CHECK: "traceEvents":[
+// CHECK-DAG: "name":"Source","args":{"detail":"{{.*}}ftime-trace.h"}
+// CHECK-DAG: "name":"InstantiateFunction","args":{"detail":"square{{.*}}"}
+// CHECK-DAG: "name":"CodeGen Function","args":{"detail":"use"}
+// CHECK-DAG: "name":"Backend"
+// CHECK-DAG: "name":"ExecuteAction"
+// CHECK-DAG: "name":"Total Source"
+// CHECK: "name":"process_name"
+
+#include "ftime-trace.h"
+
+int use(int X) { return square(X); }
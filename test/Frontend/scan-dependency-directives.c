@@ -0,0 +1,41 @@
+// RUN: %clang_cc1 -scan-dependency-directives -dependency-file %t.d -MT out.o \
+// RUN:   -I %S/Inputs/scan-dependency-directives %s
+// RUN: FileCheck %s < %t.d
+// RUN: %clang_cc1 -scan-dependency-directives -dependency-file %t.c.d \
+// RUN:   -MT out.o -I %S/Inputs/scan-dependency-directives -DUSE_C %s
+// RUN: FileCheck %s -check-prefix=USE_C < %t.c.d
+
+// The dependencies match those of full preprocessing.
+// RUN: %clang_cc1 -Eonly -dependency-file %t.full.d -MT out.o \
+// RUN:   -I %S/Inputs/scan-dependency-directives %s
+// RUN: diff %t.d %t.full.d
+
+// Headers included from a system header are left out, as with -MM.
+// RUN: %clang_cc1 -scan-dependency-directives -dependency-file %t.sys.d \
+// RUN:   -MT out.o -I %S/Inputs/scan-dependency-directives -DUSE_SYS %s
+// RUN: FileCheck %s -check-prefix=USE_SYS < %t.sys.d
+// RUN: %clang_cc1 -Eonly -dependency-file %t.sys.full.d -MT out.o \
+// RUN:   -I %S/Inputs/scan-dependency-directives -DUSE_SYS %s
+// RUN: diff %t.sys.d %t.sys.full.d
+
+// RUN: %clang -### -M -fscan-dependency-directives %s 2>&1 \
+// RUN:   | FileCheck %s -check-prefix=DRIVER
+
+#include "a.h"
+#include "a.h"
+#ifdef USE_SYS
+#include "d.h"
+#endif
+
+// CHECK: out.o: {{.*}}scan-dependency-directives.c
+// CHECK-NEXT: a.h
+// CHECK-NEXT: b.h
+// CHECK-NOT: .h
+
+// USE_C: c.h
+
+// USE_SYS: d.h
+// USE_SYS-NOT: e.h
+
+// DRIVER: "-scan-dependency-directives"
+// DRIVER-NOT: "-Eonly"
@@ -0,0 +1 @@
+struct Shared { int value; };
@@ -0,0 +1,3 @@
+#include "header.h"
+
+void a_func(Shared s) {}
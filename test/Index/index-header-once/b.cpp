@@ -0,0 +1,3 @@
+#include "header.h"
+
+int b_func() { return shared_func(0); }
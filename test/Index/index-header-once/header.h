@@ -0,0 +1,8 @@
+#ifndef HEADER_H
+#define HEADER_H
+
+struct Shared {};
+
+int shared_func(int);
+
+#endif
@@ -0,0 +1,15 @@
+#include "preamble-cache.h"
+
+int get(struct Shared *s) { return s->value; }
+
+// The first process precompiles the preamble and stores it in the cache.
+// RUN: rm -rf %t
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_PREAMBLE_CACHE=%t LIBCLANG_TIMING=1 c-index-test -test-load-source local %s -I %S/Inputs 2>&1 | FileCheck -check-prefix=BUILD %s
+// BUILD: Precompiling preamble
+
+// A second process reuses it instead of precompiling its own.
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_PREAMBLE_CACHE=%t LIBCLANG_TIMING=1 c-index-test -test-load-source local %s -I %S/Inputs 2>&1 | FileCheck -check-prefix=REUSE %s
+// REUSE-NOT: Precompiling preamble
+// REUSE: Loading preamble from cache
+// REUSE-NOT: Precompiling preamble
+// REUSE: FunctionDecl=get:3:5 (Definition)
@@ -0,0 +1,47 @@
+// RUN: %clang_cc1 -print-dependency-directives-minimized-source %s 2>&1 \
+// RUN:   | FileCheck %s
+
+// Comments mentioning #include "nope.h" are dropped.
+/* As are block comments
+#include "nope2.h"
+*/ #include "a.h"
+#ifndef GUARD
+#define GUARD
+#include <sys//weird.h> // trailing comment
+#define F(x) \
+  do { x; } /* comment */ while (0)
+#define G /**/(y)
+int x = 1; char c = '"'; const char *s = "#include \"no.h\"";
+  #  if defined(FOO) && \
+   BAR
+#include_next <b.h>
+#pragma once
+#pragma GCC diagnostic push
+#pragma GCC system_header
+#pragma clang system_header
+#pragma clang diagnostic pop
+#pragma clang module import Foo
+#error do not get here
+%:include "digraph.h"
+#endif
+@import Foo.Bar;
+#endif
+
+// CHECK-NOT: nope
+// CHECK:      {{^}}#include "a.h"{{$}}
+// CHECK-NEXT: {{^}}#ifndef GUARD{{$}}
+// CHECK-NEXT: {{^}}#define GUARD{{$}}
+// CHECK-NEXT: {{^}}#include <sys//weird.h>{{$}}
+// CHECK-NEXT: {{^}}#define F(x) do { x; } while (0){{$}}
+// CHECK-NEXT: {{^}}#define G (y){{$}}
+// CHECK-NEXT: {{^}}#if defined(FOO) && BAR{{$}}
+// CHECK-NEXT: {{^}}#include_next <b.h>{{$}}
+// CHECK-NEXT: {{^}}#pragma once{{$}}
+// CHECK-NEXT: {{^}}#pragma GCC system_header{{$}}
+// CHECK-NEXT: {{^}}#pragma clang system_header{{$}}
+// CHECK-NEXT: {{^}}#pragma clang module import Foo{{$}}
+// CHECK-NEXT: {{^}}#include "digraph.h"{{$}}
+// CHECK-NEXT: {{^}}#endif{{$}}
+// CHECK-NEXT: {{^}}@import Foo.Bar;{{$}}
+// CHECK-NEXT: {{^}}#endif{{$}}
+// CHECK-NOT: {{.}}
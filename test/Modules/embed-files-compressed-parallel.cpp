@@ -0,0 +1,17 @@
+// REQUIRES: zlib
+//
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: echo 'extern int a;' > %t/a.h
+// RUN: echo 'extern int b;' > %t/b.h
+// RUN: echo 'extern int c;' > %t/c.h
+// RUN: echo 'extern int d;' > %t/d.h
+// RUN: echo 'module m { header "a.h" header "b.h" header "c.h" header "d.h" }' > %t/modulemap
+//
+// Compressing the embedded files on several threads gives the same module
+// file as compressing them one after the other.
+//
+// RUN: %clang_cc1 -fmodules -I%t -fmodules-cache-path=%t -fmodule-name=m -emit-module %t/modulemap -fmodules-embed-all-files -fmodule-format=raw -o %t/m.pcm
+// RUN: mv %t/m.pcm %t/serial.pcm
+// RUN: %clang_cc1 -fmodules -I%t -fmodules-cache-path=%t -fmodule-name=m -emit-module %t/modulemap -fmodules-embed-all-files -fmodule-format=raw -ast-compression-threads=4 -o %t/m.pcm
+// RUN: diff %t/serial.pcm %t/m.pcm
@@ -0,0 +1,27 @@
+// REQUIRES: asserts
+// RUN: rm -rf %t
+// Create the global module index with a single module.
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -fimplicit-module-maps -F %S/Inputs %s -verify -DIMPORT_MODULE
+// RUN: ls %t | grep modules.idx
+// Add a module to the cache; the index is updated without reloading Module.
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -fimplicit-module-maps -F %S/Inputs %s -verify -DIMPORT_DEPENDS -print-stats 2>&1 | FileCheck -check-prefix=UPDATE %s
+// Use the updated index, which must know about both modules.
+// RUN: %clang_cc1 -fmodules-cache-path=%t -fdisable-module-hash -fmodules -fimplicit-module-maps -F %S/Inputs %s -verify -DIMPORT_MODULE -DIMPORT_DEPENDS -print-stats 2>&1 | FileCheck %s
+
+// expected-no-diagnostics
+#ifdef IMPORT_MODULE
+@import Module;
+#endif
+#ifdef IMPORT_DEPENDS
+@import DependsOnModule;
+#endif
+
+// CHECK: *** Global Module Index Statistics:
+
+// UPDATE: {{[1-9][0-9]*}} global-module-index - Number of module files carried over from an existing global index
+
+#ifdef IMPORT_MODULE
+int *get_sub() {
+  return Module_Sub;
+}
+#endif
@@ -0,0 +1,21 @@
+// An @implementation from a PCH is still loaded by -fsyntax-only, so that a
+// second implementation of the same class is diagnosed.
+
+// RUN: %clang_cc1 -emit-pch -o %t %s
+// RUN: %clang_cc1 -include-pch %t -fsyntax-only -verify %s
+
+#ifndef HEADER
+#define HEADER
+
+@interface Foo
+@end
+
+@implementation Foo
+@end
+
+#else
+
+@implementation Foo // expected-error{{reimplementation of class 'Foo'}}
+@end
+
+#endif
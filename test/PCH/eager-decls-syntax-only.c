@@ -0,0 +1,28 @@
+// Declarations that are only needed for code generation aren't loaded from a
+// PCH by -fsyntax-only.
+
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-pch -o %t %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include-pch %t \
+// RUN:   -fsyntax-only -print-stats %s 2>&1 | FileCheck -check-prefix=SYNTAX %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include-pch %t \
+// RUN:   -emit-llvm -o - %s | FileCheck -check-prefix=CODEGEN %s
+
+#ifndef HEADER
+#define HEADER
+
+int twice(int x) { return 2 * x; }
+int counter = 3;
+void unused(void) {}
+
+#else
+
+int use(void) { return twice(counter); }
+
+#endif
+
+// SYNTAX: {{[0-9]+}}/{{[0-9]+}} function bodies read
+// SYNTAX: 3 eagerly-deserialized declarations skipped
+
+// CODEGEN-DAG: @counter = global i32 3
+// CODEGEN-DAG: define {{.*}}i32 @twice(
+// CODEGEN-DAG: define {{.*}}void @unused(
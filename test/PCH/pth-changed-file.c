@@ -0,0 +1,16 @@
+// Cached tokens are found by the contents of a file, so a header that changes
+// after the PTH file is generated is lexed again.
+
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: echo 'int before_change;' > %t/header.h
+// RUN: %clang_cc1 -emit-pth -o %t/cache.pth %t/header.h
+// RUN: %clang_cc1 -token-cache %t/cache.pth -E %t/header.h \
+// RUN:   | FileCheck -check-prefix=BEFORE %s
+// RUN: echo 'int after_the_change;' > %t/header.h
+// RUN: %clang_cc1 -token-cache %t/cache.pth -E %t/header.h \
+// RUN:   | FileCheck -check-prefix=AFTER %s
+
+// BEFORE: int before_change;
+// AFTER: int after_the_change;
+// AFTER-NOT: before_change
@@ -0,0 +1,23 @@
+// Cached tokens are found by the contents of a file, so a header reached
+// through a different path than the one it was cached from still uses them.
+// A compilation whose language options lex differently rejects the cache.
+
+// RUN: rm -rf %t
+// RUN: mkdir -p %t/a %t/b
+// RUN: echo 'extern int from_header;' > %t/a/header.h
+// RUN: cp %t/a/header.h %t/b/header.h
+// RUN: %clang_cc1 -emit-pth -o %t/cache.pth %t/a/header.h
+// RUN: %clang_cc1 -token-cache %t/cache.pth -I %t/b -fsyntax-only \
+// RUN:   -print-stats %s 2>&1 | FileCheck %s
+// RUN: not %clang_cc1 -token-cache %t/cache.pth -I %t/b -fsyntax-only \
+// RUN:   -x c++ %s 2>&1 | FileCheck -check-prefix=CXX %s
+
+#include "header.h"
+#include "header.h"
+
+int use(void) { return from_header; }
+
+// CHECK: *** PTH Stats:
+// CHECK-NEXT: 2 files lexed from cached tokens.
+
+// CXX: error: PTH file was generated with incompatible language options
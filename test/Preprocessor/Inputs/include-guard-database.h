@@ -0,0 +1,4 @@
+#ifndef INCLUDE_GUARD_DATABASE_H
+#define INCLUDE_GUARD_DATABASE_H
+int guarded;
+#endif
@@ -0,0 +1,42 @@
+// RUN: rm -f %t.db
+// RUN: %clang_cc1 -E -finclude-guard-database=%t.db -I %S/Inputs %s \
+// RUN:   | FileCheck -check-prefix=ENTERED %s
+// RUN: FileCheck -check-prefix=DB %s < %t.db
+
+// A later compilation that already has the guard defined doesn't enter the
+// header at all.
+// RUN: %clang_cc1 -E -finclude-guard-database=%t.db -I %S/Inputs %s \
+// RUN:   -DINCLUDE_GUARD_DATABASE_H | FileCheck -check-prefix=SKIPPED %s
+
+// The skipped header is still a dependency, and -H still shows it.
+// RUN: %clang_cc1 -E -finclude-guard-database=%t.db -I %S/Inputs %s \
+// RUN:   -DINCLUDE_GUARD_DATABASE_H -dependency-file %t.d -MT out -H \
+// RUN:   -o /dev/null 2>&1 | FileCheck -check-prefix=SHOWN %s
+// RUN: FileCheck -check-prefix=DEPS %s < %t.d
+
+// Relative header paths are resolved against -working-directory rather than
+// the current directory.
+// RUN: cd / && %clang_cc1 -working-directory %S -E \
+// RUN:   -finclude-guard-database=%t.db -I Inputs %s \
+// RUN:   -DINCLUDE_GUARD_DATABASE_H | FileCheck -check-prefix=SKIPPED %s
+
+// Without the database, the header is entered to find its guard.
+// RUN: %clang_cc1 -E -I %S/Inputs %s -DINCLUDE_GUARD_DATABASE_H \
+// RUN:   | FileCheck -check-prefix=ENTERED %s
+
+// RUN: %clang -### -finclude-guard-database=%t.db -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=DRIVER %s
+
+#include "include-guard-database.h"
+
+// DB: {{^[0-9]+ -?[0-9]+ INCLUDE_GUARD_DATABASE_H .*include-guard-database.h$}}
+
+// ENTERED: include-guard-database.h" 1
+// SKIPPED-NOT: include-guard-database.h
+
+// SHOWN: . {{.*}}include-guard-database.h
+// DEPS: out: {{.*}}include-guard-database.c
+// DEPS-NEXT: {{.*}}include-guard-database.h
+
+// DRIVER: "-cc1"
+// DRIVER-SAME: "-finclude-guard-database={{.*}}.db"
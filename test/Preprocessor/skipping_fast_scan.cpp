@@ -0,0 +1,47 @@
+// RUN: %clang_cc1 -E -std=c++14 %s | FileCheck %s
+// RUN: %clang_cc1 -E -std=c++14 -trigraphs %s | FileCheck %s -check-prefix=TRIGRAPHS
+
+// Directive-looking text inside comments and literals of a skipped block must
+// not be taken as a directive, and real directives must still be found.
+
+#if 0
+/* multi-line comment
+#endif
+*/ "string #endif"
+const char *s = "unterminated \
+#endif
+";
+char c = '#'; int n = 1'000'000; // don't
+auto r = R"(
+#endif
+)";
+auto p = u8"#endif";
+x \
+#endif
+// line comment \
+#endif
+  /* leading comment */ #else
+ok1
+#endif
+// CHECK-NOT: string
+// CHECK: ok1
+
+#if 0
+ %:else
+ok2
+#endif
+// CHECK: ok2
+
+#if 0
+??=else
+ok3
+#endif
+// CHECK-NOT: ok3
+// TRIGRAPHS: ok3
+
+#if 0
+'unterminated
+#else
+ok4
+#endif
+// CHECK: ok4
@@ -1635,6 +1635,9 @@ int perform_test_load_source(int argc, const char **argv,
                           (!strcmp(filter, "local") || 
                            !strcmp(filter, "local-display"))? 1 : 0,
                           /* displayDiagnostics=*/1);
+  if (getenv("CINDEXTEST_PREAMBLE_CACHE"))
+    clang_CXIndex_setPreambleCachePath(Idx,
+                                       getenv("CINDEXTEST_PREAMBLE_CACHE"));
 
   if ((CommentSchemaFile = parse_comments_schema(argc, argv))) {
     argc--;
@@ -3576,6 +3579,80 @@ static int index_compile_db(int argc, const char **argv) {
   return errorCode;
 }
 
+static int index_compile_db_batch(int argc, const char **argv) {
+  const char *check_prefix;
+  CXIndex Idx;
+  CXIndexAction idxAction;
+  CXCompilationDatabase db;
+  CXCompilationDatabase_Error ec;
+  IndexData index_data;
+  char *tmp;
+  char *buildDir;
+  int result;
+
+  check_prefix = 0;
+  if (argc > 0) {
+    if (strstr(argv[0], "-check-prefix=") == argv[0]) {
+      check_prefix = argv[0] + strlen("-check-prefix=");
+      ++argv;
+      --argc;
+    }
+  }
+
+  if (argc == 0) {
+    fprintf(stderr, "no compilation database\n");
+    return -1;
+  }
+
+  /* The commands' directories are relative to the database. */
+  tmp = strdup(argv[0]);
+  buildDir = dirname(tmp);
+  db = clang_CompilationDatabase_fromDirectory(buildDir, &ec);
+  if (!db) {
+    printf("database loading failed with error code %d.\n", ec);
+    free(tmp);
+    return -1;
+  }
+  if (chdir(buildDir) != 0) {
+    printf("Could not chdir to %s\n", buildDir);
+    clang_CompilationDatabase_dispose(db);
+    free(tmp);
+    return -1;
+  }
+  free(tmp);
+
+  if (!(Idx = clang_createIndex(/* excludeDeclsFromPCH */ 1,
+                                /* displayDiagnostics=*/1))) {
+    fprintf(stderr, "Could not create Index\n");
+    clang_CompilationDatabase_dispose(db);
+    return 1;
+  }
+  idxAction = clang_IndexAction_create(Idx);
+
+  index_data.check_prefix = check_prefix;
+  index_data.first_check_printed = 0;
+  index_data.fail_for_error = 0;
+  index_data.abort = 0;
+  index_data.main_filename = "";
+  index_data.importedASTs = 0;
+  index_data.strings = NULL;
+  index_data.TU = NULL;
+
+  /* Use a single thread, so that the output is deterministic. */
+  result = clang_indexCompilationDatabase(idxAction, &index_data,
+                                          &IndexCB, sizeof(IndexCB),
+                                          getIndexOptions(), db,
+                                          /*num_threads=*/1);
+  if (index_data.fail_for_error)
+    result = -1;
+
+  free_client_data(&index_data);
+  clang_IndexAction_dispose(idxAction);
+  clang_disposeIndex(Idx);
+  clang_CompilationDatabase_dispose(db);
+  return result;
+}
+
 int perform_token_annotation(int argc, const char **argv) {
   const char *input = argv[1];
   char *filename = 0;
@@ -4249,6 +4326,7 @@ static void print_usage(void) {
     "       c-index-test -index-file-full [-check-prefix=<FileCheck prefix>] <compiler arguments>\n"
     "       c-index-test -index-tu [-check-prefix=<FileCheck prefix>] <AST file>\n"
     "       c-index-test -index-compile-db [-check-prefix=<FileCheck prefix>] <compilation database>\n"
+    "       c-index-test -index-compile-db-batch [-check-prefix=<FileCheck prefix>] <compilation database>\n"
     "       c-index-test -test-file-scan <AST file> <source file> "
           "[FileCheck prefix]\n");
   fprintf(stderr,
@@ -4326,6 +4404,8 @@ int cindextest_main(int argc, const char **argv) {
     return index_tu(argc - 2, argv + 2);
   if (argc > 2 && strcmp(argv[1], "-index-compile-db") == 0)
     return index_compile_db(argc - 2, argv + 2);
+  else if (argc > 2 && strcmp(argv[1], "-index-compile-db-batch") == 0)
+    return index_compile_db_batch(argc - 2, argv + 2);
   else if (argc >= 4 && strncmp(argv[1], "-test-load-tu", 13) == 0) {
     CXCursorVisitor I = GetVisitor(argv[1] + 13);
     if (I)
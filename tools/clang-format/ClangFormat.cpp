@@ -20,9 +20,17 @@
 #include "clang/Basic/Version.h"
 #include "clang/Format/Format.h"
 #include "clang/Rewrite/Core/Rewriter.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LockFileManager.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 using namespace llvm;
 using clang::tooling::Replacements;
@@ -102,12 +110,144 @@ static cl::opt<bool> SortIncludes(
              "SortIncludes style flag"),
     cl::cat(ClangFormatCategory));
 
+static cl::opt<unsigned>
+    NumThreads("j",
+               cl::desc("The number of files to format at the same time.\n"
+                        "0 uses one thread per hardware thread."),
+               cl::init(1), cl::cat(ClangFormatCategory));
+
+static cl::opt<std::string>
+    CacheFile("cache-file",
+              cl::desc("Remember the files that are already formatted in\n"
+                       "this file, and skip them while their contents and\n"
+                       "style stay the same.\n"
+                       "Can't be used with -offset, -length, -lines or\n"
+                       "-cursor."),
+              cl::cat(ClangFormatCategory));
+
 static cl::list<std::string> FileNames(cl::Positional, cl::desc("[<file> ...]"),
                                        cl::cat(ClangFormatCategory));
 
 namespace clang {
 namespace format {
 
+/// \brief The set of inputs that are known to be formatted already.
+///
+/// The cache file has one line per input: the MD5 hash of its contents, its
+/// file name, its style and the version of clang-format.  The file is
+/// locked, merged and atomically replaced when it is written, so that several
+/// clang-format processes can share it.
+class FormattedFileCache {
+public:
+  explicit FormattedFileCache(StringRef Path) : Path(Path) {
+    read(Path, Known);
+  }
+
+  static std::string getKey(StringRef FileName, StringRef Code,
+                            const FormatStyle &Style) {
+    llvm::MD5 Hash;
+    Hash.update(getClangToolFullVersion("clang-format"));
+    Hash.update(StringRef("\0", 1));
+    Hash.update(FileName);
+    Hash.update(StringRef("\0", 1));
+    Hash.update(configurationAsText(Style));
+    Hash.update(StringRef("\0", 1));
+    Hash.update(Code);
+    llvm::MD5::MD5Result Result;
+    Hash.final(Result);
+    SmallString<32> Key;
+    llvm::MD5::stringifyResult(Result, Key);
+    return Key.str();
+  }
+
+  bool contains(StringRef Key) {
+    std::lock_guard<std::mutex> Guard(Lock);
+    return Known.count(Key);
+  }
+
+  void add(StringRef Key) {
+    std::lock_guard<std::mutex> Guard(Lock);
+    if (Known.insert(Key).second)
+      New.insert(Key);
+  }
+
+  /// \brief Writes the new entries to the cache file.  Returns true on error.
+  bool write() {
+    if (New.empty())
+      return false;
+
+    while (true) {
+      llvm::LockFileManager Locked(Path);
+      switch (Locked) {
+      case llvm::LockFileManager::LFS_Error:
+        return true;
+
+      case llvm::LockFileManager::LFS_Owned:
+        return writeLocked();
+
+      case llvm::LockFileManager::LFS_Shared:
+        // Another clang-format is updating the cache.  Wait for it, then
+        // merge our entries into what it wrote.
+        if (Locked.waitForUnlock() == llvm::LockFileManager::Res_Timeout)
+          return true;
+        break;
+      }
+    }
+  }
+
+private:
+  /// \brief Merges the new entries into the cache file, while holding the
+  /// lock on it.  Returns true on error.
+  bool writeLocked() {
+    // Start from what is on disk now, which may include entries written by
+    // other processes since we read it.
+    llvm::StringSet<> Merged;
+    read(Path, Merged);
+    for (const auto &Key : New)
+      Merged.insert(Key.getKey());
+
+    SmallString<128> TempPath;
+    int TempFD;
+    if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", TempFD, TempPath))
+      return true;
+    {
+      llvm::raw_fd_ostream Out(TempFD, /*shouldClose=*/true);
+      for (const auto &Key : Merged)
+        Out << Key.getKey() << '\n';
+      Out.close();
+      if (Out.has_error()) {
+        Out.clear_error();
+        llvm::sys::fs::remove(TempPath);
+        return true;
+      }
+    }
+    if (llvm::sys::fs::rename(TempPath, Path)) {
+      llvm::sys::fs::remove(TempPath);
+      return true;
+    }
+    New.clear();
+    return false;
+  }
+
+  static void read(StringRef Path, llvm::StringSet<> &Keys) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer = MemoryBuffer::getFile(Path);
+    if (!Buffer)
+      return;
+    StringRef Rest = (*Buffer)->getBuffer();
+    while (!Rest.empty()) {
+      StringRef Line;
+      std::tie(Line, Rest) = Rest.split('\n');
+      if (Line.size() == 32)
+        Keys.insert(Line);
+    }
+  }
+
+  std::string Path;
+  std::mutex Lock;
+  llvm::StringSet<> Known;
+  llvm::StringSet<> New;
+};
+
 static FileID createInMemoryFile(StringRef FileName, MemoryBuffer *Source,
                                  SourceManager &Sources, FileManager &Files,
                                  vfs::InMemoryFileSystem *MemFS) {
@@ -125,8 +265,8 @@ static bool parseLineRange(StringRef Input, unsigned &FromLine,
          LineRange.second.getAsInteger(0, ToLine);
 }
 
-static bool fillRanges(MemoryBuffer *Code,
-                       std::vector<tooling::Range> &Ranges) {
+static bool fillRanges(MemoryBuffer *Code, std::vector<tooling::Range> &Ranges,
+                       raw_ostream &ErrOS) {
   IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem(
       new vfs::InMemoryFileSystem);
   FileManager Files(FileSystemOptions(), InMemoryFileSystem);
@@ -138,18 +278,18 @@ static bool fillRanges(MemoryBuffer *Code,
                                  InMemoryFileSystem.get());
   if (!LineRanges.empty()) {
     if (!Offsets.empty() || !Lengths.empty()) {
-      errs() << "error: cannot use -lines with -offset/-length\n";
+      ErrOS << "error: cannot use -lines with -offset/-length\n";
       return true;
     }
 
     for (unsigned i = 0, e = LineRanges.size(); i < e; ++i) {
       unsigned FromLine, ToLine;
       if (parseLineRange(LineRanges[i], FromLine, ToLine)) {
-        errs() << "error: invalid <start line>:<end line> pair\n";
+        ErrOS << "error: invalid <start line>:<end line> pair\n";
         return true;
       }
       if (FromLine > ToLine) {
-        errs() << "error: start line should be less than end line\n";
+        ErrOS << "error: start line should be less than end line\n";
         return true;
       }
       SourceLocation Start = Sources.translateLineCol(ID, FromLine, 1);
@@ -163,26 +303,28 @@ static bool fillRanges(MemoryBuffer *Code,
     return false;
   }
 
-  if (Offsets.empty())
-    Offsets.push_back(0);
-  if (Offsets.size() != Lengths.size() &&
-      !(Offsets.size() == 1 && Lengths.empty())) {
-    errs() << "error: number of -offset and -length arguments must match.\n";
+  // Files can be formatted in parallel, so don't modify the options.
+  std::vector<unsigned> Starts(Offsets.begin(), Offsets.end());
+  if (Starts.empty())
+    Starts.push_back(0);
+  if (Starts.size() != Lengths.size() &&
+      !(Starts.size() == 1 && Lengths.empty())) {
+    ErrOS << "error: number of -offset and -length arguments must match.\n";
     return true;
   }
-  for (unsigned i = 0, e = Offsets.size(); i != e; ++i) {
-    if (Offsets[i] >= Code->getBufferSize()) {
-      errs() << "error: offset " << Offsets[i] << " is outside the file\n";
+  for (unsigned i = 0, e = Starts.size(); i != e; ++i) {
+    if (Starts[i] >= Code->getBufferSize()) {
+      ErrOS << "error: offset " << Starts[i] << " is outside the file\n";
       return true;
     }
     SourceLocation Start =
-        Sources.getLocForStartOfFile(ID).getLocWithOffset(Offsets[i]);
+        Sources.getLocForStartOfFile(ID).getLocWithOffset(Starts[i]);
     SourceLocation End;
     if (i < Lengths.size()) {
-      if (Offsets[i] + Lengths[i] > Code->getBufferSize()) {
-        errs() << "error: invalid length " << Lengths[i]
-               << ", offset + length (" << Offsets[i] + Lengths[i]
-               << ") is outside the file.\n";
+      if (Starts[i] + Lengths[i] > Code->getBufferSize()) {
+        ErrOS << "error: invalid length " << Lengths[i]
+              << ", offset + length (" << Starts[i] + Lengths[i]
+              << ") is outside the file.\n";
         return true;
       }
       End = Start.getLocWithOffset(Lengths[i]);
@@ -196,87 +338,103 @@ static bool fillRanges(MemoryBuffer *Code,
   return false;
 }
 
-static void outputReplacementXML(StringRef Text) {
+static void outputReplacementXML(StringRef Text, raw_ostream &OS) {
   // FIXME: When we sort includes, we need to make sure the stream is correct
   // utf-8.
   size_t From = 0;
   size_t Index;
   while ((Index = Text.find_first_of("\n\r<&", From)) != StringRef::npos) {
-    outs() << Text.substr(From, Index - From);
+    OS << Text.substr(From, Index - From);
     switch (Text[Index]) {
     case '\n':
-      outs() << "&#10;";
+      OS << "&#10;";
       break;
     case '\r':
-      outs() << "&#13;";
+      OS << "&#13;";
       break;
     case '<':
-      outs() << "&lt;";
+      OS << "&lt;";
       break;
     case '&':
-      outs() << "&amp;";
+      OS << "&amp;";
       break;
     default:
       llvm_unreachable("Unexpected character encountered!");
     }
     From = Index + 1;
   }
-  outs() << Text.substr(From);
+  OS << Text.substr(From);
 }
 
-static void outputReplacementsXML(const Replacements &Replaces) {
+static void outputReplacementsXML(const Replacements &Replaces,
+                                  raw_ostream &OS) {
   for (const auto &R : Replaces) {
-    outs() << "<replacement "
-           << "offset='" << R.getOffset() << "' "
-           << "length='" << R.getLength() << "'>";
-    outputReplacementXML(R.getReplacementText());
-    outs() << "</replacement>\n";
+    OS << "<replacement "
+       << "offset='" << R.getOffset() << "' "
+       << "length='" << R.getLength() << "'>";
+    outputReplacementXML(R.getReplacementText(), OS);
+    OS << "</replacement>\n";
   }
 }
 
-// Returns true on error.
-static bool format(StringRef FileName) {
+// Writes the result to \p OS and errors to \p ErrOS.  Returns true on error.
+static bool format(StringRef FileName, raw_ostream &OS, raw_ostream &ErrOS,
+                   FormattedFileCache *Cache) {
   ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
       MemoryBuffer::getFileOrSTDIN(FileName);
   if (std::error_code EC = CodeOrErr.getError()) {
-    errs() << EC.message() << "\n";
+    ErrOS << EC.message() << "\n";
     return true;
   }
   std::unique_ptr<llvm::MemoryBuffer> Code = std::move(CodeOrErr.get());
   if (Code->getBufferSize() == 0)
     return false; // Empty files are formatted correctly.
   std::vector<tooling::Range> Ranges;
-  if (fillRanges(Code.get(), Ranges))
+  if (fillRanges(Code.get(), Ranges, ErrOS))
     return true;
   StringRef AssumedFileName = (FileName == "-") ? AssumeFileName : FileName;
-  FormatStyle FormatStyle = getStyle(Style, AssumedFileName, FallbackStyle);
+  FormatStyle FormatStyle =
+      getStyle(Style, AssumedFileName, FallbackStyle, /*FS=*/nullptr, ErrOS);
   if (SortIncludes.getNumOccurrences() != 0)
     FormatStyle.SortIncludes = SortIncludes;
   unsigned CursorPosition = Cursor;
-  Replacements Replaces = sortIncludes(FormatStyle, Code->getBuffer(), Ranges,
-                                       AssumedFileName, &CursorPosition);
-  auto ChangedCode = tooling::applyAllReplacements(Code->getBuffer(), Replaces);
-  if (!ChangedCode) {
-    llvm::errs() << llvm::toString(ChangedCode.takeError()) << "\n";
-    return true;
-  }
-  // Get new affected ranges after sorting `#includes`.
-  Ranges = tooling::calculateRangesAfterReplacements(Replaces, Ranges);
+  Replacements Replaces;
+  Replacements FormatChanges;
   bool IncompleteFormat = false;
-  Replacements FormatChanges = reformat(FormatStyle, *ChangedCode, Ranges,
-                                        AssumedFileName, &IncompleteFormat);
-  Replaces = Replaces.merge(FormatChanges);
+
+  // Inputs in the cache format to themselves.
+  std::string CacheKey;
+  if (Cache)
+    CacheKey = FormattedFileCache::getKey(AssumedFileName, Code->getBuffer(),
+                                          FormatStyle);
+  if (!Cache || !Cache->contains(CacheKey)) {
+    Replaces = sortIncludes(FormatStyle, Code->getBuffer(), Ranges,
+                            AssumedFileName, &CursorPosition);
+    auto ChangedCode =
+        tooling::applyAllReplacements(Code->getBuffer(), Replaces);
+    if (!ChangedCode) {
+      ErrOS << llvm::toString(ChangedCode.takeError()) << "\n";
+      return true;
+    }
+    // Get new affected ranges after sorting `#includes`.
+    Ranges = tooling::calculateRangesAfterReplacements(Replaces, Ranges);
+    FormatChanges = reformat(FormatStyle, *ChangedCode, Ranges,
+                             AssumedFileName, &IncompleteFormat);
+    Replaces = Replaces.merge(FormatChanges);
+    if (Cache && Replaces.empty() && !IncompleteFormat)
+      Cache->add(CacheKey);
+  }
+
   if (OutputXML) {
-    outs() << "<?xml version='1.0'?>\n<replacements "
-              "xml:space='preserve' incomplete_format='"
-           << (IncompleteFormat ? "true" : "false") << "'>\n";
+    OS << "<?xml version='1.0'?>\n<replacements "
+          "xml:space='preserve' incomplete_format='"
+       << (IncompleteFormat ? "true" : "false") << "'>\n";
     if (Cursor.getNumOccurrences() != 0)
-      outs() << "<cursor>"
-             << FormatChanges.getShiftedCodePosition(CursorPosition)
-             << "</cursor>\n";
+      OS << "<cursor>" << FormatChanges.getShiftedCodePosition(CursorPosition)
+         << "</cursor>\n";
 
-    outputReplacementsXML(Replaces);
-    outs() << "</replacements>\n";
+    outputReplacementsXML(Replaces, OS);
+    OS << "</replacements>\n";
   } else {
     IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem(
         new vfs::InMemoryFileSystem);
@@ -291,21 +449,51 @@ static bool format(StringRef FileName) {
     tooling::applyAllReplacements(Replaces, Rewrite);
     if (Inplace) {
       if (FileName == "-")
-        errs() << "error: cannot use -i when reading from stdin.\n";
+        ErrOS << "error: cannot use -i when reading from stdin.\n";
       else if (Rewrite.overwriteChangedFiles())
         return true;
     } else {
       if (Cursor.getNumOccurrences() != 0)
-        outs() << "{ \"Cursor\": "
-               << FormatChanges.getShiftedCodePosition(CursorPosition)
-               << ", \"IncompleteFormat\": "
-               << (IncompleteFormat ? "true" : "false") << " }\n";
-      Rewrite.getEditBuffer(ID).write(outs());
+        OS << "{ \"Cursor\": "
+           << FormatChanges.getShiftedCodePosition(CursorPosition)
+           << ", \"IncompleteFormat\": "
+           << (IncompleteFormat ? "true" : "false") << " }\n";
+      Rewrite.getEditBuffer(ID).write(OS);
     }
   }
   return false;
 }
 
+// Formats \p Files on \p ThreadCount threads, and writes the results in the
+// order of \p Files.  Returns true on error.
+static bool formatParallel(ArrayRef<std::string> Files, unsigned ThreadCount,
+                           FormattedFileCache *Cache) {
+  std::vector<std::string> Outputs(Files.size());
+  std::vector<std::string> Errors(Files.size());
+  std::atomic<unsigned> NextFile(0);
+  std::atomic<bool> Error(false);
+
+  auto Worker = [&] {
+    for (unsigned I = NextFile++; I < Files.size(); I = NextFile++) {
+      raw_string_ostream OS(Outputs[I]);
+      raw_string_ostream ErrOS(Errors[I]);
+      if (format(Files[I], OS, ErrOS, Cache))
+        Error = true;
+    }
+  };
+
+  llvm::ThreadPool Pool(ThreadCount);
+  for (unsigned I = 0; I != ThreadCount; ++I)
+    Pool.async(Worker);
+  Pool.wait();
+
+  for (unsigned I = 0, E = Files.size(); I != E; ++I) {
+    outs() << Outputs[I];
+    errs() << Errors[I];
+  }
+  return Error;
+}
+
 }  // namespace format
 }  // namespace clang
 
@@ -341,24 +529,48 @@ int main(int argc, const char **argv) {
     return 0;
   }
 
+  std::unique_ptr<clang::format::FormattedFileCache> Cache;
+  if (!CacheFile.empty()) {
+    if (!Offsets.empty() || !Lengths.empty() || !LineRanges.empty() ||
+        Cursor.getNumOccurrences() != 0) {
+      errs() << "error: -cache-file can't be used with -offset, -length, "
+                "-lines or -cursor.\n";
+      return 1;
+    }
+    Cache = llvm::make_unique<clang::format::FormattedFileCache>(CacheFile);
+  }
+
   bool Error = false;
   switch (FileNames.size()) {
   case 0:
-    Error = clang::format::format("-");
+    Error = clang::format::format("-", outs(), errs(), Cache.get());
     break;
   case 1:
-    Error = clang::format::format(FileNames[0]);
+    Error = clang::format::format(FileNames[0], outs(), errs(), Cache.get());
     break;
-  default:
+  default: {
     if (!Offsets.empty() || !Lengths.empty() || !LineRanges.empty()) {
       errs() << "error: -offset, -length and -lines can only be used for "
                 "single file.\n";
       return 1;
     }
+    unsigned ThreadCount = NumThreads;
+    if (ThreadCount == 0)
+      ThreadCount = std::max(1u, std::thread::hardware_concurrency());
+    ThreadCount = std::min<size_t>(ThreadCount, FileNames.size());
+    if (ThreadCount > 1) {
+      Error = clang::format::formatParallel(FileNames, ThreadCount,
+                                            Cache.get());
+      break;
+    }
     for (unsigned i = 0; i < FileNames.size(); ++i)
-      Error |= clang::format::format(FileNames[i]);
+      Error |= clang::format::format(FileNames[i], outs(), errs(),
+                                     Cache.get());
     break;
   }
+  }
+  if (Cache && Cache->write())
+    errs() << "warning: could not write " << CacheFile << "\n";
   return Error ? 1 : 0;
 }
 
@@ -14,6 +14,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Option/Arg.h"
+#include "clang/Basic/TimeTraceProfiler.h"
 #include "clang/CodeGen/ObjectFilePCHContainerOperations.h"
 #include "clang/Config/config.h"
 #include "clang/Driver/DriverDiagnostic.h"
@@ -31,6 +32,7 @@
 #include "llvm/Option/OptTable.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
@@ -179,9 +181,25 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
   if (!Success)
     return 1;
 
+  const std::string &TimeTracePath = Clang->getFrontendOpts().TimeTracePath;
+  if (!TimeTracePath.empty())
+    timeTraceProfilerInitialize(
+        Clang->getFrontendOpts().TimeTraceGranularity);
+
   // Execute the frontend actions.
   Success = ExecuteCompilerInvocation(Clang.get());
 
+  if (!TimeTracePath.empty()) {
+    std::error_code EC;
+    llvm::raw_fd_ostream TraceOS(TimeTracePath, EC, llvm::sys::fs::F_Text);
+    if (EC)
+      Clang->getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+          << TimeTracePath << EC.message();
+    else
+      timeTraceProfilerWrite(TraceOS);
+    timeTraceProfilerCleanup();
+  }
+
   // If any timers were active but haven't been destroyed yet, print their
   // results now.  This happens in -disable-free mode.
   llvm::TimerGroup::printAll(llvm::errs());
@@ -38,6 +38,7 @@ class CIndexer {
   unsigned Options; // CXGlobalOptFlags.
 
   std::string ResourcesPath;
+  std::string PreambleCachePath;
   std::shared_ptr<PCHContainerOperations> PCHContainerOps;
 
 public:
@@ -69,6 +70,13 @@ public:
     return Options & opt;
   }
 
+  /// \brief The directory in which precompiled preambles are shared with
+  /// other processes, or empty if they are not shared.
+  const std::string &getPreambleCachePath() const { return PreambleCachePath; }
+  void setPreambleCachePath(std::string Path) {
+    PreambleCachePath = std::move(Path);
+  }
+
   /// \brief Get the path of the clang resource files.
   const std::string &getClangResourcesPath();
 };
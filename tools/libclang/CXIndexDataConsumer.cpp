@@ -150,11 +150,32 @@ public:
 };
 }
 
+SharedOccurrenceFilter::~SharedOccurrenceFilter() {}
+
+bool CXIndexDataConsumer::shouldReportOccurrencesIn(FileID FID,
+                                                    unsigned Offset) {
+  if (!OccurrenceFilter)
+    return true;
+
+  const SourceManager &SM = getASTContext().getSourceManager();
+  if (FID == SM.getMainFileID())
+    return true;
+  const FileEntry *FE = SM.getFileEntryForID(FID);
+  if (!FE)
+    return true;
+
+  SourceLocation Loc = SM.getLocForStartOfFile(FID).getLocWithOffset(Offset);
+  return OccurrenceFilter->shouldReport(Loc, FID, FE);
+}
+
 bool CXIndexDataConsumer::handleDeclOccurence(const Decl *D,
                                               SymbolRoleSet Roles,
                                              ArrayRef<SymbolRelation> Relations,
                                               FileID FID, unsigned Offset,
                                               ASTNodeInfo ASTNode) {
+  if (!shouldReportOccurrencesIn(FID, Offset))
+    return !shouldAbort();
+
   SourceLocation Loc = getASTContext().getSourceManager()
       .getLocForStartOfFile(FID).getLocWithOffset(Offset);
 
@@ -28,6 +28,18 @@ namespace clang {
 
 namespace cxindex {
   class CXIndexDataConsumer;
+
+/// \brief Decides which occurrences outside its main file a translation unit
+/// reports, when it is indexed together with others.
+class SharedOccurrenceFilter {
+public:
+  virtual ~SharedOccurrenceFilter();
+
+  /// \brief Returns true if the occurrences at \p Loc, in the file \p FE,
+  /// are reported by this translation unit.
+  virtual bool shouldReport(SourceLocation Loc, FileID FID,
+                            const FileEntry *FE) = 0;
+};
   class AttrListInfo;
 
 class ScratchAlloc {
@@ -292,6 +304,10 @@ class CXIndexDataConsumer : public index::IndexDataConsumer {
   typedef std::pair<const FileEntry *, const Decl *> RefFileOccurrence;
   llvm::DenseSet<RefFileOccurrence> RefFileOccurrences;
 
+  /// \brief If set, decides which occurrences outside the main file are
+  /// reported.
+  SharedOccurrenceFilter *OccurrenceFilter;
+
   llvm::BumpPtrAllocator StrScratch;
   unsigned StrAdapterCount;
   friend class ScratchAlloc;
@@ -335,7 +351,7 @@ public:
   CXIndexDataConsumer(CXClientData clientData, IndexerCallbacks &indexCallbacks,
                   unsigned indexOptions, CXTranslationUnit cxTU)
     : Ctx(nullptr), ClientData(clientData), CB(indexCallbacks),
-      IndexOptions(indexOptions), CXTU(cxTU),
+      IndexOptions(indexOptions), CXTU(cxTU), OccurrenceFilter(nullptr),
       StrScratch(), StrAdapterCount(0) { }
 
   ASTContext &getASTContext() const { return *Ctx; }
@@ -344,6 +360,10 @@ public:
   void setASTContext(ASTContext &ctx);
   void setPreprocessor(Preprocessor &PP);
 
+  void setOccurrenceFilter(SharedOccurrenceFilter *Filter) {
+    OccurrenceFilter = Filter;
+  }
+
   bool shouldSuppressRefs() const {
     return IndexOptions & CXIndexOpt_SuppressRedundantRefs;
   }
@@ -461,6 +481,8 @@ public:
   static bool isTemplateImplicitInstantiation(const Decl *D);
 
 private:
+  bool shouldReportOccurrencesIn(FileID FID, unsigned Offset);
+
   bool handleDeclOccurence(const Decl *D, index::SymbolRoleSet Roles,
                            ArrayRef<index::SymbolRelation> Relations,
                            FileID FID, unsigned Offset,
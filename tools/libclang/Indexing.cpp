@@ -27,11 +27,16 @@
 #include "clang/Lex/PPConditionalDirectiveRecord.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PreprocessorOptions.h"
+#include "clang/Tooling/CompilationDatabase.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
+#include <thread>
 #include <utility>
 
 using namespace clang;
@@ -146,6 +151,37 @@ public:
   }
 };
 
+/// \brief Get the region that \p Loc, in the file \p FE, belongs to, or an
+/// invalid region if its contents may depend on where the file is included.
+PPRegion getPPRegion(PPConditionalDirectiveRecord &PPRec, Preprocessor &PP,
+                     SourceLocation Loc, FileID FID, const FileEntry *FE) {
+  SourceLocation RegionLoc = PPRec.findConditionalDirectiveRegionLoc(Loc);
+  if (RegionLoc.isInvalid()) {
+    if (PP.getHeaderSearchInfo().isFileMultipleIncludeGuarded(FE)) {
+      const llvm::sys::fs::UniqueID &ID = FE->getUniqueID();
+      return PPRegion(ID, 0, FE->getModificationTime());
+    }
+    return PPRegion();
+  }
+
+  const SourceManager &SM = PPRec.getSourceManager();
+  assert(RegionLoc.isFileID());
+  FileID RegionFID;
+  unsigned RegionOffset;
+  std::tie(RegionFID, RegionOffset) = SM.getDecomposedLoc(RegionLoc);
+
+  if (RegionFID != FID) {
+    if (PP.getHeaderSearchInfo().isFileMultipleIncludeGuarded(FE)) {
+      const llvm::sys::fs::UniqueID &ID = FE->getUniqueID();
+      return PPRegion(ID, 0, FE->getModificationTime());
+    }
+    return PPRegion();
+  }
+
+  const llvm::sys::fs::UniqueID &ID = FE->getUniqueID();
+  return PPRegion(ID, RegionOffset, FE->getModificationTime());
+}
+
 class TUSkipBodyControl {
   SessionSkipBodyData &SessionData;
   PPConditionalDirectiveRecord &PPRec;
@@ -165,7 +201,7 @@ public:
   }
 
   bool isParsed(SourceLocation Loc, FileID FID, const FileEntry *FE) {
-    PPRegion region = getRegion(Loc, FID, FE);
+    PPRegion region = getPPRegion(PPRec, PP, Loc, FID, FE);
     if (region.isInvalid())
       return false;
 
@@ -183,38 +219,70 @@ public:
   void finished() {
     SessionData.update(NewParsedRegions);
   }
+};
 
-private:
-  PPRegion getRegion(SourceLocation Loc, FileID FID, const FileEntry *FE) {
-    SourceLocation RegionLoc = PPRec.findConditionalDirectiveRegionLoc(Loc);
-    if (RegionLoc.isInvalid()) {
-      if (isParsedOnceInclude(FE)) {
-        const llvm::sys::fs::UniqueID &ID = FE->getUniqueID();
-        return PPRegion(ID, 0, FE->getModificationTime());
-      }
-      return PPRegion();
-    }
+//===----------------------------------------------------------------------===//
+// Report Shared Regions Once
+//===----------------------------------------------------------------------===//
 
-    const SourceManager &SM = PPRec.getSourceManager();
-    assert(RegionLoc.isFileID());
-    FileID RegionFID;
-    unsigned RegionOffset;
-    std::tie(RegionFID, RegionOffset) = SM.getDecomposedLoc(RegionLoc);
+/// \brief The regions whose declarations and references have already been
+/// reported, shared by translation units that are indexed together, and the
+/// translation unit that reports each of them.
+class SessionIndexedRegions {
+  llvm::sys::Mutex Mux;
+  llvm::DenseMap<PPRegion, unsigned> Owners;
 
-    if (RegionFID != FID) {
-      if (isParsedOnceInclude(FE)) {
-        const llvm::sys::fs::UniqueID &ID = FE->getUniqueID();
-        return PPRegion(ID, 0, FE->getModificationTime());
-      }
-      return PPRegion();
-    }
+public:
+  SessionIndexedRegions() : Mux(/*recursive=*/false) {}
 
-    const llvm::sys::fs::UniqueID &ID = FE->getUniqueID();
-    return PPRegion(ID, RegionOffset, FE->getModificationTime());
+  /// \brief Record that translation unit \p TU reports \p Region.  Returns
+  /// false if another one already does.
+  bool claim(const PPRegion &Region, unsigned TU) {
+    llvm::MutexGuard MG(Mux);
+    return Owners.insert(std::make_pair(Region, TU)).second;
   }
 
-  bool isParsedOnceInclude(const FileEntry *FE) {
-    return PP.getHeaderSearchInfo().isFileMultipleIncludeGuarded(FE);
+  /// \brief Let a later translation unit report the regions that \p TU
+  /// claimed but did not finish reporting.  Those that \p TU reported in
+  /// full will be reported again, and those that a concurrent translation
+  /// unit has already skipped stay unreported unless a later one reaches
+  /// them (see clang_indexCompilationDatabase).
+  void release(unsigned TU) {
+    llvm::MutexGuard MG(Mux);
+    for (auto I = Owners.begin(), E = Owners.end(); I != E; ++I)
+      if (I->second == TU)
+        Owners.erase(I);
+  }
+};
+
+class TUIndexedRegionControl : public SharedOccurrenceFilter {
+  SessionIndexedRegions &SessionData;
+  unsigned TU;
+  PPConditionalDirectiveRecord &PPRec;
+  Preprocessor &PP;
+
+  llvm::DenseMap<PPRegion, bool> ReportedRegions;
+
+public:
+  TUIndexedRegionControl(SessionIndexedRegions &sessionData, unsigned tu,
+                         PPConditionalDirectiveRecord &ppRec,
+                         Preprocessor &pp)
+    : SessionData(sessionData), TU(tu), PPRec(ppRec), PP(pp) {}
+
+  bool shouldReport(SourceLocation Loc, FileID FID,
+                    const FileEntry *FE) override {
+    PPRegion region = getPPRegion(PPRec, PP, Loc, FID, FE);
+    if (region.isInvalid())
+      return true;
+
+    // Decide once per region, so that a region this translation unit reaches
+    // several times is reported every time or not at all.
+    auto Known = ReportedRegions.find(region);
+    if (Known != ReportedRegions.end())
+      return Known->second;
+    bool Report = SessionData.claim(region, TU);
+    ReportedRegions[region] = Report;
+    return Report;
   }
 };
 
@@ -354,10 +422,17 @@ class IndexingFrontendAction : public ASTFrontendAction {
   SessionSkipBodyData *SKData;
   std::unique_ptr<TUSkipBodyControl> SKCtrl;
 
+  SessionIndexedRegions *IRData;
+  unsigned TU;
+  std::unique_ptr<TUIndexedRegionControl> IRCtrl;
+
 public:
   IndexingFrontendAction(std::shared_ptr<CXIndexDataConsumer> dataConsumer,
-                         SessionSkipBodyData *skData)
-      : DataConsumer(std::move(dataConsumer)), SKData(skData) {}
+                         SessionSkipBodyData *skData,
+                         SessionIndexedRegions *irData = nullptr,
+                         unsigned tu = 0)
+      : DataConsumer(std::move(dataConsumer)), SKData(skData),
+        IRData(irData), TU(tu) {}
 
   std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
                                                  StringRef InFile) override {
@@ -373,10 +448,17 @@ public:
     PP.addPPCallbacks(llvm::make_unique<IndexPPCallbacks>(PP, *DataConsumer));
     DataConsumer->setPreprocessor(PP);
 
-    if (SKData) {
-      auto *PPRec = new PPConditionalDirectiveRecord(PP.getSourceManager());
+    PPConditionalDirectiveRecord *PPRec = nullptr;
+    if (SKData || IRData) {
+      PPRec = new PPConditionalDirectiveRecord(PP.getSourceManager());
       PP.addPPCallbacks(std::unique_ptr<PPCallbacks>(PPRec));
+    }
+    if (SKData)
       SKCtrl = llvm::make_unique<TUSkipBodyControl>(*SKData, *PPRec, PP);
+    if (IRData) {
+      IRCtrl = llvm::make_unique<TUIndexedRegionControl>(*IRData, TU, *PPRec,
+                                                         PP);
+      DataConsumer->setOccurrenceFilter(IRCtrl.get());
     }
 
     return llvm::make_unique<IndexingConsumer>(*DataConsumer, SKCtrl.get());
@@ -418,7 +500,8 @@ static CXErrorCode clang_indexSourceFile_Impl(
     unsigned index_options, const char *source_filename,
     const char *const *command_line_args, int num_command_line_args,
     ArrayRef<CXUnsavedFile> unsaved_files, CXTranslationUnit *out_TU,
-    unsigned TU_options) {
+    unsigned TU_options, SessionIndexedRegions *IndexedRegions = nullptr,
+    unsigned TU = 0) {
   if (out_TU)
     *out_TU = nullptr;
   bool requestedToGetTU = (out_TU != nullptr);
@@ -541,7 +624,8 @@ static CXErrorCode clang_indexSourceFile_Impl(
     std::make_shared<CXIndexDataConsumer>(client_data, CB, index_options,
                                           CXTU->getTU());
   auto InterAction = llvm::make_unique<IndexingFrontendAction>(DataConsumer,
-                         SkipBodies ? IdxSession->SkipBodyData.get() : nullptr);
+                         SkipBodies ? IdxSession->SkipBodyData.get() : nullptr,
+                         IndexedRegions, TU);
   std::unique_ptr<FrontendAction> IndexAction;
   IndexAction = createIndexingAction(DataConsumer,
                                 getIndexingOptionsFromCXOptions(index_options),
@@ -683,6 +767,109 @@ static CXErrorCode clang_indexTranslationUnit_Impl(
   return CXError_Success;
 }
 
+//===----------------------------------------------------------------------===//
+// clang_indexCompilationDatabase Implementation
+//===----------------------------------------------------------------------===//
+
+static CXErrorCode clang_indexCompilationDatabase_Impl(
+    CXIndexAction idxAction, CXClientData client_data,
+    IndexerCallbacks *index_callbacks, unsigned index_callbacks_size,
+    unsigned index_options, CXCompilationDatabase db, unsigned num_threads) {
+  if (!idxAction || !db)
+    return CXError_InvalidArguments;
+  if (!index_callbacks || index_callbacks_size == 0)
+    return CXError_InvalidArguments;
+
+  std::vector<tooling::CompileCommand> Commands =
+      static_cast<tooling::CompilationDatabase *>(db)->getAllCompileCommands();
+  if (Commands.empty())
+    return CXError_Success;
+
+  if (num_threads == 0)
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  num_threads = std::min<unsigned>(num_threads, Commands.size());
+
+  IndexerCallbacks CB;
+  memset(&CB, 0, sizeof(CB));
+  unsigned ClientCBSize = index_callbacks_size < sizeof(CB)
+                                  ? index_callbacks_size : sizeof(CB);
+  memcpy(&CB, index_callbacks, ClientCBSize);
+
+  SessionIndexedRegions IndexedRegions;
+  std::atomic<unsigned> NextCommand(0);
+  std::atomic<bool> Failed(false);
+  std::atomic<bool> Aborted(false);
+
+  auto shouldAbort = [&] {
+    if (Aborted)
+      return true;
+    if (CB.abortQuery && CB.abortQuery(client_data, nullptr))
+      Aborted = true;
+    return Aborted.load();
+  };
+
+  auto IndexCommands = [&] {
+    for (unsigned I = NextCommand++; I < Commands.size(); I = NextCommand++) {
+      // Once the client asks to abort, don't start any more commands.
+      if (shouldAbort())
+        return;
+
+      const tooling::CompileCommand &Cmd = Commands[I];
+      if (Cmd.CommandLine.empty()) {
+        Failed = true;
+        continue;
+      }
+
+      // The commands come from different directories, and the process only
+      // has one current directory, so let the driver resolve paths instead.
+      std::vector<const char *> Args;
+      Args.push_back(Cmd.CommandLine.front().c_str());
+      Args.push_back("-working-directory");
+      Args.push_back(Cmd.Directory.c_str());
+      for (unsigned A = 1, N = Cmd.CommandLine.size(); A != N; ++A)
+        Args.push_back(Cmd.CommandLine[A].c_str());
+
+      CXErrorCode Result = CXError_Failure;
+      auto IndexCommandImpl = [&] {
+        Result = clang_indexSourceFile_Impl(
+            idxAction, client_data, index_callbacks, index_callbacks_size,
+            index_options, /*source_filename=*/nullptr, Args.data(),
+            Args.size(), None, /*out_TU=*/nullptr, /*TU_options=*/0,
+            &IndexedRegions, I);
+      };
+
+      if (getenv("LIBCLANG_NOTHREADS")) {
+        IndexCommandImpl();
+      } else {
+        llvm::CrashRecoveryContext CRC;
+        if (!RunSafely(CRC, IndexCommandImpl)) {
+          fprintf(stderr, "libclang: crash detected during indexing '%s'\n",
+                  Cmd.Filename.c_str());
+          Result = CXError_Crashed;
+        }
+      }
+
+      // A translation unit that failed or crashed may not have reported all
+      // the regions it claimed, so let a later one report them instead.
+      if (Result != CXError_Success) {
+        IndexedRegions.release(I);
+        Failed = true;
+      }
+    }
+  };
+
+  if (num_threads == 1) {
+    IndexCommands();
+  } else {
+    llvm::ThreadPool Pool(num_threads);
+    for (unsigned I = 0; I != num_threads; ++I)
+      Pool.async(IndexCommands);
+    Pool.wait();
+  }
+
+  return Failed ? CXError_Failure : CXError_Success;
+}
+
 //===----------------------------------------------------------------------===//
 // libclang public APIs.
 //===----------------------------------------------------------------------===//
@@ -947,6 +1134,22 @@ int clang_indexTranslationUnit(CXIndexAction idxAction,
   return result;
 }
 
+int clang_indexCompilationDatabase(CXIndexAction idxAction,
+                                   CXClientData client_data,
+                                   IndexerCallbacks *index_callbacks,
+                                   unsigned index_callbacks_size,
+                                   unsigned index_options,
+                                   CXCompilationDatabase db,
+                                   unsigned num_threads) {
+  LOG_FUNC_SECTION {
+    *Log << "threads: " << num_threads;
+  }
+
+  return clang_indexCompilationDatabase_Impl(
+      idxAction, client_data, index_callbacks, index_callbacks_size,
+      index_options, db, num_threads);
+}
+
 void clang_indexLoc_getFileLocation(CXIdxLoc location,
                                     CXIdxClientFile *indexFile,
                                     CXFile *file,
@@ -119,6 +119,38 @@ TEST(MatchFinder, CheckProfiling) {
   EXPECT_EQ("MyID", Records.begin()->getKey());
 }
 
+TEST(MatchFinder, TopLevelDeclShard) {
+  struct CountingCallback : public MatchFinder::MatchCallback {
+    CountingCallback() : Count(0) {}
+    void run(const MatchFinder::MatchResult &Result) override { ++Count; }
+    unsigned Count;
+  };
+
+  std::unique_ptr<ASTUnit> AST(tooling::buildASTFromCode(
+      "void a() {} namespace n { void b() {} void c() {} }"
+      "extern \"C\" { void d() {} }"));
+  ASSERT_TRUE(AST.get());
+
+  unsigned Functions = 0;
+  unsigned Namespaces = 0;
+  for (unsigned Index = 0; Index != 3; ++Index) {
+    MatchFinder::MatchFinderOptions Options;
+    Options.TopLevelDeclShard.emplace(3, Index);
+    MatchFinder Finder(std::move(Options));
+    CountingCallback FunctionCallback, NamespaceCallback;
+    Finder.addMatcher(functionDecl(isDefinition()), &FunctionCallback);
+    Finder.addMatcher(namespaceDecl(hasName("n")), &NamespaceCallback);
+    Finder.matchAST(AST->getASTContext());
+
+    EXPECT_LT(0u, FunctionCallback.Count);
+    EXPECT_EQ(Index == 0 ? 1u : 0u, NamespaceCallback.Count);
+    Functions += FunctionCallback.Count;
+    Namespaces += NamespaceCallback.Count;
+  }
+  EXPECT_EQ(4u, Functions);
+  EXPECT_EQ(1u, Namespaces);
+}
+
 class VerifyStartOfTranslationUnit : public MatchFinder::MatchCallback {
 public:
   VerifyStartOfTranslationUnit() : Called(false) {}
@@ -36,7 +36,6 @@ private:
     Data.UniqueID = llvm::sys::fs::UniqueID(1, INode);
     Data.IsDirectory = !IsFile;
     Data.IsNamedPipe = false;
-    Data.InPCH = false;
     StatCalls[Path] = Data;
   }
 
@@ -246,6 +245,51 @@ TEST_F(FileManagerTest, addRemoveStatCache) {
   manager.removeStatCache(statCache);
 }
 
+// Stat results recorded through a SharedStatCache are visible to the other
+// FileManagers sharing it.
+TEST_F(FileManagerTest, sharedStatCacheIsSharedBetweenManagers) {
+  IntrusiveRefCntPtr<SharedStatCache> Shared(new SharedStatCache);
+  auto statCache = llvm::make_unique<FakeStatCache>();
+  statCache->InjectDirectory("/tmp", 42);
+  statCache->InjectFile("/tmp/test", 43);
+  manager.addStatCache(llvm::make_unique<SharedStatCacheClient>(Shared));
+  manager.addStatCache(std::move(statCache));
+  ASSERT_TRUE(manager.getFile("/tmp/test") != nullptr);
+
+  // The file system seen by the second manager is empty, so it can only find
+  // the file through the shared cache.
+  FileManager other(options);
+  other.addStatCache(llvm::make_unique<SharedStatCacheClient>(Shared));
+  other.addStatCache(llvm::make_unique<FakeStatCache>());
+  const FileEntry *file = other.getFile("/tmp/test");
+  ASSERT_TRUE(file != nullptr);
+  EXPECT_STREQ("/tmp/test", file->getName());
+  EXPECT_EQ(nullptr, other.getFile("/tmp/missing"));
+}
+
+// Missing paths are only remembered when the shared cache is asked to.
+TEST_F(FileManagerTest, sharedStatCacheCachesMissingPaths) {
+  SharedStatCache::Options Opts;
+  Opts.CacheMissingPaths = true;
+  IntrusiveRefCntPtr<SharedStatCache> Shared(new SharedStatCache(Opts));
+  auto statCache = llvm::make_unique<FakeStatCache>();
+  statCache->InjectDirectory("/tmp", 42);
+  manager.setSharedStatCache(Shared);
+  manager.addStatCache(std::move(statCache));
+  EXPECT_EQ(nullptr, manager.getFile("/tmp/test"));
+
+  // The file exists for the second manager, but the shared cache already
+  // recorded that it is missing.
+  FileManager other(options);
+  other.setSharedStatCache(Shared);
+  auto otherStatCache = llvm::make_unique<FakeStatCache>();
+  otherStatCache->InjectDirectory("/tmp", 42);
+  otherStatCache->InjectFile("/tmp/test", 43);
+  other.addStatCache(std::move(otherStatCache));
+  EXPECT_EQ(nullptr, other.getFile("/tmp/test"));
+  EXPECT_LT(0u, Shared->getNumHits());
+}
+
 #endif  // !LLVM_ON_WIN32
 
 } // anonymous namespace
@@ -11,6 +11,7 @@
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/FileManager.h"
+#include "clang/Basic/FrozenSourceManager.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/Basic/TargetOptions.h"
@@ -22,6 +23,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Config/llvm-config.h"
 #include "gtest/gtest.h"
+#include <thread>
 
 using namespace clang;
 
@@ -171,6 +173,99 @@ TEST_F(SourceManagerTest, getColumnNumber) {
   EXPECT_EQ(1U, SourceMgr.getColumnNumber(MainFileID, 0, nullptr));
 }
 
+TEST_F(SourceManagerTest, getLineNumberMixedNewlines) {
+  // The \r\n after the a's straddles the end of the first 16 bytes.
+  const char *Source = "aaaaaaaaaaaaaaa\r\nb\n\rc\rd\n\ne";
+
+  std::unique_ptr<llvm::MemoryBuffer> Buf =
+      llvm::MemoryBuffer::getMemBuffer(Source);
+  FileID MainFileID = SourceMgr.createFileID(std::move(Buf));
+  SourceMgr.setMainFileID(MainFileID);
+
+  EXPECT_EQ(1U, SourceMgr.getLineNumber(MainFileID, 14));
+  EXPECT_EQ(1U, SourceMgr.getLineNumber(MainFileID, 16));
+  EXPECT_EQ(2U, SourceMgr.getLineNumber(MainFileID, 17));
+  EXPECT_EQ(3U, SourceMgr.getLineNumber(MainFileID, 20));
+  EXPECT_EQ(4U, SourceMgr.getLineNumber(MainFileID, 22));
+  EXPECT_EQ(5U, SourceMgr.getLineNumber(MainFileID, 24));
+  EXPECT_EQ(6U, SourceMgr.getLineNumber(MainFileID, 25));
+  EXPECT_EQ(1U, SourceMgr.getColumnNumber(MainFileID, 25));
+}
+
+TEST_F(SourceManagerTest, FrozenSourceManager) {
+  const char *Source =
+    "#define M(x) [x]\n"
+    "M(foo)\n"
+    "  int M(bar);";
+  std::unique_ptr<llvm::MemoryBuffer> Buf =
+      llvm::MemoryBuffer::getMemBuffer(Source);
+  FileID MainFileID = SourceMgr.createFileID(std::move(Buf));
+  SourceMgr.setMainFileID(MainFileID);
+
+  VoidModuleLoader ModLoader;
+  HeaderSearch HeaderInfo(new HeaderSearchOptions, SourceMgr, Diags, LangOpts,
+                          &*Target);
+  Preprocessor PP(new PreprocessorOptions(), Diags, LangOpts, SourceMgr,
+                  HeaderInfo, ModLoader,
+                  /*IILookup =*/nullptr,
+                  /*OwnsHeaderSearch =*/false);
+  PP.Initialize(*Target);
+  PP.EnterMainSourceFile();
+
+  std::vector<SourceLocation> Locs;
+  while (1) {
+    Token Tok;
+    PP.Lex(Tok);
+    if (Tok.is(tok::eof))
+      break;
+    Locs.push_back(Tok.getLocation());
+  }
+  ASSERT_EQ(8U, Locs.size());
+
+  struct Decoded {
+    unsigned SpellingLine, SpellingColumn, ExpansionLine, ExpansionColumn;
+  };
+  std::vector<Decoded> Expected;
+  for (SourceLocation Loc : Locs)
+    Expected.push_back({SourceMgr.getSpellingLineNumber(Loc),
+                        SourceMgr.getSpellingColumnNumber(Loc),
+                        SourceMgr.getExpansionLineNumber(Loc),
+                        SourceMgr.getExpansionColumnNumber(Loc)});
+  // The 'bar' inside the second expansion.
+  EXPECT_EQ(3U, Expected[5].SpellingLine);
+  EXPECT_EQ(9U, Expected[5].SpellingColumn);
+  EXPECT_EQ(3U, Expected[5].ExpansionLine);
+  EXPECT_EQ(7U, Expected[5].ExpansionColumn);
+
+  FrozenSourceManager Frozen(SourceMgr);
+  auto Check = [&] {
+    for (unsigned I = 0, N = Locs.size(); I != N; ++I) {
+      SourceLocation Loc = Locs[I];
+      EXPECT_EQ(SourceMgr.getFileID(Loc), Frozen.getFileID(Loc));
+      EXPECT_EQ(Expected[I].SpellingLine, Frozen.getSpellingLineNumber(Loc));
+      EXPECT_EQ(Expected[I].SpellingColumn,
+                Frozen.getSpellingColumnNumber(Loc));
+      EXPECT_EQ(Expected[I].ExpansionLine,
+                Frozen.getExpansionLineNumber(Loc));
+      EXPECT_EQ(Expected[I].ExpansionColumn,
+                Frozen.getExpansionColumnNumber(Loc));
+    }
+  };
+
+#if LLVM_ENABLE_THREADS
+  std::vector<std::thread> Threads;
+  for (unsigned I = 0; I != 4; ++I)
+    Threads.emplace_back(Check);
+  for (std::thread &T : Threads)
+    T.join();
+#else
+  Check();
+#endif
+
+  EXPECT_EQ(MainFileID, Frozen.getDecomposedLoc(Locs[0]).first);
+  EXPECT_EQ(Source, Frozen.getBufferData(MainFileID).data());
+}
+
 #if defined(LLVM_ON_UNIX)
 
 TEST_F(SourceManagerTest, getMacroArgExpandedLocation) {
@@ -3715,14 +3715,8 @@ TEST_F(FormatTest, MemoizationTests) {
       "                     CFIndex order, CFRunLoopTimerCallBack callout,\n"
       "                     CFRunLoopTimerContext *context) {}");
 
-  // Deep nesting somewhat works around our memoization.
-  verifyFormat(
-      "aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(\n"
-      "    aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(\n"
-      "        aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(\n"
-      "            aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(\n"
-      "                aaaaa())))))))))))))))))))))))))))))))))))))));",
-      getLLVMStyleWithColumns(65));
+  // Deep nesting somewhat works around our memoization; see also
+  // MemoizationCutOff.
   verifyFormat(
       "aaaaa(\n"
       "    aaaaa,\n"
@@ -3784,6 +3778,29 @@ TEST_F(FormatTest, MemoizationTests) {
   verifyFormat(input, OnePerLine);
 }
 
+TEST_F(FormatTest, MemoizationCutOff) {
+  // Past 50000 queued states, the search stops telling states apart by their
+  // ParenState stacks, and misses some layouts.  That is why the first line
+  // runs one column over the limit.  Pin what the search finds, so that a
+  // change in which states are taken as already examined shows up here.
+  verifyFormat(
+      "aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(\n"
+      "    aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(\n"
+      "        aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(\n"
+      "            aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(aaaaa(\n"
+      "                aaaaa())))))))))))))))))))))))))))))))))))))));",
+      getLLVMStyleWithColumns(65));
+
+  // Below the cut-off, a state that is equivalent to one already queued with
+  // no higher penalty is not queued again.  That must not change the layout
+  // that is found: here the argument that doesn't fit goes on the next line,
+  // aligned with the others, rather than all of them after a break after the
+  // parenthesis.
+  verifyFormat(
+      "aaaaaaaaaaaaaaaaaaaa(aaaaaaaaaaaaaaaaaaaa, aaaaaaaaaaaaaaaaaaaa,\n"
+      "                     aaaaaaaaaaaaaaaaaaaa);");
+}
+
 TEST_F(FormatTest, BreaksAsHighAsPossible) {
   verifyFormat(
       "void f() {\n"
@@ -380,4 +380,33 @@ TEST_F(LexerTest, DontMergeMacroArgsFromDifferentMacroFiles) {
   EXPECT_EQ(SourceMgr.getFileIDSize(SourceMgr.getFileID(helper1ArgLoc)), 8U);
 }
 
+TEST_F(LexerTest, LongRuns) {
+  // Whitespace, identifiers, string literals and line comments both shorter
+  // and longer than a vector block, ending at every offset within one.
+  std::string Source;
+  for (unsigned Len = 1; Len != 40; ++Len) {
+    Source += std::string(Len, ' ') + std::string(Len, 'a') + "0_Z ";
+    Source += "\"" + std::string(Len, 'x') + "\\\"y\" // ";
+    Source += std::string(Len, 'c') + "\n";
+  }
+  // A line comment continued by an escaped newline, and one ending the file.
+  Source += "// " + std::string(40, 'c') + "\\\n" + std::string(40, 'c');
+  Source += "\nint x; // " + std::string(40, 'c');
+
+  std::vector<Token> Toks = Lex(Source);
+  ASSERT_EQ(2 * 39U + 3, Toks.size());
+  for (unsigned Len = 1; Len != 40; ++Len) {
+    const Token &Id = Toks[2 * (Len - 1)];
+    EXPECT_EQ(tok::identifier, Id.getKind());
+    EXPECT_EQ(Len + 3, Id.getLength());
+
+    const Token &Str = Toks[2 * (Len - 1) + 1];
+    EXPECT_EQ(tok::string_literal, Str.getKind());
+    EXPECT_EQ(Len + 5, Str.getLength());
+  }
+  EXPECT_EQ(tok::kw_int, Toks[2 * 39].getKind());
+  EXPECT_EQ(tok::identifier, Toks[2 * 39 + 1].getKind());
+  EXPECT_EQ(tok::semi, Toks[2 * 39 + 2].getKind());
+}
+
 } // anonymous namespace
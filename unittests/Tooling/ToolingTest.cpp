@@ -14,6 +14,7 @@
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Frontend/FrontendActions.h"
+#include "clang/Lex/Preprocessor.h"
 #include "clang/Tooling/CompilationDatabase.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/STLExtras.h"
@@ -520,6 +521,78 @@ TEST(ClangToolTest, InjectDiagnosticConsumer) {
   EXPECT_EQ(1u, Consumer.NumDiagnosticsSeen);
 }
 
+TEST(ClangToolTest, RunParallel) {
+  FixedCompilationDatabase Compilations("/", std::vector<std::string>());
+  std::vector<std::string> Sources = {"/a.cc", "/b.cc", "/c.cc", "/d.cc"};
+  ClangTool Tool(Compilations, Sources);
+  for (const std::string &Source : Sources)
+    Tool.mapVirtualFile(Source, "#include \"common.h\"\nint x = undeclared;");
+  Tool.mapVirtualFile("/common.h", "int y;");
+  TestDiagnosticConsumer Consumer;
+  Tool.setDiagnosticConsumer(&Consumer);
+  std::unique_ptr<FrontendActionFactory> Action(
+      newFrontendActionFactory<SyntaxOnlyAction>());
+  EXPECT_EQ(1, Tool.runParallel(Action.get(), 3));
+  EXPECT_EQ(4u, Consumer.NumDiagnosticsSeen);
+}
+
+/// Checks that each translation unit's diagnostics arrive within its own
+/// BeginSourceFile()/EndSourceFile() pair.
+struct SourceFileDiagnosticConsumer : public DiagnosticConsumer {
+  SourceFileDiagnosticConsumer() : PP(nullptr), NumDiagnosticsSeen(0) {}
+  void BeginSourceFile(const LangOptions &LangOpts,
+                       const Preprocessor *PP) override {
+    EXPECT_EQ(nullptr, this->PP);
+    this->PP = PP;
+  }
+  void EndSourceFile() override {
+    EXPECT_NE(nullptr, PP);
+    PP = nullptr;
+  }
+  void HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
+                        const Diagnostic &Info) override {
+    ASSERT_NE(nullptr, PP);
+    const SourceManager &SM = Info.getSourceManager();
+    EXPECT_EQ(SM.getMainFileID(), SM.getFileID(Info.getLocation()));
+    EXPECT_EQ(&PP->getSourceManager(), &SM);
+    ++NumDiagnosticsSeen;
+  }
+  const Preprocessor *PP;
+  unsigned NumDiagnosticsSeen;
+};
+
+TEST(ClangToolTest, RunParallelDiagnosticsPerSourceFile) {
+  FixedCompilationDatabase Compilations("/", std::vector<std::string>());
+  std::vector<std::string> Sources;
+  for (unsigned I = 0; I != 16; ++I)
+    Sources.push_back("/" + std::to_string(I) + ".cc");
+  ClangTool Tool(Compilations, Sources);
+  for (const std::string &Source : Sources)
+    Tool.mapVirtualFile(Source, "int x = undeclared;\nint y = missing;");
+  SourceFileDiagnosticConsumer Consumer;
+  Tool.setDiagnosticConsumer(&Consumer);
+  std::unique_ptr<FrontendActionFactory> Action(
+      newFrontendActionFactory<SyntaxOnlyAction>());
+  EXPECT_EQ(1, Tool.runParallel(Action.get(), 4));
+  EXPECT_EQ(32u, Consumer.NumDiagnosticsSeen);
+}
+
+TEST(ClangToolTest, RunParallelUsesCommandDirectory) {
+  FixedCompilationDatabase Compilations("/dir",
+                                        std::vector<std::string>(1, "-Iinc"));
+  std::vector<std::string> Sources = {"/dir/a.cc", "/dir/b.cc"};
+  ClangTool Tool(Compilations, Sources);
+  for (const std::string &Source : Sources)
+    Tool.mapVirtualFile(Source, "#include \"header.h\"\nint x = y;");
+  Tool.mapVirtualFile("/dir/inc/header.h", "int y;");
+  TestDiagnosticConsumer Consumer;
+  Tool.setDiagnosticConsumer(&Consumer);
+  std::unique_ptr<FrontendActionFactory> Action(
+      newFrontendActionFactory<SyntaxOnlyAction>());
+  EXPECT_EQ(0, Tool.runParallel(Action.get(), 2));
+  EXPECT_EQ(0u, Consumer.NumDiagnosticsSeen);
+}
+
 TEST(ClangToolTest, InjectDiagnosticConsumerInBuildASTs) {
   FixedCompilationDatabase Compilations("/", std::vector<std::string>());
   ClangTool Tool(Compilations, std::vector<std::string>(1, "/a.cc"));
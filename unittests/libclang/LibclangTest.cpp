@@ -13,10 +13,13 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #define DEBUG_TYPE "libclang-test"
 
@@ -460,6 +463,108 @@ TEST_F(LibclangParseTest, AllSkippedRanges) {
   clang_disposeSourceRangeList(Ranges);
 }
 
+class LibclangIndexDatabaseTest : public LibclangParseTest {
+public:
+  struct Occurrences {
+    std::mutex Mux;
+    std::map<std::string, unsigned> Declarations;
+    unsigned MainFiles = 0;
+    unsigned AbortAfterMainFiles = 0;
+  };
+
+  IndexerCallbacks CB;
+  Occurrences Occurs;
+
+  void SetUp() override {
+    LibclangParseTest::SetUp();
+    memset(&CB, 0, sizeof(CB));
+    CB.abortQuery = [](CXClientData Data, void *) -> int {
+      auto &O = *static_cast<Occurrences *>(Data);
+      std::lock_guard<std::mutex> Lock(O.Mux);
+      return O.AbortAfterMainFiles && O.MainFiles >= O.AbortAfterMainFiles;
+    };
+    CB.enteredMainFile = [](CXClientData Data, CXFile,
+                            void *) -> CXIdxClientFile {
+      auto &O = *static_cast<Occurrences *>(Data);
+      std::lock_guard<std::mutex> Lock(O.Mux);
+      ++O.MainFiles;
+      return nullptr;
+    };
+    CB.indexDeclaration = [](CXClientData Data, const CXIdxDeclInfo *Info) {
+      auto &O = *static_cast<Occurrences *>(Data);
+      std::lock_guard<std::mutex> Lock(O.Mux);
+      ++O.Declarations[Info->entityInfo->name];
+    };
+  }
+
+  // Write one main file per command, each including "header.h", and a
+  // compilation database with a command for each of them.
+  void WriteDatabase(const std::vector<std::string> &Commands) {
+    std::string Dir = TestDir;
+    std::replace(Dir.begin(), Dir.end(), '\\', '/');
+    std::string Database = "[\n";
+    for (unsigned I = 0, N = Commands.size(); I != N; ++I) {
+      std::string Main = "main" + std::to_string(I) + ".cpp";
+      std::string MainPath = Main;
+      WriteFile(MainPath, "#include \"header.h\"\n"
+                          "void main" + std::to_string(I) + "() {}\n");
+      Database += std::string(I ? ",\n" : "") + "{ \"directory\": \"" + Dir +
+                  "\", \"command\": \"clang++ -fsyntax-only " + Commands[I] +
+                  " " + Main + "\", \"file\": \"" + Main + "\" }";
+    }
+    Database += "\n]\n";
+    std::string DatabaseName = "compile_commands.json";
+    WriteFile(DatabaseName, Database);
+  }
+
+  int IndexDatabase(unsigned NumThreads) {
+    CXCompilationDatabase_Error Err;
+    CXCompilationDatabase DB =
+        clang_CompilationDatabase_fromDirectory(TestDir.c_str(), &Err);
+    EXPECT_EQ(CXCompilationDatabase_NoError, Err);
+    CXIndexAction Action = clang_IndexAction_create(Index);
+    int Result = clang_indexCompilationDatabase(Action, &Occurs, &CB,
+                                                sizeof(CB), 0, DB, NumThreads);
+    clang_IndexAction_dispose(Action);
+    clang_CompilationDatabase_dispose(DB);
+    return Result;
+  }
+};
+
+TEST_F(LibclangIndexDatabaseTest, HeaderReportedOnce) {
+  std::string Header = "header.h";
+  WriteFile(Header, "#ifndef HEADER_H\n"
+                    "#define HEADER_H\n"
+                    "struct Shared {};\n"
+                    "#ifdef FIRST\n"
+                    "int first();\n"
+                    "#else\n"
+                    "int rest();\n"
+                    "#endif\n"
+                    "#endif\n");
+  std::vector<std::string> Commands(8);
+  Commands[0] = "-DFIRST";
+  WriteDatabase(Commands);
+
+  EXPECT_EQ(0, IndexDatabase(/*NumThreads=*/4));
+  EXPECT_EQ(8U, Occurs.MainFiles);
+  EXPECT_EQ(1U, Occurs.Declarations["Shared"]);
+  EXPECT_EQ(1U, Occurs.Declarations["first"]);
+  EXPECT_EQ(1U, Occurs.Declarations["rest"]);
+  for (unsigned I = 0; I != 8; ++I)
+    EXPECT_EQ(1U, Occurs.Declarations["main" + std::to_string(I)]);
+}
+
+TEST_F(LibclangIndexDatabaseTest, AbortStopsBatch) {
+  std::string Header = "header.h";
+  WriteFile(Header, "struct Shared {};\n");
+  WriteDatabase(std::vector<std::string>(4));
+
+  Occurs.AbortAfterMainFiles = 1;
+  IndexDatabase(/*NumThreads=*/1);
+  EXPECT_EQ(1U, Occurs.MainFiles);
+}
+
 class LibclangReparseTest : public LibclangParseTest {
 public:
   void DisplayDiagnostics() {
@@ -546,6 +651,52 @@ TEST_F(LibclangReparseTest, ReparseWithModule) {
   EXPECT_EQ(0U, clang_getNumDiagnostics(ClangTU));
 }
 
+TEST_F(LibclangReparseTest, PreambleCache) {
+  std::string HeaderName = "HeaderFile.h";
+  std::string CppName = "CppFile.cpp";
+  WriteFile(HeaderName, "struct Foo { int bar; };\n");
+  WriteFile(CppName, "#include \"HeaderFile.h\"\nint main() {"
+                     " Foo foo; foo.bar = 7; foo.baz = 8; }\n");
+  llvm::SmallString<256> CacheDir(TestDir);
+  llvm::sys::path::append(CacheDir, "preambles");
+  clang_CXIndex_setPreambleCachePath(Index, CacheDir.c_str());
+
+  // The preamble is built, and shared, on the first reparse.
+  ClangTU = clang_parseTranslationUnit(Index, CppName.c_str(), nullptr, 0,
+                                       nullptr, 0, TUFlags);
+  ASSERT_TRUE(ReparseTU(0, nullptr /* No unsaved files. */));
+  EXPECT_EQ(1U, clang_getNumDiagnostics(ClangTU));
+
+  std::vector<std::string> CacheFiles;
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator I(CacheDir, EC), E; I != E && !EC;
+       I.increment(EC))
+    CacheFiles.push_back(I->path());
+  // The cache entry and the precompiled preamble it refers to.
+  EXPECT_EQ(2U, CacheFiles.size());
+
+  // Another index reuses the shared preamble on its first parse.
+  CXIndex OtherIndex = clang_createIndex(0, 0);
+  clang_CXIndex_setPreambleCachePath(OtherIndex, CacheDir.c_str());
+  CXTranslationUnit OtherTU = clang_parseTranslationUnit(
+      OtherIndex, CppName.c_str(), nullptr, 0, nullptr, 0, TUFlags);
+  EXPECT_EQ(1U, clang_getNumDiagnostics(OtherTU));
+  clang_disposeTranslationUnit(OtherTU);
+
+  // Once the header changes, the shared preamble is no longer used.
+  WriteFile(HeaderName, "struct Foo { int bar; int baz; };\n");
+  OtherTU = clang_parseTranslationUnit(OtherIndex, CppName.c_str(), nullptr, 0,
+                                       nullptr, 0, TUFlags);
+  EXPECT_EQ(0U, clang_getNumDiagnostics(OtherTU));
+  clang_disposeTranslationUnit(OtherTU);
+  clang_disposeIndex(OtherIndex);
+
+  for (llvm::sys::fs::directory_iterator I(CacheDir, EC), E; I != E && !EC;
+       I.increment(EC))
+    llvm::sys::fs::remove(I->path());
+  llvm::sys::fs::remove(CacheDir);
+}
+
 TEST_F(LibclangReparseTest, clang_parseTranslationUnit2FullArgv) {
   // Provide a fake GCC 99.9.9 standard library that always overrides any local
   // GCC installation.